@@ -1,4 +1,4 @@
-QT       += core gui network
+QT       += core gui network concurrent
 QT       += core5compat
 
 
@@ -10,23 +10,41 @@ CONFIG += c++17
 # In order to do so, uncomment the following line.
 #DEFINES += QT_DISABLE_DEPRECATED_BEFORE=0x060000    # disables all the APIs deprecated before Qt 6.0.0
 
+# 核心模块（不依赖界面），与命令行工具共用
+include(hrcore.pri)
+
 SOURCES += \
+    bulkeditpanel.cpp \
     casemanager.cpp \
     dashboardmanager.cpp \
+    diagnosticsdialog.cpp \
+    formbinding.cpp \
+    hrapplication.cpp \
+    imagegallery.cpp \
+    imagepreview.cpp \
     jobmanager.cpp \
     loginwindow.cpp \
     main.cpp \
     mainwindow.cpp \
-    productmanager.cpp
+    productmanager.cpp \
+    revisionhistorydialog.cpp \
+    trendchart.cpp
 
 HEADERS += \
+    bulkeditpanel.h \
     casemanager.h \
     dashboardmanager.h \
-    datastructures.h \
+    diagnosticsdialog.h \
+    formbinding.h \
+    hrapplication.h \
+    imagegallery.h \
+    imagepreview.h \
     jobmanager.h \
     loginwindow.h \
     mainwindow.h \
-    productmanager.h
+    productmanager.h \
+    revisionhistorydialog.h \
+    trendchart.h
 
 TRANSLATIONS += \
     HRWindow_zh_CN.ts
@@ -41,6 +59,7 @@ else: unix:!android: target.path = /opt/$${TARGET}/bin
 FORMS += \
     casemanager.ui \
     dashboardmanager.ui \
+    diagnosticsdialog.ui \
     jobmanager.ui \
     loginwindow.ui \
     mainwindow.ui \
@@ -0,0 +1,156 @@
+// batchclient.cpp
+#include "batchclient.h"
+#include "networksession.h"
+#include "networkthread.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QHttpMultiPart>
+#include <QHttpPart>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QDebug>
+
+namespace {
+bool g_batchSupported = true;
+}
+
+QString BatchRequest::addImage(const QString &type, const QString &filePath, const QString &ref,
+                               const QString &contentHash)
+{
+    const QString imageRef = ref.isEmpty() ? QString("batch-ref://%1").arg(m_nextRef++) : ref;
+    m_files.append(filePath);
+
+    QJsonObject op;
+    op["id"] = QString("op%1").arg(m_operations.size() + 1);
+    op["action"] = "upload_image";
+    op["type"] = type;
+    op["file"] = QString("file_%1").arg(m_files.size());
+    op["ref"] = imageRef;
+    if (!contentHash.isEmpty()) op["hash"] = contentHash;
+    m_operations.append(op);
+    return imageRef;
+}
+
+QString BatchRequest::unreadableFile() const
+{
+    for (const QString &file : m_files) {
+        if (!QFileInfo(file).isReadable()) return file;
+    }
+    return QString();
+}
+
+void BatchRequest::addSave(const QString &action, const QJsonArray &payload)
+{
+    QJsonObject op;
+    op["id"] = QString("op%1").arg(m_operations.size() + 1);
+    op["action"] = action;
+    op["data"] = payload;
+    m_operations.append(op);
+}
+
+namespace BatchClient {
+
+QNetworkReply *post(QNetworkAccessManager *manager, const QString &sessionKey,
+                    const BatchRequest &batch, QString *failedFile)
+{
+    QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+
+    QHttpPart actionPart;
+    actionPart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"action\""));
+    actionPart.setBody("batch");
+    multiPart->append(actionPart);
+
+    QHttpPart keyPart;
+    keyPart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"key\""));
+    keyPart.setBody(sessionKey.toUtf8());
+    multiPart->append(keyPart);
+
+    QHttpPart operationsPart;
+    operationsPart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"operations\""));
+    operationsPart.setBody(QJsonDocument(batch.operations()).toJson(QJsonDocument::Compact));
+    multiPart->append(operationsPart);
+
+    const QStringList &files = batch.files();
+    for (int i = 0; i < files.size(); ++i) {
+        QFile *file = new QFile(files[i], multiPart);
+        if (!file->open(QIODevice::ReadOnly)) {
+            if (failedFile) *failedFile = files[i];
+            delete multiPart;
+            return nullptr;
+        }
+        QHttpPart imagePart;
+        imagePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("image/jpeg"));
+        imagePart.setHeader(QNetworkRequest::ContentDispositionHeader,
+                            QVariant(QString("form-data; name=\"file_%1\"; filename=\"%2\"").arg(i + 1).arg(QFileInfo(files[i]).fileName())));
+        imagePart.setBodyDevice(file);
+        multiPart->append(imagePart);
+    }
+
+    QNetworkRequest request = NetworkSession::apiRequest();
+    request.setAttribute(QNetworkRequest::User, "batch");
+
+    QNetworkReply *reply = manager->post(request, multiPart);
+    multiPart->setParent(reply);
+    return reply;
+}
+
+BatchResponse parseResult(const NetworkResult &result, const BatchRequest &batch)
+{
+    BatchResponse response;
+
+    // 只有服务器明确不认识 batch（HTTP 404/501 或 unknown_action）才退回逐个请求；
+    // 400 之类的普通错误可能只是这一次的请求有问题，按失败报告，不影响之后的保存
+    const QJsonObject &obj = result.json;
+    if (NetworkSession::isUnknownAction(result.httpStatus, obj)) {
+        response.supported = false;
+        return response;
+    }
+    if (!result.ok()) {
+        response.message = obj["message"].toString(result.errorString);
+        return response;
+    }
+
+    response.message = obj["message"].toString();
+    if (!obj["results"].isArray()) {
+        if (response.message.isEmpty()) response.message = "批量请求的响应格式不正确";
+        return response;
+    }
+
+    response.committed = obj["status"].toString() == "success";
+    // 服务器的结果里只返回 id，action 和 ref 从发送的请求中对应回来
+    QHash<QString, QJsonObject> operations;
+    for (const QJsonValue &v : batch.operations()) {
+        const QJsonObject op = v.toObject();
+        operations.insert(op["id"].toString(), op);
+    }
+    for (const QJsonValue &v : obj["results"].toArray()) {
+        const QJsonObject r = v.toObject();
+        BatchResult item;
+        item.id = r["id"].toString();
+        const QJsonObject op = operations.value(item.id);
+        item.action = op["action"].toString();
+        item.success = r["status"].toString() == "success";
+        item.message = r["message"].toString();
+        item.url = r["url"].toString();
+        item.ref = op["ref"].toString();
+        if (item.success && !item.ref.isEmpty()) response.imageUrls.insert(item.ref, item.url);
+        response.results.append(item);
+    }
+    return response;
+}
+
+bool isSupported()
+{
+    return g_batchSupported;
+}
+
+void markUnsupported()
+{
+    if (!g_batchSupported) return;
+    g_batchSupported = false;
+    qDebug() << "Server does not support the batch action, falling back to one request per operation";
+}
+
+} // namespace BatchClient
@@ -0,0 +1,92 @@
+// batchclient.h
+#ifndef BATCHCLIENT_H
+#define BATCHCLIENT_H
+
+#include <QString>
+#include <QStringList>
+#include <QList>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+struct NetworkResult;
+
+// --- 多操作批量请求（action=batch）---
+// 把若干次保存和图片上传打包进一个 multipart 请求，服务器在同一个事务里依次执行，
+// 并在一个响应里返回每个操作的结果。要么全部生效，要么全部回滚，不会出现“图片传了、产品没存上”的半保存状态。
+//
+// 请求格式：
+//   action     = "batch"
+//   key        = 会话密钥
+//   operations = JSON 数组，例如
+//       [{"id":"op1","action":"upload_image","type":"product","file":"file_1","ref":"batch-ref://1","hash":"<sha256>"},
+//        {"id":"op2","action":"save_products","data":[...]}]
+//   file_N     = 图片文件本身
+// 保存数据中可以直接写图片的 ref，服务器上传成功后会在同一事务内替换成真实地址。
+// hash 可以省略；带上时服务器据此建立索引，之后 check_images 才能查到（见 ImageDedupe）。
+//
+// 响应格式：
+//   {"status":"success"|"error","message":"...",
+//    "results":[{"id":"op1","status":"success","url":"..."},{"id":"op2","status":"success"}]}
+class BatchRequest
+{
+public:
+    // 添加一张图片，返回保存数据中可以引用它的占位地址；ref 为空时自动生成
+    QString addImage(const QString &type, const QString &filePath, const QString &ref = QString(),
+                     const QString &contentHash = QString());
+
+    // 添加一次整表保存（save_jobs / save_products / save_cases）
+    void addSave(const QString &action, const QJsonArray &payload);
+
+    bool isEmpty() const { return m_operations.isEmpty(); }
+    int size() const { return m_operations.size(); }
+
+    const QJsonArray &operations() const { return m_operations; }
+    const QStringList &files() const { return m_files; }
+    // 第一个无法读取的图片文件；都能读取时返回空
+    QString unreadableFile() const;
+
+private:
+    QJsonArray m_operations;
+    QStringList m_files;
+    int m_nextRef = 1;
+};
+
+// action 和 ref 由客户端根据 id 对应回来，服务器结果中只需返回 id/status/message/url
+struct BatchResult {
+    QString id;
+    QString action;
+    bool success = false;
+    QString message;
+    QString url;  // upload_image 的结果地址
+    QString ref;  // upload_image 请求时使用的占位地址
+};
+
+struct BatchResponse {
+    bool supported = true;   // 服务器是否认识 batch（老版本服务器不认识时退回逐个请求）
+    bool committed = false;  // 事务是否整体提交成功
+    QString message;
+    QList<BatchResult> results;
+    QHash<QString, QString> imageUrls; // 占位地址 -> 真实地址
+};
+
+namespace BatchClient {
+
+// 发送批量请求（在 NetworkThread 的请求工厂中调用）；请求带有 User 属性 "batch"。
+// 有图片无法读取时返回 nullptr，并在 failedFile 中给出文件路径
+QNetworkReply *post(QNetworkAccessManager *manager, const QString &sessionKey,
+                    const BatchRequest &batch, QString *failedFile = nullptr);
+
+// 解析网络线程交回的批量请求结果（包括网络错误），调用方只需检查 supported 和 committed。
+// batch 是发送的请求，服务器结果中的 id 据此对应回各个操作
+BatchResponse parseResult(const NetworkResult &result, const BatchRequest &batch);
+
+// 一旦发现服务器不支持 batch，本次运行中就不再尝试
+bool isSupported();
+void markUnsupported();
+
+} // namespace BatchClient
+
+#endif // BATCHCLIENT_H
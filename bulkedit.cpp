@@ -0,0 +1,230 @@
+// bulkedit.cpp
+#include "bulkedit.h"
+#include "dataserializer.h"
+#include "formbodywriter.h"
+#include "networksession.h"
+#include "networkthread.h"
+
+#include <QNetworkAccessManager>
+#include <QDebug>
+#include <atomic>
+
+namespace {
+
+// 撤销记录最多保留的批量修改数
+const int kHistoryLimit = 50;
+
+std::atomic<bool> g_patchSupported{true};
+
+QString Job::*jobField(const QString &field)
+{
+    if (field == "quota")        return &Job::quota;
+    if (field == "salaryStart")  return &Job::salaryStart;
+    if (field == "salaryEnd")    return &Job::salaryEnd;
+    if (field == "requirements") return &Job::requirements;
+    return nullptr;
+}
+
+QString Product::*productField(const QString &field)
+{
+    if (field == "category")    return &Product::category;
+    if (field == "description") return &Product::description;
+    return nullptr;
+}
+
+// 在 records 中把 rows 各行的 field 改成 value，记下改动前后的指针
+template <typename T>
+void applyTo(RecordList<T> &records, const QList<int> &rows, QString T::*field, const QString &value,
+             QList<int> &changed, RecordList<T> &before, RecordList<T> &after)
+{
+    for (int row : rows) {
+        if (row < 0 || row >= records.size() || (*records[row]).*field == value) continue;
+        T record = *records[row];
+        record.*field = value;
+        const RecordPtr<T> next = RecordPtr<T>::create(record);
+        changed.append(row);
+        before.append(records[row]);
+        after.append(next);
+        records[row] = next;
+    }
+}
+
+// 把仍然是 from 的记录换回 to；先看原来的行号，行号变了再按指针查找
+template <typename T>
+QList<T> swapRecords(RecordList<T> &records, const QList<int> &rows, const RecordList<T> &from, const RecordList<T> &to)
+{
+    QList<T> swapped;
+    for (int i = 0; i < rows.size(); ++i) {
+        qsizetype index = rows[i];
+        if (index >= records.size() || records[index] != from[i]) index = records.indexOf(from[i]);
+        if (index < 0) continue;
+        records[index] = to[i];
+        swapped.append(*to[i]);
+    }
+    return swapped;
+}
+
+Patch swap(const Edit &edit, bool forward)
+{
+    Patch patch;
+    patch.section = edit.section;
+    Snapshot next = *DataStore::instance()->current();
+    if (edit.section == DataStore::Jobs) {
+        patch.jobs = swapRecords(next.jobs, edit.rows, forward ? edit.jobsBefore : edit.jobsAfter,
+                                 forward ? edit.jobsAfter : edit.jobsBefore);
+    } else {
+        patch.products = swapRecords(next.products, edit.rows, forward ? edit.productsBefore : edit.productsAfter,
+                                     forward ? edit.productsAfter : edit.productsBefore);
+    }
+    if (!patch.isEmpty()) DataStore::instance()->publishEdit(next, edit.section);
+    return patch;
+}
+
+// 在 base 中按业务键替换成补丁里的记录；基准里还没有的记录（本地新增后还没保存过）不加入
+template <typename T, typename Key>
+void replaceByKey(QList<T> &base, const QList<T> &records, Key key)
+{
+    for (const T &record : records) {
+        for (T &b : base) {
+            if (key(b) == key(record)) {
+                b = record;
+                break;
+            }
+        }
+    }
+}
+
+} // namespace
+
+namespace BulkEdit {
+
+QList<QPair<QString, QString>> fields(DataStore::Section section)
+{
+    if (section == DataStore::Products) {
+        return {{"category", "产品分类"}, {"description", "产品介绍"}};
+    }
+    return {{"quota", "招聘人数"}, {"salaryStart", "起始薪资"}, {"salaryEnd", "最高薪资"}, {"requirements", "岗位要求"}};
+}
+
+QString Edit::description() const
+{
+    const QString unit = section == DataStore::Products ? "个产品" : "个职位";
+    return QString("%1 %2的%3改为“%4”").arg(size()).arg(unit, label, value);
+}
+
+Patch Edit::result() const
+{
+    Patch patch;
+    patch.section = section;
+    for (const auto &record : jobsAfter) patch.jobs.append(*record);
+    for (const auto &record : productsAfter) patch.products.append(*record);
+    return patch;
+}
+
+Edit apply(DataStore::Section section, const QList<int> &rows, const QString &field, const QString &value)
+{
+    Edit edit;
+    edit.section = section;
+    edit.field = field;
+    edit.value = value;
+    for (const auto &f : fields(section)) {
+        if (f.first == field) edit.label = f.second;
+    }
+
+    Snapshot next = *DataStore::instance()->current();
+    if (section == DataStore::Jobs) {
+        if (QString Job::*member = jobField(field))
+            applyTo(next.jobs, rows, member, value, edit.rows, edit.jobsBefore, edit.jobsAfter);
+    } else if (section == DataStore::Products) {
+        if (QString Product::*member = productField(field))
+            applyTo(next.products, rows, member, value, edit.rows, edit.productsBefore, edit.productsAfter);
+    }
+    if (!edit.isEmpty()) DataStore::instance()->publishEdit(next, section);
+    return edit;
+}
+
+Patch undo(const Edit &edit)
+{
+    return swap(edit, false);
+}
+
+Patch redo(const Edit &edit)
+{
+    return swap(edit, true);
+}
+
+void History::push(const Edit &edit)
+{
+    m_undo.append(edit);
+    m_redo.clear();
+    if (m_undo.size() > kHistoryLimit) m_undo.removeFirst();
+}
+
+Patch History::undo()
+{
+    if (m_undo.isEmpty()) return Patch();
+    const Edit edit = m_undo.takeLast();
+    m_redo.append(edit);
+    return BulkEdit::undo(edit);
+}
+
+Patch History::redo()
+{
+    if (m_redo.isEmpty()) return Patch();
+    const Edit edit = m_redo.takeLast();
+    m_undo.append(edit);
+    return BulkEdit::redo(edit);
+}
+
+void History::clear()
+{
+    m_undo.clear();
+    m_redo.clear();
+}
+
+quint64 submit(const QString &sessionKey, const Patch &patch, QObject *context,
+               std::function<void(const NetworkResult &result)> done)
+{
+    const QString action = patch.section == DataStore::Products ? "patch_products" : "patch_jobs";
+    return NetworkThread::instance()->submit(action,
+        [sessionKey, patch, action](QNetworkAccessManager *manager) {
+            FormBodyWriter writer;
+            writer.addField("action", action);
+            writer.addField("key", sessionKey);
+            writer.beginJsonField("data");
+            if (patch.section == DataStore::Products) writer.value(DataSerializer::toWireArray(patch.products));
+            else writer.value(DataSerializer::toWireArray(patch.jobs));
+            return NetworkSession::postForm(manager, action, writer.take());
+        },
+        context, done);
+}
+
+bool checkSupported(const NetworkResult &result)
+{
+    // 只有服务器明确不认识补丁时才退回整表保存；会话过期等普通错误由调用方照常报告
+    const bool unsupported = NetworkSession::isUnknownAction(result.httpStatus, result.json);
+    if (unsupported && g_patchSupported.exchange(false))
+        qDebug() << "Server does not support patch saves, bulk edits fall back to full saves";
+    return !unsupported;
+}
+
+bool isSupported()
+{
+    return g_patchSupported;
+}
+
+void markSaved(const Patch &patch)
+{
+    auto *store = DataStore::instance();
+    if (patch.section == DataStore::Products) {
+        QList<Product> base = store->syncBase().productValues();
+        replaceByKey(base, patch.products, [](const Product &p) { return p.name; });
+        store->markSaved(base);
+    } else {
+        QList<Job> base = store->syncBase().jobValues();
+        replaceByKey(base, patch.jobs, [](const Job &j) { return j.title; });
+        store->markSaved(base);
+    }
+}
+
+} // namespace BulkEdit
@@ -0,0 +1,97 @@
+// bulkedit.h
+#ifndef BULKEDIT_H
+#define BULKEDIT_H
+
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <functional>
+#include "datastore.h"
+
+class QObject;
+struct NetworkResult;
+
+// --- 多条记录的批量修改 ---
+// 在职位或产品列表中多选后，把同一个字段一次改成同一个值（例如招聘人数都改成“若干”、
+// 二十个产品换到新的分类）。所有改动作为一个版本发布，在撤销记录里也只占一项，
+// 并且只把改动过的记录作为一个补丁发给服务器，不再整表保存。
+//
+// 补丁请求格式：
+//   action = "patch_jobs" | "patch_products"
+//   key    = 会话密钥
+//   data   = 改动过的记录，格式与 save_jobs / save_products 的 data 相同；
+//            服务器按职位名称 / 产品名称找到记录并整条替换，其余记录不动
+// 响应格式：{"status":"success"|"error","message":"...","updated":<替换的记录数>}
+// 老版本服务器明确不认识补丁（HTTP 404/501 或 unknown_action，见 NetworkSession::isUnknownAction）时，
+// 调用方退回整表保存；其它错误照常报告，不会触发整表保存。
+namespace BulkEdit {
+
+// 可以批量修改的字段：字段名 -> 界面上的名称。名称（职位名称、产品名称）是记录的业务键，不能批量修改
+QList<QPair<QString, QString>> fields(DataStore::Section section);
+
+// 要发给服务器的一组记录（改动后的完整记录）
+struct Patch {
+    DataStore::Section section = DataStore::Jobs;
+    QList<Job> jobs;
+    QList<Product> products;
+
+    bool isEmpty() const { return jobs.isEmpty() && products.isEmpty(); }
+    int size() const { return int(jobs.size() + products.size()); }
+};
+
+// 一次批量修改：改动前后的记录按指针保存，撤销和重做只是把指针换回去
+struct Edit {
+    DataStore::Section section = DataStore::Jobs;
+    QString field;
+    QString label; // 界面上的字段名称
+    QString value;
+    QList<int> rows;
+    RecordList<Job> jobsBefore, jobsAfter;
+    RecordList<Product> productsBefore, productsAfter;
+
+    bool isEmpty() const { return rows.isEmpty(); }
+    int size() const { return int(rows.size()); }
+    QString description() const; // 例如“3 个职位的招聘人数改为“若干””
+    Patch result() const;        // 修改后的记录
+};
+
+// 把 rows 中各记录的 field 改成 value，作为一个版本发布。值已经相同的记录跳过，
+// 返回实际改动的记录；一条都没有改动时返回空的 Edit，也不发布新版本
+Edit apply(DataStore::Section section, const QList<int> &rows, const QString &field, const QString &value);
+
+// 撤销 / 重做一个批量修改的本地部分，返回要发给服务器的补丁。
+// 只恢复仍然保持着这次修改结果的记录（行号变了也能按指针找到）；之后又被单独修改过或已删除的记录保持不动
+Patch undo(const Edit &edit);
+Patch redo(const Edit &edit);
+
+// 批量修改的撤销记录；撤销和重做都以整个批量修改为单位
+class History
+{
+public:
+    void push(const Edit &edit);
+    bool canUndo() const { return !m_undo.isEmpty(); }
+    bool canRedo() const { return !m_redo.isEmpty(); }
+    const Edit &nextUndo() const { return m_undo.last(); }
+    const Edit &nextRedo() const { return m_redo.last(); }
+    Patch undo();
+    Patch redo();
+    void clear();
+
+private:
+    QList<Edit> m_undo;
+    QList<Edit> m_redo;
+};
+
+// 在网络线程上发送补丁，回调在界面线程调用；返回 NetworkThread 的请求编号
+quint64 submit(const QString &sessionKey, const Patch &patch, QObject *context,
+               std::function<void(const NetworkResult &result)> done);
+// 检查响应；服务器明确不认识补丁时返回 false，本次运行中之后的批量修改直接整表保存
+bool checkSupported(const NetworkResult &result);
+bool isSupported();
+
+// 补丁保存成功后调用：把这些记录写进与服务器一致的基准版本（DataStore::syncBase）
+void markSaved(const Patch &patch);
+
+} // namespace BulkEdit
+
+#endif // BULKEDIT_H
@@ -0,0 +1,101 @@
+// bulkeditpanel.cpp
+#include "bulkeditpanel.h"
+
+#include <QComboBox>
+#include <QGridLayout>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QPushButton>
+
+BulkEditPanel::BulkEditPanel(QWidget *parent)
+    : QWidget(parent)
+    , m_title(new QLabel(this))
+    , m_fieldCombo(new QComboBox(this))
+    , m_valueCombo(new QComboBox(this))
+    , m_applyButton(new QPushButton("应用到选中项", this))
+    , m_undoButton(new QPushButton("撤销", this))
+    , m_redoButton(new QPushButton("重做", this))
+{
+    m_valueCombo->setEditable(true);
+    m_valueCombo->setInsertPolicy(QComboBox::NoInsert);
+    m_valueCombo->lineEdit()->setPlaceholderText("新的值");
+    m_valueCombo->setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Fixed);
+    m_undoButton->setShortcut(QKeySequence::Undo);
+    m_redoButton->setShortcut(QKeySequence::Redo);
+
+    auto *layout = new QGridLayout(this);
+    layout->setContentsMargins(0, 6, 0, 0);
+    layout->addWidget(m_title, 0, 0, 1, 2);
+    layout->addWidget(m_fieldCombo, 1, 0);
+    layout->addWidget(m_valueCombo, 1, 1);
+    auto *buttons = new QHBoxLayout;
+    buttons->addWidget(m_applyButton);
+    buttons->addStretch();
+    buttons->addWidget(m_undoButton);
+    buttons->addWidget(m_redoButton);
+    layout->addLayout(buttons, 2, 0, 1, 2);
+
+    connect(m_fieldCombo, &QComboBox::currentIndexChanged, this, &BulkEditPanel::updateSuggestions);
+    connect(m_applyButton, &QPushButton::clicked, this, [this]() {
+        emit applyRequested(m_fieldCombo->currentData().toString(), m_valueCombo->currentText());
+    });
+    connect(m_valueCombo->lineEdit(), &QLineEdit::returnPressed, m_applyButton, &QPushButton::click);
+    connect(m_undoButton, &QPushButton::clicked, this, &BulkEditPanel::undoRequested);
+    connect(m_redoButton, &QPushButton::clicked, this, &BulkEditPanel::redoRequested);
+
+    setHistory(QString(), QString());
+    setSelectionCount(0);
+}
+
+void BulkEditPanel::setFields(const QList<QPair<QString, QString>> &fields)
+{
+    m_fieldCombo->clear();
+    for (const auto &field : fields) m_fieldCombo->addItem(field.second, field.first);
+}
+
+void BulkEditPanel::setSuggestions(const QString &field, const QStringList &values)
+{
+    if (m_suggestions.value(field) == values) return;
+    m_suggestions.insert(field, values);
+    if (m_fieldCombo->currentData().toString() == field) updateSuggestions();
+}
+
+void BulkEditPanel::updateSuggestions()
+{
+    const QString text = m_valueCombo->currentText();
+    m_valueCombo->clear();
+    m_valueCombo->addItems(m_suggestions.value(m_fieldCombo->currentData().toString()));
+    m_valueCombo->setCurrentText(text);
+}
+
+void BulkEditPanel::setSelectionCount(int count)
+{
+    m_selectionCount = count;
+    m_title->setText(QString("批量修改（已选中 %1 项）").arg(count));
+    m_applyButton->setEnabled(count > 1 && !m_busy);
+    updateVisibility();
+}
+
+void BulkEditPanel::setHistory(const QString &undoText, const QString &redoText)
+{
+    m_undoButton->setEnabled(!undoText.isEmpty() && !m_busy);
+    m_undoButton->setToolTip(undoText.isEmpty() ? QString() : "撤销：" + undoText);
+    m_redoButton->setEnabled(!redoText.isEmpty() && !m_busy);
+    m_redoButton->setToolTip(redoText.isEmpty() ? QString() : "重做：" + redoText);
+    updateVisibility();
+}
+
+void BulkEditPanel::setBusy(bool busy)
+{
+    m_busy = busy;
+    m_applyButton->setEnabled(m_selectionCount > 1 && !busy);
+    m_undoButton->setEnabled(!m_undoButton->toolTip().isEmpty() && !busy);
+    m_redoButton->setEnabled(!m_redoButton->toolTip().isEmpty() && !busy);
+}
+
+void BulkEditPanel::updateVisibility()
+{
+    // 撤销 / 重做在只选中一条时也要能用
+    setVisible(m_selectionCount > 1 || !m_undoButton->toolTip().isEmpty() || !m_redoButton->toolTip().isEmpty());
+}
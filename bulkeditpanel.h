@@ -0,0 +1,56 @@
+// bulkeditpanel.h
+#ifndef BULKEDITPANEL_H
+#define BULKEDITPANEL_H
+
+#include <QWidget>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+
+class QComboBox;
+class QLabel;
+class QPushButton;
+
+// --- 批量修改面板 ---
+// 放在职位 / 产品列表下方：列表中选中多条记录时显示，选择字段、填写新值后一次应用到全部选中的记录。
+// 面板只负责输入，修改、撤销和保存由所在的管理模块完成（见 BulkEdit）。
+class BulkEditPanel : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit BulkEditPanel(QWidget *parent = nullptr);
+
+    // 可以批量修改的字段：字段名 -> 界面上的名称
+    void setFields(const QList<QPair<QString, QString>> &fields);
+    // 某个字段的候选值（例如产品分类），显示在值输入框的下拉列表中
+    void setSuggestions(const QString &field, const QStringList &values);
+
+    // 选中的记录数；少于两条且没有可撤销的批量修改时隐藏面板
+    void setSelectionCount(int count);
+    // 撤销 / 重做按钮的状态，text 为空表示不可用
+    void setHistory(const QString &undoText, const QString &redoText);
+    void setBusy(bool busy);
+
+signals:
+    void applyRequested(const QString &field, const QString &value);
+    void undoRequested();
+    void redoRequested();
+
+private:
+    void updateSuggestions();
+    void updateVisibility();
+
+    QLabel *m_title;
+    QComboBox *m_fieldCombo;
+    QComboBox *m_valueCombo;
+    QPushButton *m_applyButton;
+    QPushButton *m_undoButton;
+    QPushButton *m_redoButton;
+    QHash<QString, QStringList> m_suggestions;
+    int m_selectionCount = 0;
+    bool m_busy = false;
+};
+
+#endif // BULKEDITPANEL_H
@@ -0,0 +1,338 @@
+// bulkimporter.cpp
+#include "bulkimporter.h"
+
+#include <QFile>
+#include <QFileInfo>
+#include <QTextStream>
+#include <QDirIterator>
+#include <QHash>
+#include <QLocale>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QRegularExpression>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentMap>
+#include <QtConcurrent/QtConcurrentRun>
+
+namespace {
+
+// 每块的行数：足够大以摊薄线程调度开销，又足够小使内存占用与文件大小无关
+const int kChunkRows = 4096;
+const int kMaxFieldLength = 20000;
+
+bool isRemoteImage(const QString &image)
+{
+    return image.startsWith("http://") || image.startsWith("https://");
+}
+
+// 读取阶段只做切分，不做任何解析，真正的解析和校验放在线程池里并行完成
+struct RawRow {
+    qint64 line = 0;
+    QStringList fields; // CSV
+    QByteArray json;    // JSON Lines
+};
+
+struct ParsedRow {
+    qint64 line = 0;
+    QString error;
+    Job job;
+    Product product;
+    QStringList images;
+};
+
+// --- 流式 CSV 读取：一次读一条记录，引号内的换行会继续读下一行 ---
+class CsvReader
+{
+public:
+    explicit CsvReader(QTextStream &in) : m_in(in) {}
+
+    bool next(QStringList &fields, qint64 &startLine)
+    {
+        fields.clear();
+        if (m_in.atEnd()) return false;
+
+        QString field;
+        bool inQuotes = false;
+        startLine = m_line + 1;
+        while (true) {
+            const QString line = m_in.readLine();
+            ++m_line;
+            for (int i = 0; i < line.size(); ++i) {
+                const QChar c = line[i];
+                if (inQuotes) {
+                    if (c == '"') {
+                        if (i + 1 < line.size() && line[i + 1] == '"') { field += '"'; ++i; }
+                        else inQuotes = false;
+                    } else {
+                        field += c;
+                    }
+                } else if (c == '"') {
+                    inQuotes = true;
+                } else if (c == ',') {
+                    fields.append(field);
+                    field.clear();
+                } else {
+                    field += c;
+                }
+            }
+            if (inQuotes && !m_in.atEnd()) {
+                field += '\n';
+                continue;
+            }
+            break;
+        }
+        fields.append(field);
+        return true;
+    }
+
+private:
+    QTextStream &m_in;
+    qint64 m_line = 0;
+};
+
+// 图片目录索引：小写文件名 -> 完整路径。只列目录，不读取任何图片内容
+QHash<QString, QString> indexImageFolder(const QString &folder)
+{
+    QHash<QString, QString> index;
+    if (folder.isEmpty()) return index;
+    QDirIterator it(folder, {"*.png", "*.jpg", "*.jpeg", "*.bmp", "*.webp"},
+                    QDir::Files, QDirIterator::Subdirectories);
+    while (it.hasNext()) {
+        it.next();
+        index.insert(it.fileName().toLower(), it.filePath());
+    }
+    return index;
+}
+
+// 把一行统一成 字段名 -> 文本，JSON 中的数组（例如 images）用分号拼接
+QHash<QString, QString> rowValues(const RawRow &raw, const QStringList &header, QString *error)
+{
+    QHash<QString, QString> values;
+    if (!raw.json.isEmpty()) {
+        QJsonParseError parseError;
+        const QJsonDocument doc = QJsonDocument::fromJson(raw.json, &parseError);
+        if (!doc.isObject()) {
+            *error = "JSON 格式错误: " + parseError.errorString();
+            return values;
+        }
+        const QJsonObject obj = doc.object();
+        for (auto it = obj.begin(); it != obj.end(); ++it) {
+            if (it.value().isArray()) {
+                QStringList parts;
+                for (const QJsonValue &v : it.value().toArray()) parts.append(v.toString());
+                values.insert(it.key(), parts.join(';'));
+            } else if (it.value().isDouble()) {
+                // 不用默认的 'g' 格式：100000000 会变成 "1e+08"
+                values.insert(it.key(), QString::number(it.value().toDouble(), 'f', QLocale::FloatingPointShortest));
+            } else {
+                values.insert(it.key(), it.value().toString());
+            }
+        }
+        return values;
+    }
+
+    if (raw.fields.size() > header.size()) {
+        *error = QString("列数 (%1) 多于表头 (%2)").arg(raw.fields.size()).arg(header.size());
+        return values;
+    }
+    for (int i = 0; i < raw.fields.size(); ++i)
+        values.insert(header[i], raw.fields[i].trimmed());
+    return values;
+}
+
+ParsedRow parseJob(const RawRow &raw, const QStringList &header)
+{
+    ParsedRow row;
+    row.line = raw.line;
+    const QHash<QString, QString> v = rowValues(raw, header, &row.error);
+    if (!row.error.isEmpty()) return row;
+
+    Job &job = row.job;
+    job.title        = v.value("title").trimmed();
+    job.quota        = v.value("quota");
+    job.salaryStart  = v.value("salaryStart");
+    job.salaryEnd    = v.value("salaryEnd");
+    job.requirements = v.value("requirements");
+
+    // 兼容服务器导出的合并薪资 "4000 - 6000"
+    if (job.salaryStart.isEmpty() && v.contains("salary")) {
+        const QStringList parts = v.value("salary").split(QRegularExpression("\\s*[-~]\\s*"));
+        job.salaryStart = parts.value(0).trimmed();
+        job.salaryEnd = parts.value(1).trimmed();
+    }
+
+    if (job.title.isEmpty()) row.error = "缺少职位名称 (title)";
+    else if (job.requirements.size() > kMaxFieldLength) row.error = "职位要求过长";
+    return row;
+}
+
+ParsedRow parseProduct(const RawRow &raw, const QStringList &header, const QHash<QString, QString> &imageIndex)
+{
+    ParsedRow row;
+    row.line = raw.line;
+    const QHash<QString, QString> v = rowValues(raw, header, &row.error);
+    if (!row.error.isEmpty()) return row;
+
+    Product &product = row.product;
+    product.name        = v.value("name").trimmed();
+    product.category    = v.value("category").trimmed();
+    product.description = v.value("description");
+
+    if (product.name.isEmpty()) {
+        row.error = "缺少产品名称 (name)";
+        return row;
+    }
+    if (product.description.size() > kMaxFieldLength) {
+        row.error = "产品介绍过长";
+        return row;
+    }
+
+    // 网络地址和本地图片混在一列里时保持原来的顺序，本地图片先占住位置，上传后再原位替换
+    const QString images = v.value("images", v.value("imageUrls"));
+    for (const QString &token : images.split(QRegularExpression("[;|]"), Qt::SkipEmptyParts)) {
+        const QString name = token.trimmed();
+        if (isRemoteImage(name)) {
+            product.imageUrls.append(name);
+            continue;
+        }
+        const QString path = imageIndex.value(QFileInfo(name).fileName().toLower());
+        if (path.isEmpty()) {
+            row.error = "在图片目录中找不到 " + name;
+            return row;
+        }
+        product.imageUrls.append(path);
+        row.images.append(path);
+    }
+    return row;
+}
+
+} // namespace
+
+namespace BulkImporter {
+
+QStringList resolveImages(const QStringList &images, const std::function<QString(const QString &)> &upload)
+{
+    QStringList resolved;
+    resolved.reserve(images.size());
+    for (const QString &image : images)
+        resolved.append(isRemoteImage(image) ? image : upload(image));
+    return resolved;
+}
+
+int Result::imageCount() const
+{
+    int count = 0;
+    for (const auto &images : productImages) count += images.size();
+    return count;
+}
+
+QString Result::summary() const
+{
+    QString text = QString("共读取 %1 行：有效 %2 条，出错 %3 条")
+                       .arg(rowsRead).arg(validCount()).arg(errors.size());
+    if (imageCount() > 0) text += QString("，需上传图片 %1 张").arg(imageCount());
+    text += "。";
+
+    if (!errors.isEmpty()) {
+        const int shown = qMin<int>(errors.size(), 10);
+        text += "\n\n出错的行（已跳过）：\n" + QStringList(errors.mid(0, shown)).join('\n');
+        if (errors.size() > shown) text += QString("\n……另有 %1 条").arg(errors.size() - shown);
+    }
+    return text;
+}
+
+Result run(const Options &options, const std::function<void(qint64)> &progress)
+{
+    Result result;
+
+    QFile file(options.filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        result.fatalError = "无法打开文件: " + file.errorString();
+        return result;
+    }
+
+    const QString suffix = QFileInfo(options.filePath).suffix().toLower();
+    const bool jsonLines = (suffix == "jsonl" || suffix == "ndjson");
+    const QHash<QString, QString> imageIndex =
+        options.kind == Kind::Products ? indexImageFolder(options.imageFolder) : QHash<QString, QString>();
+
+    QTextStream in(&file);
+    CsvReader csv(in);
+    QStringList header;
+    if (!jsonLines) {
+        qint64 line = 0;
+        if (!csv.next(header, line)) {
+            result.fatalError = "文件为空";
+            return result;
+        }
+        for (QString &h : header) h = h.trimmed();
+        const QString required = options.kind == Kind::Jobs ? "title" : "name";
+        if (!header.contains(required)) {
+            result.fatalError = QString("表头中缺少必需的列 \"%1\"").arg(required);
+            return result;
+        }
+    }
+
+    // 并行处理一块：保持原有顺序，把结果追加到 result 中
+    auto processChunk = [&](const QList<RawRow> &chunk) {
+        const QList<ParsedRow> parsed = QtConcurrent::blockingMapped<QList<ParsedRow>>(chunk, [&](const RawRow &raw) {
+            return options.kind == Kind::Jobs ? parseJob(raw, header) : parseProduct(raw, header, imageIndex);
+        });
+        for (const ParsedRow &row : parsed) {
+            if (!row.error.isEmpty()) {
+                result.errors.append(QString("第 %1 行: %2").arg(row.line).arg(row.error));
+            } else if (options.kind == Kind::Jobs) {
+                result.jobs.append(row.job);
+            } else {
+                result.products.append(row.product);
+                result.productImages.append(row.images);
+            }
+        }
+        result.rowsRead += chunk.size();
+        if (progress) progress(result.rowsRead);
+    };
+
+    QList<RawRow> chunk;
+    chunk.reserve(kChunkRows);
+    qint64 lineNo = jsonLines ? 0 : 1;
+    while (true) {
+        RawRow raw;
+        if (jsonLines) {
+            if (file.atEnd()) break;
+            raw.json = file.readLine().trimmed();
+            raw.line = ++lineNo;
+            if (raw.json.isEmpty()) continue;
+        } else {
+            if (!csv.next(raw.fields, raw.line)) break;
+            if (raw.fields.size() == 1 && raw.fields.first().trimmed().isEmpty()) continue; // 空行
+        }
+        chunk.append(std::move(raw));
+        if (chunk.size() >= kChunkRows) {
+            processChunk(chunk);
+            chunk.clear();
+        }
+    }
+    if (!chunk.isEmpty()) processChunk(chunk);
+
+    return result;
+}
+
+void runAsync(const Options &options, QObject *context,
+              const std::function<void(qint64)> &onProgress,
+              const std::function<void(const Result &)> &onFinished)
+{
+    auto *watcher = new QFutureWatcher<Result>(context);
+    QObject::connect(watcher, &QFutureWatcher<Result>::finished, context, [watcher, onFinished]() {
+        watcher->deleteLater();
+        onFinished(watcher->result());
+    });
+
+    // 工作线程中的进度通过排队调用转回 context 的线程
+    auto progress = [context, onProgress](qint64 rows) {
+        QMetaObject::invokeMethod(context, [onProgress, rows]() { onProgress(rows); }, Qt::QueuedConnection);
+    };
+    watcher->setFuture(QtConcurrent::run([options, progress]() { return run(options, progress); }));
+}
+
+} // namespace BulkImporter
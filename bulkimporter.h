@@ -0,0 +1,61 @@
+// bulkimporter.h
+#ifndef BULKIMPORTER_H
+#define BULKIMPORTER_H
+
+#include "datastructures.h"
+#include <QList>
+#include <QStringList>
+#include <functional>
+
+class QObject;
+
+// --- 职位/产品的批量导入 ---
+// 支持两种文件格式：
+//   1. CSV：第一行为表头，字段可用双引号包裹（可包含逗号和换行）
+//   2. JSON Lines（.jsonl / .ndjson）：每行一个 JSON 对象
+// 字段名与本地数据结构一致：
+//   职位：title, quota, salaryStart, salaryEnd, requirements（也接受合并的 salary: "A - B"）
+//   产品：name, category, description, images（本地图片文件名，用 ; 或 | 分隔；也可以直接写 http 地址）
+//
+// 文件按行流式读取，每凑满一块就交给线程池并行解析和校验，整个文件不会一次性读入内存。
+// 整个 run() 是阻塞的，应在工作线程中调用（例如 QtConcurrent::run）。
+namespace BulkImporter {
+
+enum class Kind { Jobs, Products };
+
+struct Options {
+    Kind kind = Kind::Jobs;
+    QString filePath;
+    QString imageFolder; // 产品图片所在目录（会递归查找），为空时不匹配本地图片
+};
+
+struct Result {
+    QList<Job> jobs;
+    QList<Product> products;
+    // products 的 imageUrls 按 images 列中的顺序保存每一项：http 地址原样保留，
+    // 本地图片是找到的文件路径，导入方用 resolveImages() 在原位置换成上传后的地址。
+    // productImages 与 products 一一对应，是其中需要上传的本地图片
+    QList<QStringList> productImages;
+    QStringList errors; // "第 N 行: 原因"
+    qint64 rowsRead = 0;
+    QString fatalError; // 文件无法打开或表头缺失等，此时其它字段无意义
+
+    int validCount() const { return jobs.size() + products.size(); }
+    int imageCount() const;
+    QString summary() const; // 给用户确认用的中文摘要
+};
+
+// 把导入产品 imageUrls 中的本地图片路径逐个换成 upload(路径) 的结果，http 地址和顺序不变
+QStringList resolveImages(const QStringList &images, const std::function<QString(const QString &)> &upload);
+
+// progress 会在工作线程中被调用，参数为已读取的行数
+Result run(const Options &options, const std::function<void(qint64)> &progress = {});
+
+// 在线程池中执行 run()，进度和结果都回到 context 所在的线程（通常是GUI线程）再回调
+void runAsync(const Options &options, QObject *context,
+              const std::function<void(qint64)> &onProgress,
+              const std::function<void(const Result &)> &onFinished);
+
+} // namespace BulkImporter
+
+#endif // BULKIMPORTER_H
@@ -0,0 +1,233 @@
+// catalogclient.cpp
+#include "catalogclient.h"
+#include "networksession.h"
+#include "dataserializer.h"
+#include "imagededupe.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QHttpMultiPart>
+#include <QUrlQuery>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentMap>
+
+namespace {
+
+// 与 QNetworkAccessManager 对同一主机的并发连接上限保持一致
+const int kParallelUploads = 6;
+
+const char *const kHashProperty = "catalogImageHash";
+
+} // namespace
+
+CatalogClient::CatalogClient(QObject *parent)
+    : QObject(parent)
+    , m_networkManager(new QNetworkAccessManager(this))
+{
+    connect(m_networkManager, &QNetworkAccessManager::finished, this, &CatalogClient::onReply);
+    NetworkSession::attach(m_networkManager);
+    NetworkSession::prewarm(m_networkManager);
+}
+
+void CatalogClient::login(const QString &password)
+{
+    QNetworkRequest request = NetworkSession::apiRequest();
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.setAttribute(QNetworkRequest::User, "login");
+
+    QUrlQuery postData;
+    postData.addQueryItem("action", "login");
+    postData.addQueryItem("password", password);
+    m_networkManager->post(request, postData.query(QUrl::FullyEncoded).toUtf8());
+}
+
+void CatalogClient::fetchAll()
+{
+    QNetworkRequest request = NetworkSession::apiRequest("get_all_data");
+    request.setAttribute(QNetworkRequest::User, "get_all_data");
+    m_networkManager->get(request);
+}
+
+void CatalogClient::save(const QString &action, const QJsonArray &payload)
+{
+    NetworkSession::postSave(m_networkManager, m_sessionKey, action, payload);
+}
+
+void CatalogClient::saveJobs(const QList<Job> &jobs)
+{
+    NetworkSession::postForm(m_networkManager, "save_jobs", DataSerializer::saveBody(m_sessionKey, jobs));
+}
+
+void CatalogClient::saveProducts(const QList<Product> &products)
+{
+    NetworkSession::postForm(m_networkManager, "save_products", DataSerializer::saveBody(m_sessionKey, products));
+}
+
+void CatalogClient::uploadImages(const QString &type, const QStringList &filePaths)
+{
+    m_uploadType = type;
+    m_pathsByHash.clear();
+    m_uploadQueue.clear();
+    m_uploadedUrls.clear();
+    m_failedUploads.clear();
+    m_uploadsRemaining = filePaths.size();
+    if (filePaths.isEmpty()) {
+        emit imagesUploaded(m_uploadedUrls, m_failedUploads);
+        return;
+    }
+
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, filePaths]() {
+        watcher->deleteLater();
+        onHashesReady(filePaths, watcher->future().results());
+    });
+    watcher->setFuture(QtConcurrent::mapped(filePaths, &ImageDedupe::hashFile));
+}
+
+void CatalogClient::onHashesReady(const QStringList &filePaths, const QStringList &hashes)
+{
+    QStringList unknown;
+    for (int i = 0; i < filePaths.size(); ++i) {
+        const QString &hash = hashes.value(i);
+        if (hash.isEmpty()) {
+            finishUpload(filePaths[i], QString(), "无法读取本地图片");
+            continue;
+        }
+        QStringList &paths = m_pathsByHash[hash];
+        paths.append(filePaths[i]);
+        if (paths.size() == 1) unknown.append(hash);
+    }
+
+    // 本地缓存命中的直接完成
+    QStringList pending;
+    for (const QString &hash : std::as_const(unknown)) {
+        const QString cached = ImageDedupe::cachedUrl(hash);
+        if (cached.isEmpty()) pending.append(hash);
+        else finishHash(hash, cached, QString());
+    }
+    if (pending.isEmpty()) return;
+
+    m_uploadQueue = pending;
+    if (!ImageDedupe::isServerCheckSupported()) {
+        startNextUploads();
+        return;
+    }
+    // 剩下的一次性询问服务器
+    ImageDedupe::postCheck(m_networkManager, m_sessionKey, pending);
+}
+
+void CatalogClient::onCheckReply(int httpStatus, const QJsonObject &reply)
+{
+    const QHash<QString, QString> known = ImageDedupe::knownUrls(httpStatus, reply);
+    QStringList stillMissing;
+    for (const QString &hash : std::as_const(m_uploadQueue)) {
+        const QString url = known.value(hash);
+        if (url.isEmpty()) {
+            stillMissing.append(hash);
+        } else {
+            ImageDedupe::remember(hash, url);
+            finishHash(hash, url, QString());
+        }
+    }
+    m_uploadQueue = stillMissing;
+    startNextUploads();
+}
+
+void CatalogClient::startNextUploads()
+{
+    while (m_uploadsInFlight < kParallelUploads && !m_uploadQueue.isEmpty()) {
+        const QString hash = m_uploadQueue.takeFirst();
+        const QString path = m_pathsByHash.value(hash).value(0);
+        QHttpMultiPart *multiPart = NetworkSession::createImageUpload(m_sessionKey, m_uploadType, path, hash);
+        if (!multiPart) {
+            finishHash(hash, QString(), "无法读取本地图片");
+            continue;
+        }
+
+        QNetworkRequest request = NetworkSession::apiRequest();
+        request.setAttribute(QNetworkRequest::User, "upload_image");
+        QNetworkReply *reply = m_networkManager->post(request, multiPart);
+        multiPart->setParent(reply);
+        reply->setProperty(kHashProperty, hash);
+        ++m_uploadsInFlight;
+    }
+}
+
+void CatalogClient::finishHash(const QString &hash, const QString &url, const QString &error)
+{
+    const QStringList paths = m_pathsByHash.value(hash);
+    for (const QString &path : paths)
+        finishUpload(path, url, error);
+}
+
+void CatalogClient::finishUpload(const QString &filePath, const QString &url, const QString &error)
+{
+    if (error.isEmpty()) {
+        m_uploadedUrls.insert(filePath, url);
+        emit imageUploaded(filePath, url);
+    } else {
+        m_failedUploads.append(filePath);
+        emit imageUploadFailed(filePath, error);
+    }
+    if (--m_uploadsRemaining == 0)
+        emit imagesUploaded(m_uploadedUrls, m_failedUploads);
+}
+
+void CatalogClient::onReply(QNetworkReply *reply)
+{
+    reply->deleteLater();
+    if (NetworkSession::isPrewarmReply(reply)) return;
+
+    const QString action = reply->request().attribute(QNetworkRequest::User).toString();
+    const bool connectivity = NetworkSession::isConnectivityError(reply->error());
+
+    QString error;
+    QJsonObject obj;
+    if (reply->error() != QNetworkReply::NoError) {
+        error = reply->errorString();
+    } else {
+        const QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
+        obj = doc.object();
+        if (!doc.isObject()) error = "服务器返回了无效的数据格式";
+        else if (obj["status"].toString() != "success") error = obj["message"].toString("未知错误");
+    }
+
+    if (action == "upload_image") {
+        --m_uploadsInFlight;
+        const QString hash = reply->property(kHashProperty).toString();
+        if (error.isEmpty()) ImageDedupe::remember(hash, obj["url"].toString());
+        finishHash(hash, obj["url"].toString(), error);
+        startNextUploads();
+        return;
+    }
+    if (action == "check_images") {
+        // 查询失败不影响上传，只是这一批无法去重
+        onCheckReply(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt(), obj);
+        return;
+    }
+
+    if (!error.isEmpty()) {
+        emit failed(action, error, connectivity);
+        return;
+    }
+
+    if (action == "login") {
+        m_sessionKey = obj["session_key"].toString();
+        if (m_sessionKey.isEmpty()) {
+            emit failed(action, obj["message"].toString("登录响应中没有会话密钥"), false);
+            return;
+        }
+        emit loggedIn(obj["username"].toString());
+    } else if (action == "get_all_data") {
+        if (!obj["data"].isObject()) {
+            emit failed(action, "数据结构错误：缺少 'data' 对象", false);
+            return;
+        }
+        DataStore::instance()->resetFromSync(DataSerializer::syncDataFromJson(obj["data"].toObject()));
+        emit synced(DataStore::instance()->current());
+    } else {
+        emit saved(action, obj["message"].toString());
+    }
+}
@@ -0,0 +1,75 @@
+// catalogclient.h
+#ifndef CATALOGCLIENT_H
+#define CATALOGCLIENT_H
+
+#include <QObject>
+#include <QHash>
+#include <QStringList>
+#include <QJsonArray>
+#include "datastructures.h"
+#include "datastore.h"
+
+class QNetworkAccessManager;
+class QNetworkReply;
+
+// --- 不依赖界面的 API 客户端 ---
+// 登录、同步、整表保存和图片上传的完整请求/响应处理，结果以信号返回。
+// 图形界面之外（命令行工具、定时任务、性能测试）都通过它访问服务器；
+// 同步结果直接发布到 DataStore，与界面共用同一份快照。
+class CatalogClient : public QObject
+{
+    Q_OBJECT
+
+public:
+    explicit CatalogClient(QObject *parent = nullptr);
+
+    QString sessionKey() const { return m_sessionKey; }
+    void setSessionKey(const QString &sessionKey) { m_sessionKey = sessionKey; }
+
+    void login(const QString &password);
+    void fetchAll();
+    void save(const QString &action, const QJsonArray &payload);
+    void saveJobs(const QList<Job> &jobs);
+    void saveProducts(const QList<Product> &products);
+
+    // 批量上传图片。先并行计算内容哈希，内容相同的文件只传一次；
+    // 本地缓存或服务器（check_images）已有的图片直接复用地址。
+    // 真正上传时同时在途的请求数与单个主机的连接数上限一致，
+    // 既能占满连接，又不会一次性打开成千上万个本地文件
+    void uploadImages(const QString &type, const QStringList &filePaths);
+
+signals:
+    void loggedIn(const QString &username);
+    void synced(SnapshotPtr snapshot);
+    void saved(const QString &action, const QString &message);
+    void imageUploaded(const QString &filePath, const QString &url);
+    void imageUploadFailed(const QString &filePath, const QString &message);
+    // 本批图片全部结束；urls 为本地路径 -> 服务器地址，只包含成功的部分
+    void imagesUploaded(const QHash<QString, QString> &urls, const QStringList &failed);
+    // 登录、同步或保存失败；connectivity 表示是连不上服务器
+    void failed(const QString &action, const QString &message, bool connectivity);
+
+private slots:
+    void onReply(QNetworkReply *reply);
+
+private:
+    QNetworkAccessManager *m_networkManager;
+    QString m_sessionKey;
+
+    // 批量上传的状态；m_uploadQueue 中是待上传的哈希，每个哈希只上传其中一个文件
+    QString m_uploadType;
+    QHash<QString, QStringList> m_pathsByHash;
+    QStringList m_uploadQueue;
+    int m_uploadsInFlight = 0;
+    int m_uploadsRemaining = 0; // 尚未有结果的文件数
+    QHash<QString, QString> m_uploadedUrls;
+    QStringList m_failedUploads;
+
+    void onHashesReady(const QStringList &filePaths, const QStringList &hashes);
+    void onCheckReply(int httpStatus, const QJsonObject &reply);
+    void startNextUploads();
+    void finishUpload(const QString &filePath, const QString &url, const QString &error);
+    void finishHash(const QString &hash, const QString &url, const QString &error);
+};
+
+#endif // CATALOGCLIENT_H
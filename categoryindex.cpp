@@ -0,0 +1,62 @@
+// categoryindex.cpp
+#include "categoryindex.h"
+
+#include <algorithm>
+
+void CategoryIndex::rebuild(const QList<QSharedPointer<const Product>> &products)
+{
+    m_postings.clear();
+    for (int row = 0; row < products.size(); ++row)
+        m_postings[products[row]->category].append(row); // 按行号顺序追加，天然有序
+    m_total = products.size();
+}
+
+void CategoryIndex::insert(int row, const QString &category)
+{
+    shiftRows(row, 1);
+    addRow(category, row);
+    ++m_total;
+}
+
+void CategoryIndex::remove(int row, const QString &category)
+{
+    removeRow(category, row);
+    shiftRows(row + 1, -1);
+    --m_total;
+}
+
+void CategoryIndex::update(int row, const QString &oldCategory, const QString &newCategory)
+{
+    if (oldCategory == newCategory) return;
+    removeRow(oldCategory, row);
+    addRow(newCategory, row);
+}
+
+void CategoryIndex::addRow(const QString &category, int row)
+{
+    QList<int> &rows = m_postings[category];
+    rows.insert(std::lower_bound(rows.begin(), rows.end(), row), row);
+}
+
+void CategoryIndex::removeRow(const QString &category, int row)
+{
+    auto it = m_postings.find(category);
+    if (it == m_postings.end()) return;
+    QList<int> &rows = it.value();
+    auto pos = std::lower_bound(rows.begin(), rows.end(), row);
+    if (pos != rows.end() && *pos == row) rows.erase(pos);
+    if (rows.isEmpty()) m_postings.erase(it);
+}
+
+void CategoryIndex::shiftRows(int from, int delta)
+{
+    // 只改动确实含有 >= from 行号的列表，其余列表继续与旧快照共享
+    const QStringList keys = m_postings.keys();
+    for (const QString &key : keys) {
+        const QList<int> &current = m_postings.value(key);
+        if (current.isEmpty() || current.last() < from) continue;
+        QList<int> &rows = m_postings[key];
+        for (auto it = std::lower_bound(rows.begin(), rows.end(), from); it != rows.end(); ++it)
+            *it += delta;
+    }
+}
@@ -0,0 +1,44 @@
+// categoryindex.h
+#ifndef CATEGORYINDEX_H
+#define CATEGORYINDEX_H
+
+#include <QMap>
+#include <QList>
+#include <QSharedPointer>
+#include <QStringList>
+#include "datastructures.h"
+
+// --- 产品分类的倒排索引 ---
+// 分类 -> 该分类下产品所在行号（升序）。随每次编辑增量维护，
+// 切换分类筛选、显示每个分类的数量时都直接查表，不需要重新扫描整个产品列表。
+// 索引作为快照的一部分保存；QMap 和每个行号列表都是隐式共享的，
+// 修改一个产品的分类只会复制受影响的那一两个列表。
+class CategoryIndex
+{
+public:
+    void rebuild(const QList<QSharedPointer<const Product>> &products);
+
+    // 在 row 处插入 / 删除一个产品，后面产品的行号随之移动
+    void insert(int row, const QString &category);
+    void remove(int row, const QString &category);
+    // 产品的分类从 oldCategory 改成了 newCategory（行号不变）
+    void update(int row, const QString &oldCategory, const QString &newCategory);
+
+    // 所有非空的分类，按名称排序；空字符串代表“未分类”
+    QStringList categories() const { return m_postings.keys(); }
+    bool contains(const QString &category) const { return m_postings.contains(category); }
+    int count(const QString &category) const { return m_postings.value(category).size(); }
+    QList<int> rows(const QString &category) const { return m_postings.value(category); }
+    int total() const { return m_total; }
+
+private:
+    QMap<QString, QList<int>> m_postings;
+    int m_total = 0;
+
+    void addRow(const QString &category, int row);
+    void removeRow(const QString &category, int row);
+    // 把所有 >= from 的行号加上 delta
+    void shiftRows(int from, int delta);
+};
+
+#endif // CATEGORYINDEX_H
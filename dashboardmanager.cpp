@@ -1,6 +1,37 @@
 // dashboardmanager.cpp
 #include "dashboardmanager.h"
 #include "ui_dashboardmanager.h"
+#include "metricshistory.h"
+#include "multisitesync.h"
+#include "siteregistry.h"
+
+#include <QDateTime>
+#include <QHeaderView>
+#include <QInputDialog>
+#include <QMessageBox>
+
+namespace {
+
+enum SiteColumn { NameColumn, AddressColumn, StateColumn, JobsColumn, ProductsColumn, CasesColumn, QuotaColumn, SiteColumnCount };
+
+QString stateText(const SiteSyncStatus &status)
+{
+    switch (status.state) {
+    case SiteSyncStatus::NotLoggedIn: return status.error.isEmpty() ? QString("未登录") : "登录失败：" + status.error;
+    case SiteSyncStatus::Idle:        return "已登录";
+    case SiteSyncStatus::LoggingIn:   return "正在登录...";
+    case SiteSyncStatus::Queued:      return "等待中...";
+    case SiteSyncStatus::Syncing:     return "正在同步...";
+    case SiteSyncStatus::Synced:
+        return status.elapsedMs > 0
+                   ? QString("%1 同步（%2 ms）").arg(status.syncedAt.toString("HH:mm:ss")).arg(status.elapsedMs)
+                   : QString("%1 同步").arg(status.syncedAt.toString("HH:mm:ss"));
+    case SiteSyncStatus::Failed:      return "同步失败：" + status.error;
+    }
+    return QString();
+}
+
+} // namespace
 
 DashboardManager::DashboardManager(QWidget *parent) :
     QWidget(parent),
@@ -10,6 +41,47 @@ DashboardManager::DashboardManager(QWidget *parent) :
     // 将UI中的刷新按钮的 clicked() 信号，连接到我们自己的槽函数上
     // 请确保您在UI设计器中，将刷新按钮的 objectName 设为 refreshButton
     connect(ui->refreshButton, &QPushButton::clicked, this, &DashboardManager::on_refreshButton_clicked);
+
+    auto *store = DataStore::instance();
+    connect(store, &DataStore::dataReset, this, &DashboardManager::onDataReset);
+    if (store->current()->hasStats) updateStats(store->current()->stats);
+
+    // 历史趋势：指标和时间范围（天数，0 表示全部）
+    ui->trendMetricComboBox->blockSignals(true);
+    ui->trendRangeComboBox->blockSignals(true);
+    for (int m = 0; m < MetricsHistory::MetricCount; ++m)
+        ui->trendMetricComboBox->addItem(MetricsHistory::metricName(MetricsHistory::Metric(m)), m);
+    ui->trendRangeComboBox->addItem("最近 7 天", 7);
+    ui->trendRangeComboBox->addItem("最近 30 天", 30);
+    ui->trendRangeComboBox->addItem("最近 90 天", 90);
+    ui->trendRangeComboBox->addItem("最近一年", 365);
+    ui->trendRangeComboBox->addItem("全部", 0);
+    ui->trendRangeComboBox->setCurrentIndex(3);
+    ui->trendMetricComboBox->blockSignals(false);
+    ui->trendRangeComboBox->blockSignals(false);
+
+    connect(MetricsHistory::instance(), &MetricsHistory::sampleAppended, this, &DashboardManager::updateTrendChart);
+    updateTrendChart();
+
+    // 多站点汇总：每行一个站点，最后一行是合计
+    ui->siteTable->setColumnCount(SiteColumnCount);
+    ui->siteTable->setHorizontalHeaderLabels({"网站", "地址", "状态", "职位", "产品", "案例", "招聘人数"});
+    ui->siteTable->verticalHeader()->setVisible(false);
+    ui->siteTable->horizontalHeader()->setSectionResizeMode(AddressColumn, QHeaderView::Stretch);
+    connect(SiteRegistry::instance(), &SiteRegistry::sitesChanged, this, &DashboardManager::updateSiteTable);
+    connect(MultiSiteSync::instance(), &MultiSiteSync::statusChanged, this, &DashboardManager::updateSiteTable);
+    connect(MultiSiteSync::instance(), &MultiSiteSync::loginFinished, this,
+            [this](const QString &siteId, bool ok, const QString &message) {
+        if (ok) MultiSiteSync::instance()->sync(siteId);
+        else QMessageBox::warning(this, "登录失败", SiteRegistry::instance()->site(siteId).name + "：" + message);
+    });
+    connect(MultiSiteSync::instance(), &MultiSiteSync::allFinished, this, [this](qint64 elapsedMs) {
+        ui->syncSitesButton->setEnabled(true);
+        ui->syncSitesButton->setText(elapsedMs > 0 ? QString("刷新全部网站（上次 %1 秒）").arg(elapsedMs / 1000.0, 0, 'f', 1)
+                                                   : QString("刷新全部网站"));
+    });
+    updateSiteTable();
+    on_siteTable_itemSelectionChanged();
 }
 
 DashboardManager::~DashboardManager()
@@ -29,9 +101,166 @@ void DashboardManager::updateStats(const DashboardStats &stats)
     ui->serverTimeLabel->setText(stats.serverTime);
 }
 
+void DashboardManager::onDataReset(SnapshotPtr snapshot, DataStore::Sections sections)
+{
+    if ((sections & DataStore::Stats) && snapshot->hasStats) updateStats(snapshot->stats);
+}
+
+void DashboardManager::on_trendMetricComboBox_currentIndexChanged(int)
+{
+    updateTrendChart();
+}
+
+void DashboardManager::on_trendRangeComboBox_currentIndexChanged(int)
+{
+    updateTrendChart();
+}
+
+void DashboardManager::updateTrendChart()
+{
+    const auto metric = MetricsHistory::Metric(ui->trendMetricComboBox->currentData().toInt());
+    const int days = ui->trendRangeComboBox->currentData().toInt();
+    const qint64 since = days > 0 ? QDateTime::currentDateTime().addDays(-days).toMSecsSinceEpoch() : 0;
+    ui->trendChart->setSeries(MetricsHistory::instance()->series(metric, since),
+                              MetricsHistory::metricName(metric), MetricsHistory::metricUnit(metric));
+}
+
 // 实现按钮点击的槽函数
 void DashboardManager::on_refreshButton_clicked()
 {
     // 当用户点击刷新时，发射一个信号，通知MainWindow该干活了
     emit requestRefreshAllData();
 }
+
+QString DashboardManager::selectedSiteId() const
+{
+    const QList<QTableWidgetItem *> selected = ui->siteTable->selectedItems();
+    return selected.isEmpty() ? QString() : ui->siteTable->item(selected.first()->row(), NameColumn)->data(Qt::UserRole).toString();
+}
+
+void DashboardManager::updateSiteTable()
+{
+    const QString selectedId = selectedSiteId();
+    const QString currentId = SiteRegistry::instance()->currentSiteId();
+    const QList<Site> sites = SiteRegistry::instance()->sites();
+    auto *sync = MultiSiteSync::instance();
+
+    ui->siteTable->setRowCount(sites.size() + 1);
+    auto setCell = [this](int row, int column, const QString &text) {
+        QTableWidgetItem *item = ui->siteTable->item(row, column);
+        if (!item) {
+            item = new QTableWidgetItem;
+            ui->siteTable->setItem(row, column, item);
+        }
+        item->setText(text);
+        return item;
+    };
+    auto countText = [](const SiteSyncStatus &status, int value) {
+        return status.hasStats ? QString::number(value) : QString("-");
+    };
+
+    for (int row = 0; row < sites.size(); ++row) {
+        const Site &site = sites[row];
+        const SiteSyncStatus status = sync->status(site.id);
+        QTableWidgetItem *nameItem = setCell(row, NameColumn, site.id == currentId ? site.name + "（当前）" : site.name);
+        nameItem->setData(Qt::UserRole, site.id);
+        setCell(row, AddressColumn, site.apiUrl.toString());
+        setCell(row, StateColumn, stateText(status))->setToolTip(status.error);
+        setCell(row, JobsColumn, countText(status, status.stats.totalJobsCount));
+        setCell(row, ProductsColumn, countText(status, status.stats.totalProductsCount));
+        setCell(row, CasesColumn, countText(status, status.stats.totalCasesCount));
+        setCell(row, QuotaColumn, countText(status, status.stats.totalRecruitmentQuota));
+        if (site.id == selectedId) ui->siteTable->selectRow(row);
+    }
+
+    const int totalRow = sites.size();
+    const DashboardStats total = sync->totals();
+    for (int column = 0; column < SiteColumnCount; ++column) {
+        QTableWidgetItem *item = setCell(totalRow, column, QString());
+        QFont bold = item->font();
+        bold.setBold(true);
+        item->setFont(bold);
+    }
+    setCell(totalRow, NameColumn, "合计");
+    setCell(totalRow, JobsColumn, QString::number(total.totalJobsCount));
+    setCell(totalRow, ProductsColumn, QString::number(total.totalProductsCount));
+    setCell(totalRow, CasesColumn, QString::number(total.totalCasesCount));
+    setCell(totalRow, QuotaColumn, QString::number(total.totalRecruitmentQuota));
+}
+
+void DashboardManager::on_siteTable_itemSelectionChanged()
+{
+    const Site site = SiteRegistry::instance()->site(selectedSiteId());
+    ui->addressLine->setText(site.id.isEmpty() ? SiteRegistry::instance()->currentSite().apiUrl.toString()
+                                               : site.apiUrl.toString());
+}
+
+void DashboardManager::on_addressSetting_clicked()
+{
+    QString siteId = selectedSiteId();
+    if (siteId.isEmpty()) siteId = SiteRegistry::instance()->currentSiteId();
+    const Site site = SiteRegistry::instance()->site(siteId);
+    const QUrl url = QUrl::fromUserInput(ui->addressLine->text().trimmed());
+    if (!SiteRegistry::isValidApiUrl(url)) {
+        QMessageBox::warning(this, "地址无效", "请输入完整的 API 地址，例如 https://example.com/api.php");
+        return;
+    }
+    if (url == site.apiUrl) return;
+    if (siteId == SiteRegistry::instance()->currentSiteId()
+        && QMessageBox::question(this, "更新地址", "这是当前登录的网站，修改地址后需要重新登录才能继续编辑。确定修改吗？")
+               != QMessageBox::Yes) {
+        return;
+    }
+    SiteRegistry::instance()->updateSite(siteId, site.name, url);
+}
+
+void DashboardManager::on_addSiteButton_clicked()
+{
+    bool ok = false;
+    const QString address = QInputDialog::getText(this, "添加网站", "API 地址：", QLineEdit::Normal,
+                                                  "https://", &ok).trimmed();
+    if (!ok || address.isEmpty()) return;
+    const QUrl url = QUrl::fromUserInput(address);
+    if (!SiteRegistry::isValidApiUrl(url)) {
+        QMessageBox::warning(this, "地址无效", "请输入完整的 API 地址，例如 https://example.com/api.php");
+        return;
+    }
+    const QString name = QInputDialog::getText(this, "添加网站", "名称：", QLineEdit::Normal, url.host(), &ok);
+    if (!ok) return;
+    SiteRegistry::instance()->addSite(name, url);
+}
+
+void DashboardManager::on_loginSiteButton_clicked()
+{
+    const Site site = SiteRegistry::instance()->site(selectedSiteId());
+    if (site.id.isEmpty()) {
+        QMessageBox::information(this, "登录网站", "请先在表格中选择一个网站。");
+        return;
+    }
+    bool ok = false;
+    const QString password = QInputDialog::getText(this, "登录网站", site.name + " 的管理员密码：",
+                                                   QLineEdit::Password, QString(), &ok);
+    if (!ok || password.isEmpty()) return;
+    MultiSiteSync::instance()->login(site.id, password);
+}
+
+void DashboardManager::on_removeSiteButton_clicked()
+{
+    const Site site = SiteRegistry::instance()->site(selectedSiteId());
+    if (site.id.isEmpty()) return;
+    if (site.id == SiteRegistry::instance()->currentSiteId()) {
+        QMessageBox::information(this, "移除网站", "不能移除当前登录的网站。");
+        return;
+    }
+    if (QMessageBox::question(this, "移除网站", QString("确定移除“%1”吗？").arg(site.name)) != QMessageBox::Yes) return;
+    SiteRegistry::instance()->removeSite(site.id);
+}
+
+void DashboardManager::on_syncSitesButton_clicked()
+{
+    // 当前网站走常规同步，其余网站在共享的连接预算内并发拉取
+    ui->syncSitesButton->setEnabled(false);
+    ui->syncSitesButton->setText("正在刷新...");
+    emit requestRefreshAllData();
+    MultiSiteSync::instance()->syncAll();
+}
@@ -4,6 +4,7 @@
 
 #include <QWidget>
 #include "datastructures.h" // 引入我们定义的数据结构
+#include "datastore.h"
 
 namespace Ui {
 class DashboardManager;
@@ -24,12 +25,30 @@ public slots:
 private slots:
     // 响应“刷新”按钮的点击事件
     void on_refreshButton_clicked();
+    // 统计数据随同步一起放在 DataStore 的快照里
+    void onDataReset(SnapshotPtr snapshot, DataStore::Sections sections);
+
+    // 历史趋势：切换指标 / 时间范围，或者有了新样本
+    void on_trendMetricComboBox_currentIndexChanged(int index);
+    void on_trendRangeComboBox_currentIndexChanged(int index);
+    void updateTrendChart();
+
+    // 多站点：登记表、登录、汇总同步
+    void on_addSiteButton_clicked();
+    void on_loginSiteButton_clicked();
+    void on_removeSiteButton_clicked();
+    void on_syncSitesButton_clicked();
+    void on_addressSetting_clicked();
+    void on_siteTable_itemSelectionChanged();
+    void updateSiteTable();
 
 signals:
     // 定义一个信号，用于在用户点击刷新时，通知MainWindow去服务器获取新数据
     void requestRefreshAllData();
 
 private:
+    QString selectedSiteId() const;
+
     Ui::DashboardManager *ui;
 };
 
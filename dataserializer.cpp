@@ -0,0 +1,228 @@
+// dataserializer.cpp
+#include "dataserializer.h"
+#include "formbodywriter.h"
+#include "stallwatchdog.h"
+#include "tracelog.h"
+
+namespace {
+
+QStringList toStringList(const QJsonValue &value)
+{
+    QStringList list;
+    for (const QJsonValue &v : value.toArray())
+        list.append(v.toString());
+    return list;
+}
+
+QString wireSalary(const Job &job)
+{
+    return job.salaryEnd.isEmpty() ? job.salaryStart : job.salaryStart.trimmed() + " - " + job.salaryEnd.trimmed();
+}
+
+// 请求体大小的粗略估计：ASCII 字符编码后基本不变，中文每个字编码成 9 个字节，按 3 倍预留，
+// 以中文为主的数据再扩容一两次即可
+qsizetype estimateBody(qsizetype textLength, qsizetype records)
+{
+    return textLength * 3 + records * 96 + 128;
+}
+
+} // namespace
+
+namespace DataSerializer {
+
+QJsonObject toJson(const Job &job)
+{
+    QJsonObject obj;
+    obj["title"]        = job.title;
+    obj["quota"]        = job.quota;
+    obj["salaryStart"]  = job.salaryStart;
+    obj["salaryEnd"]    = job.salaryEnd;
+    obj["requirements"] = job.requirements;
+    return obj;
+}
+
+QJsonObject toJson(const Product &product)
+{
+    QJsonObject obj;
+    obj["name"]        = product.name;
+    obj["category"]    = product.category;
+    obj["description"] = product.description;
+    obj["imageUrls"]   = QJsonArray::fromStringList(product.imageUrls);
+    return obj;
+}
+
+QJsonObject toJson(const CaseStudy &caseStudy)
+{
+    QJsonObject obj;
+    obj["title"]       = caseStudy.title;
+    obj["description"] = caseStudy.description;
+    obj["imageUrls"]   = QJsonArray::fromStringList(caseStudy.imageUrls);
+    return obj;
+}
+
+Job jobFromJson(const QJsonObject &obj)
+{
+    Job job;
+    job.title        = obj["title"].toString();
+    job.quota        = obj["quota"].toString();
+    job.salaryStart  = obj["salaryStart"].toString();
+    job.salaryEnd    = obj["salaryEnd"].toString();
+    job.requirements = obj["requirements"].toString();
+    return job;
+}
+
+Product productFromJson(const QJsonObject &obj)
+{
+    Product product;
+    product.name        = obj["name"].toString();
+    product.category    = obj["category"].toString();
+    product.description = obj["description"].toString();
+    product.imageUrls   = toStringList(obj["imageUrls"]);
+    return product;
+}
+
+CaseStudy caseFromJson(const QJsonObject &obj)
+{
+    CaseStudy caseStudy;
+    caseStudy.title       = obj["title"].toString();
+    caseStudy.description = obj["description"].toString();
+    caseStudy.imageUrls   = toStringList(obj["imageUrls"]);
+    return caseStudy;
+}
+
+QJsonArray toJsonArray(const QList<Job> &jobs)
+{
+    QJsonArray array;
+    for (const auto &job : jobs) array.append(toJson(job));
+    return array;
+}
+
+QJsonArray toJsonArray(const QList<Product> &products)
+{
+    QJsonArray array;
+    for (const auto &product : products) array.append(toJson(product));
+    return array;
+}
+
+QList<Job> jobsFromJson(const QJsonArray &array)
+{
+    QList<Job> jobs;
+    jobs.reserve(array.size());
+    for (const QJsonValue &v : array) jobs.append(jobFromJson(v.toObject()));
+    return jobs;
+}
+
+QList<Product> productsFromJson(const QJsonArray &array)
+{
+    QList<Product> products;
+    products.reserve(array.size());
+    for (const QJsonValue &v : array) products.append(productFromJson(v.toObject()));
+    return products;
+}
+
+QJsonArray toWireArray(const QList<Job> &jobs)
+{
+    QJsonArray jobsArray;
+    for (const auto &job : jobs) {
+        QJsonObject jobObj;
+        jobObj["title"] = job.title;
+        jobObj["quota"] = job.quota;
+        jobObj["salary"] = wireSalary(job);
+        jobObj["requirements"] = job.requirements;
+        jobsArray.append(jobObj);
+    }
+    return jobsArray;
+}
+
+QJsonArray toWireArray(const QList<Product> &products)
+{
+    // 产品的服务器格式与本地格式一致
+    return toJsonArray(products);
+}
+
+// 键按字母顺序写出，与 QJsonObject 序列化的顺序一致
+QByteArray saveBody(const QString &sessionKey, const QList<Job> &jobs)
+{
+    qsizetype textLength = 0;
+    for (const auto &job : jobs)
+        textLength += job.title.size() + job.quota.size() + job.salaryStart.size() + job.salaryEnd.size() + job.requirements.size();
+
+    FormBodyWriter writer(estimateBody(textLength, jobs.size()));
+    writer.addField("action", "save_jobs");
+    writer.addField("key", sessionKey);
+    writer.beginJsonField("data");
+    writer.beginArray();
+    for (const auto &job : jobs) {
+        writer.beginObject();
+        writer.key("quota");        writer.value(job.quota);
+        writer.key("requirements"); writer.value(job.requirements);
+        writer.key("salary");       writer.value(wireSalary(job));
+        writer.key("title");        writer.value(job.title);
+        writer.endObject();
+    }
+    writer.endArray();
+    return writer.take();
+}
+
+QByteArray saveBody(const QString &sessionKey, const QList<Product> &products)
+{
+    qsizetype textLength = 0;
+    for (const auto &product : products) {
+        textLength += product.name.size() + product.category.size() + product.description.size();
+        for (const QString &url : product.imageUrls) textLength += url.size() + 3;
+    }
+
+    FormBodyWriter writer(estimateBody(textLength, products.size()));
+    writer.addField("action", "save_products");
+    writer.addField("key", sessionKey);
+    writer.beginJsonField("data");
+    writer.beginArray();
+    for (const auto &product : products) {
+        writer.beginObject();
+        writer.key("category");    writer.value(product.category);
+        writer.key("description"); writer.value(product.description);
+        writer.key("imageUrls");   writer.value(product.imageUrls);
+        writer.key("name");        writer.value(product.name);
+        writer.endObject();
+    }
+    writer.endArray();
+    return writer.take();
+}
+
+DashboardStats statsFromJson(const QJsonObject &obj)
+{
+    DashboardStats stats;
+    stats.totalJobsCount        = obj["total_jobs_count"].toInt();
+    stats.totalProductsCount    = obj["total_products_count"].toInt();
+    stats.totalCasesCount       = obj["total_cases_count"].toInt();
+    stats.totalRecruitmentQuota = obj["total_recruitment_quota"].toInt();
+    stats.serverTime            = obj["server_time"].toString();
+    return stats;
+}
+
+SyncData syncDataFromJson(const QJsonObject &data)
+{
+    StallWatchdog::Scope stallScope("DataSerializer::syncDataFromJson");
+    SyncData sync;
+    // 同步下来的职位同样使用起止两个薪资字段，与本地格式一致
+    if (data["jobs"].isArray()) {
+        TraceLog::Span span("parse", "parse jobs");
+        sync.jobs = jobsFromJson(data["jobs"].toArray());
+        sync.hasJobs = true;
+        span.setDetail(QString("%1 条").arg(sync.jobs.size()));
+    }
+    if (data["products"].isArray()) {
+        TraceLog::Span span("parse", "parse products");
+        sync.products = productsFromJson(data["products"].toArray());
+        sync.hasProducts = true;
+        span.setDetail(QString("%1 条").arg(sync.products.size()));
+    }
+    if (data["stats"].isObject()) {
+        TraceLog::Span span("parse", "parse stats");
+        sync.stats = statsFromJson(data["stats"].toObject());
+        sync.hasStats = true;
+    }
+    return sync;
+}
+
+} // namespace DataSerializer
@@ -0,0 +1,44 @@
+// dataserializer.h
+#ifndef DATASERIALIZER_H
+#define DATASERIALIZER_H
+
+#include "datastructures.h"
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QList>
+#include <QByteArray>
+
+// --- 数据结构与本地 JSON 之间的转换 ---
+// toJson/fromJson 使用客户端自己的字段格式（例如薪资拆成起止两个字段），
+// 用于本地保存和恢复；toWireArray 生成发往服务器的保存格式。
+namespace DataSerializer {
+
+QJsonObject toJson(const Job &job);
+QJsonObject toJson(const Product &product);
+QJsonObject toJson(const CaseStudy &caseStudy);
+
+Job jobFromJson(const QJsonObject &obj);
+Product productFromJson(const QJsonObject &obj);
+CaseStudy caseFromJson(const QJsonObject &obj);
+
+QJsonArray toJsonArray(const QList<Job> &jobs);
+QJsonArray toJsonArray(const QList<Product> &products);
+QList<Job> jobsFromJson(const QJsonArray &array);
+QList<Product> productsFromJson(const QJsonArray &array);
+
+// 发往服务器 save_jobs / save_products 的格式（职位薪资合并为一个字段）
+QJsonArray toWireArray(const QList<Job> &jobs);
+QJsonArray toWireArray(const QList<Product> &products);
+
+// 直接写出整表保存的表单请求体（action、key、data 三个字段），与 postSave(toWireArray(...)) 发出的内容等价，
+// 但不经过 QJsonArray / QString / QUrlQuery，只编码一遍；配合 NetworkSession::postForm() 使用
+QByteArray saveBody(const QString &sessionKey, const QList<Job> &jobs);
+QByteArray saveBody(const QString &sessionKey, const QList<Product> &products);
+
+// 解析 get_all_data 响应中的 data 对象（服务器格式）
+DashboardStats statsFromJson(const QJsonObject &obj);
+SyncData syncDataFromJson(const QJsonObject &data);
+
+} // namespace DataSerializer
+
+#endif // DATASERIALIZER_H
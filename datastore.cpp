@@ -0,0 +1,185 @@
+// datastore.cpp
+#include "datastore.h"
+
+#include <QCoreApplication>
+
+namespace {
+
+template <typename T>
+RecordList<T> toRecords(const QList<T> &values)
+{
+    RecordList<T> records;
+    records.reserve(values.size());
+    for (const T &value : values)
+        records.append(RecordPtr<T>::create(value));
+    return records;
+}
+
+template <typename T>
+QList<T> toValues(const RecordList<T> &records)
+{
+    QList<T> values;
+    values.reserve(records.size());
+    for (const auto &record : records)
+        values.append(*record);
+    return values;
+}
+
+} // namespace
+
+QList<Job> Snapshot::jobValues() const
+{
+    return toValues(jobs);
+}
+
+QList<Product> Snapshot::productValues() const
+{
+    return toValues(products);
+}
+
+DataStore *DataStore::instance()
+{
+    static DataStore *store = new DataStore(qApp);
+    return store;
+}
+
+DataStore::DataStore(QObject *parent)
+    : QObject(parent)
+    , m_current(SnapshotPtr::create())
+{
+}
+
+Snapshot DataStore::nextSnapshot() const
+{
+    Snapshot next = *m_current; // 记录列表是隐式共享的，这里只增加引用计数
+    next.version = m_current->version + 1;
+    return next;
+}
+
+void DataStore::publish(const Snapshot &next, Sections sections, bool reset)
+{
+    m_current = SnapshotPtr::create(next);
+    if (reset) emit dataReset(m_current, sections);
+    else emit dataEdited(m_current, sections);
+}
+
+void DataStore::publishEdit(const Snapshot &next, Sections sections)
+{
+    Snapshot copy = next;
+    copy.version = m_current->version + 1;
+    if (sections & Products) copy.productCategories.rebuild(copy.products);
+    publish(copy, sections, false);
+}
+
+void DataStore::resetJobs(const QList<Job> &jobs)
+{
+    resetFromSync(&jobs, nullptr, nullptr);
+}
+
+void DataStore::resetProducts(const QList<Product> &products)
+{
+    resetFromSync(nullptr, &products, nullptr);
+}
+
+void DataStore::resetStats(const DashboardStats &stats)
+{
+    resetFromSync(nullptr, nullptr, &stats);
+}
+
+void DataStore::resetFromSync(const QList<Job> *jobs, const QList<Product> *products, const DashboardStats *stats)
+{
+    Snapshot next = nextSnapshot();
+    Sections sections;
+    if (jobs) {
+        next.jobs = toRecords(*jobs);
+        sections |= Jobs;
+    }
+    if (products) {
+        next.products = toRecords(*products);
+        next.productCategories.rebuild(next.products);
+        sections |= Products;
+    }
+    if (stats) {
+        next.stats = *stats;
+        next.hasStats = true;
+        sections |= Stats;
+    }
+    publish(next, sections, true);
+}
+
+void DataStore::resetFromSync(const SyncData &data)
+{
+    resetFromSync(data.hasJobs ? &data.jobs : nullptr,
+                  data.hasProducts ? &data.products : nullptr,
+                  data.hasStats ? &data.stats : nullptr);
+    // 记录本身与刚发布的快照共享
+    if (data.hasJobs) m_base.jobs = m_current->jobs;
+    if (data.hasProducts) m_base.products = m_current->products;
+    m_base.version = m_current->version;
+    Sections synced;
+    if (data.hasJobs) synced |= Jobs;
+    if (data.hasProducts) synced |= Products;
+    if (data.hasJobs || data.hasProducts) emit baseChanged(synced, false);
+}
+
+void DataStore::markSaved(const QList<Job> &jobs)
+{
+    m_base.jobs = toRecords(jobs);
+    emit baseChanged(Jobs, true);
+}
+
+void DataStore::markSaved(const QList<Product> &products)
+{
+    m_base.products = toRecords(products);
+    emit baseChanged(Products, true);
+}
+
+void DataStore::setJob(int index, const Job &job)
+{
+    if (index < 0 || index >= m_current->jobs.size()) return;
+    Snapshot next = nextSnapshot();
+    next.jobs[index] = RecordPtr<Job>::create(job);
+    publish(next, Jobs, false);
+}
+
+void DataStore::insertJob(int index, const Job &job)
+{
+    Snapshot next = nextSnapshot();
+    next.jobs.insert(qBound(0, index, int(next.jobs.size())), RecordPtr<Job>::create(job));
+    publish(next, Jobs, false);
+}
+
+void DataStore::removeJob(int index)
+{
+    if (index < 0 || index >= m_current->jobs.size()) return;
+    Snapshot next = nextSnapshot();
+    next.jobs.removeAt(index);
+    publish(next, Jobs, false);
+}
+
+void DataStore::setProduct(int index, const Product &product)
+{
+    if (index < 0 || index >= m_current->products.size()) return;
+    Snapshot next = nextSnapshot();
+    next.productCategories.update(index, next.products[index]->category, product.category);
+    next.products[index] = RecordPtr<Product>::create(product);
+    publish(next, Products, false);
+}
+
+void DataStore::insertProduct(int index, const Product &product)
+{
+    Snapshot next = nextSnapshot();
+    index = qBound(0, index, int(next.products.size()));
+    next.products.insert(index, RecordPtr<Product>::create(product));
+    next.productCategories.insert(index, product.category);
+    publish(next, Products, false);
+}
+
+void DataStore::removeProduct(int index)
+{
+    if (index < 0 || index >= m_current->products.size()) return;
+    Snapshot next = nextSnapshot();
+    next.productCategories.remove(index, next.products[index]->category);
+    next.products.removeAt(index);
+    publish(next, Products, false);
+}
@@ -0,0 +1,108 @@
+// datastore.h
+#ifndef DATASTORE_H
+#define DATASTORE_H
+
+#include <QObject>
+#include <QList>
+#include <QSharedPointer>
+#include "datastructures.h"
+#include "categoryindex.h"
+
+// --- 全局共享的只读数据快照 ---
+// 以前每个模块各自持有一份 QList<Job>/QList<Product> 的拷贝，仪表盘又有一份统计数据，
+// 彼此之间会慢慢不一致。现在所有数据都放在 DataStore 的快照里：
+//   - 快照一旦发布就不再修改，模块只需持有 SnapshotPtr（一次引用计数），交接时不拷贝数据
+//   - 每条记录单独用共享指针保存；编辑一条记录会生成新版本的快照，
+//     新快照与旧快照共享所有未改动的记录，只有被改动的那一条是新对象
+//   - 版本号单调递增，任何模块都可以用它判断自己手里的数据是否最新
+template <typename T>
+using RecordPtr = QSharedPointer<const T>;
+
+template <typename T>
+using RecordList = QList<RecordPtr<T>>;
+
+struct Snapshot {
+    quint64 version = 0;
+    RecordList<Job> jobs;
+    RecordList<Product> products;
+    CategoryIndex productCategories; // 与 products 同步维护的分类索引
+    RecordList<CaseStudy> cases;
+    DashboardStats stats;
+    bool hasStats = false;
+
+    // 需要值列表的场合（序列化、发送）才展开
+    QList<Job> jobValues() const;
+    QList<Product> productValues() const;
+};
+
+using SnapshotPtr = QSharedPointer<const Snapshot>;
+
+class DataStore : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Section {
+        NoSection = 0x0,
+        Jobs      = 0x1,
+        Products  = 0x2,
+        Cases     = 0x4,
+        Stats     = 0x8
+    };
+    Q_DECLARE_FLAGS(Sections, Section)
+
+    static DataStore *instance();
+
+    SnapshotPtr current() const { return m_current; }
+    quint64 version() const { return m_current->version; }
+
+    // --- 整体替换（服务器同步、恢复、导入），会发出 dataReset ---
+    void resetJobs(const QList<Job> &jobs);
+    void resetProducts(const QList<Product> &products);
+    void resetStats(const DashboardStats &stats);
+    // 一次同步中的多个部分合并成一个版本，避免中间状态被其它模块看到
+    void resetFromSync(const QList<Job> *jobs, const QList<Product> *products, const DashboardStats *stats);
+    void resetFromSync(const SyncData &data);
+
+    // --- 单条编辑，会发出 dataEdited ---
+    void setJob(int index, const Job &job);
+    void insertJob(int index, const Job &job);
+    void removeJob(int index);
+
+    void setProduct(int index, const Product &product);
+    void insertProduct(int index, const Product &product);
+    void removeProduct(int index);
+
+    // 直接发布一个已经构造好的快照（例如撤销时回到旧版本的记录）
+    void publishEdit(const Snapshot &next, Sections sections);
+
+    // --- 与服务器一致的基准版本 ---
+    // 最近一次从服务器同步下来、或成功保存到服务器的职位和产品。多人同时编辑时，
+    // 保存前把本地数据和服务器的最新数据以它为共同祖先做三方合并（见 RecordMerge）
+    const Snapshot &syncBase() const { return m_base; }
+    // 保存成功后调用：服务器上现在就是这份列表
+    void markSaved(const QList<Job> &jobs);
+    void markSaved(const QList<Product> &products);
+
+signals:
+    // 数据被整体替换，界面需要重建列表
+    void dataReset(SnapshotPtr snapshot, DataStore::Sections sections);
+    // 本地编辑产生了新版本，只需刷新受影响的显示
+    void dataEdited(SnapshotPtr snapshot, DataStore::Sections sections);
+    // 基准版本（syncBase）更新了：saved 为 false 表示来自同步，true 表示刚保存到服务器
+    void baseChanged(DataStore::Sections sections, bool saved);
+
+private:
+    explicit DataStore(QObject *parent = nullptr);
+
+    SnapshotPtr m_current;
+    Snapshot m_base; // 只使用 jobs 和 products
+
+    // 以当前快照为基础复制出下一版（只复制指针数组，不复制记录）
+    Snapshot nextSnapshot() const;
+    void publish(const Snapshot &next, Sections sections, bool reset);
+};
+
+Q_DECLARE_OPERATORS_FOR_FLAGS(DataStore::Sections)
+
+#endif // DATASTORE_H
@@ -4,6 +4,7 @@
 
 #include <QString>
 #include <QStringList>
+#include <QList>
 
 // --- 这里是我们项目所有共享数据结构的定义中心 ---
 
@@ -39,6 +40,31 @@ struct DashboardStats {
     QString serverTime;
 };
 
+// 一次 get_all_data 同步的结果；has* 表示服务器是否返回了对应部分
+struct SyncData {
+    QList<Job> jobs;
+    QList<Product> products;
+    DashboardStats stats;
+    bool hasJobs = false;
+    bool hasProducts = false;
+    bool hasStats = false;
+};
+
+// 逐字段比较，多人编辑时的三方合并用它判断一条记录是否被改过
+inline bool operator==(const Job &a, const Job &b)
+{
+    return a.title == b.title && a.quota == b.quota && a.salaryStart == b.salaryStart
+           && a.salaryEnd == b.salaryEnd && a.requirements == b.requirements;
+}
+inline bool operator!=(const Job &a, const Job &b) { return !(a == b); }
+
+inline bool operator==(const Product &a, const Product &b)
+{
+    return a.name == b.name && a.category == b.category && a.description == b.description
+           && a.imageUrls == b.imageUrls;
+}
+inline bool operator!=(const Product &a, const Product &b) { return !(a == b); }
+
 // Q_DECLARE_METATYPE(Job);      // 如果您需要在QVariant中使用这些结构体，
 // Q_DECLARE_METATYPE(Product);   // 就取消这些行的注释。目前我们还用不到。
 // Q_DECLARE_METATYPE(CaseStudy);
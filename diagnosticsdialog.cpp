@@ -0,0 +1,123 @@
+// diagnosticsdialog.cpp
+#include "diagnosticsdialog.h"
+#include "ui_diagnosticsdialog.h"
+#include "stallwatchdog.h"
+#include "tracelog.h"
+
+#include <QDateTime>
+#include <QFile>
+#include <QFileDialog>
+#include <QHeaderView>
+#include <QJsonDocument>
+#include <QMessageBox>
+
+namespace {
+
+QTableWidgetItem *numberItem(qint64 value)
+{
+    auto *item = new QTableWidgetItem;
+    item->setData(Qt::DisplayRole, value); // 按数值而不是字符串排序
+    item->setTextAlignment(Qt::AlignRight | Qt::AlignVCenter);
+    return item;
+}
+
+} // namespace
+
+DiagnosticsDialog::DiagnosticsDialog(QWidget *parent)
+    : QDialog(parent)
+    , ui(new Ui::DiagnosticsDialog)
+{
+    ui->setupUi(this);
+    setAttribute(Qt::WA_DeleteOnClose);
+
+    ui->offenderTable->setColumnCount(4);
+    ui->offenderTable->setHorizontalHeaderLabels({"归因", "次数", "累计 (ms)", "最长 (ms)"});
+    ui->recentTable->setColumnCount(4);
+    ui->recentTable->setHorizontalHeaderLabels({"时间", "时长 (ms)", "归因", "事件"});
+    for (QTableWidget *table : {ui->offenderTable, ui->recentTable}) {
+        table->verticalHeader()->hide();
+        table->horizontalHeader()->setStretchLastSection(true);
+    }
+    ui->offenderTable->horizontalHeader()->setSectionResizeMode(0, QHeaderView::Stretch);
+    ui->offenderTable->horizontalHeader()->setStretchLastSection(false);
+
+    connect(StallWatchdog::instance(), &StallWatchdog::stallDetected, this, &DiagnosticsDialog::refresh);
+    refresh();
+}
+
+DiagnosticsDialog::~DiagnosticsDialog()
+{
+    delete ui;
+}
+
+void DiagnosticsDialog::refresh()
+{
+    const StallWatchdog *watchdog = StallWatchdog::instance();
+    if (!watchdog->isRunning()) {
+        ui->summaryLabel->setText("卡顿监视未启动");
+    } else if (watchdog->stallCount() == 0) {
+        ui->summaryLabel->setText(QString("尚未检测到超过 %1 ms 的卡顿").arg(watchdog->thresholdMs()));
+    } else {
+        ui->summaryLabel->setText(QString("共检测到 %1 次超过 %2 ms 的卡顿，累计 %3 ms")
+                                      .arg(watchdog->stallCount())
+                                      .arg(watchdog->thresholdMs())
+                                      .arg(watchdog->totalStallMs()));
+    }
+
+    const QList<StallOffender> offenders = watchdog->worstOffenders();
+    ui->offenderTable->setRowCount(offenders.size());
+    for (int row = 0; row < offenders.size(); ++row) {
+        const StallOffender &o = offenders[row];
+        ui->offenderTable->setItem(row, 0, new QTableWidgetItem(o.label));
+        ui->offenderTable->setItem(row, 1, numberItem(o.count));
+        ui->offenderTable->setItem(row, 2, numberItem(o.totalMs));
+        ui->offenderTable->setItem(row, 3, numberItem(o.worstMs));
+    }
+
+    // 最新的卡顿显示在最上面
+    const QList<StallRecord> recent = watchdog->recentStalls();
+    ui->recentTable->setRowCount(recent.size());
+    for (int i = 0; i < recent.size(); ++i) {
+        const StallRecord &r = recent[recent.size() - 1 - i];
+        ui->recentTable->setItem(i, 0, new QTableWidgetItem(r.when.toString("HH:mm:ss.zzz")));
+        ui->recentTable->setItem(i, 1, numberItem(r.durationMs));
+        ui->recentTable->setItem(i, 2, new QTableWidgetItem(r.label));
+        ui->recentTable->setItem(i, 3, new QTableWidgetItem(r.eventLabel));
+    }
+}
+
+void DiagnosticsDialog::on_resetButton_clicked()
+{
+    StallWatchdog::instance()->reset();
+    refresh();
+}
+
+void DiagnosticsDialog::on_exportButton_clicked()
+{
+    const QString defaultName = QString("hrwindow-stalls-%1.json")
+                                    .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    const QString path = QFileDialog::getSaveFileName(this, "导出诊断数据", defaultName, "JSON (*.json)");
+    if (path.isEmpty()) return;
+
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        QMessageBox::critical(this, "导出失败", "无法写入文件: " + file.errorString());
+        return;
+    }
+    file.write(QJsonDocument(StallWatchdog::instance()->toJson()).toJson(QJsonDocument::Indented));
+}
+
+void DiagnosticsDialog::on_exportTraceButton_clicked()
+{
+    const QString defaultName = QString("hrwindow-trace-%1.json")
+                                    .arg(QDateTime::currentDateTime().toString("yyyyMMdd-HHmmss"));
+    const QString path = QFileDialog::getSaveFileName(this, "导出时间线", defaultName, "Chrome trace (*.json)");
+    if (path.isEmpty()) return;
+
+    QString error;
+    if (!TraceLog::dump(path, &error)) {
+        QMessageBox::critical(this, "导出失败", "无法写入文件: " + error);
+        return;
+    }
+    QMessageBox::information(this, "导出完成", "可以在 https://ui.perfetto.dev 或 chrome://tracing 中打开这个文件。");
+}
@@ -0,0 +1,33 @@
+// diagnosticsdialog.h
+#ifndef DIAGNOSTICSDIALOG_H
+#define DIAGNOSTICSDIALOG_H
+
+#include <QDialog>
+
+namespace Ui {
+class DiagnosticsDialog;
+}
+
+// --- 性能诊断窗口 ---
+// 显示 StallWatchdog 收集的界面卡顿次数、按归因汇总的排行和最近的明细，
+// 可以导出为 JSON 文件随问题反馈一起提交。窗口不阻塞主界面，新的卡顿会实时刷新。
+// 另外可以把 TraceLog 的时间线导出为 Chrome trace-event 文件，用 Perfetto 查看。
+class DiagnosticsDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit DiagnosticsDialog(QWidget *parent = nullptr);
+    ~DiagnosticsDialog();
+
+private slots:
+    void on_resetButton_clicked();
+    void on_exportButton_clicked();
+    void on_exportTraceButton_clicked();
+    void refresh();
+
+private:
+    Ui::DiagnosticsDialog *ui;
+};
+
+#endif // DIAGNOSTICSDIALOG_H
@@ -0,0 +1,101 @@
+// formbinding.cpp
+#include "formbinding.h"
+
+#include <QComboBox>
+#include <QLineEdit>
+#include <QPlainTextEdit>
+#include <QWidget>
+
+FormBinding::FormBinding(QWidget *form)
+    : QObject(form)
+    , m_form(form)
+{
+}
+
+int FormBinding::add(Kind kind, QWidget *widget)
+{
+    m_fields.append(Field{kind, widget});
+    return m_fields.size() - 1;
+}
+
+int FormBinding::addField(QLineEdit *edit)
+{
+    const int index = add(LineEdit, edit);
+    connect(edit, &QLineEdit::textChanged, this, [this, index]() { notify(index); });
+    return index;
+}
+
+int FormBinding::addField(QPlainTextEdit *edit)
+{
+    const int index = add(PlainTextEdit, edit);
+    connect(edit, &QPlainTextEdit::textChanged, this, [this, index]() { notify(index); });
+    return index;
+}
+
+int FormBinding::addField(QComboBox *combo)
+{
+    const int index = add(ComboBox, combo);
+    connect(combo, &QComboBox::currentTextChanged, this, [this, index]() { notify(index); });
+    return index;
+}
+
+void FormBinding::notify(int field)
+{
+    if (m_loading) return;
+    emit edited(field, value(field));
+}
+
+QString FormBinding::value(int field) const
+{
+    const Field &f = m_fields.at(field);
+    switch (f.kind) {
+    case LineEdit:      return static_cast<QLineEdit *>(f.widget)->text();
+    case PlainTextEdit: return static_cast<QPlainTextEdit *>(f.widget)->toPlainText();
+    case ComboBox:      return static_cast<QComboBox *>(f.widget)->currentText();
+    }
+    return QString();
+}
+
+void FormBinding::setValue(const Field &field, const QString &text)
+{
+    switch (field.kind) {
+    case LineEdit: {
+        auto *edit = static_cast<QLineEdit *>(field.widget);
+        if (edit->text() != text) edit->setText(text);
+        break;
+    }
+    case PlainTextEdit: {
+        auto *edit = static_cast<QPlainTextEdit *>(field.widget);
+        if (edit->toPlainText() != text) edit->setPlainText(text);
+        break;
+    }
+    case ComboBox: {
+        auto *combo = static_cast<QComboBox *>(field.widget);
+        if (combo->currentText() != text) combo->setCurrentText(text);
+        break;
+    }
+    }
+}
+
+void FormBinding::load(const QStringList &values)
+{
+    const bool updates = m_form->updatesEnabled();
+    m_form->setUpdatesEnabled(false);
+    m_loading = true;
+    for (int i = 0; i < m_fields.size(); ++i) setValue(m_fields[i], values.value(i));
+    m_loading = false;
+    m_form->setUpdatesEnabled(updates);
+}
+
+void FormBinding::clear()
+{
+    const bool updates = m_form->updatesEnabled();
+    m_form->setUpdatesEnabled(false);
+    m_loading = true;
+    for (const Field &field : std::as_const(m_fields)) {
+        if (field.kind == ComboBox) static_cast<QComboBox *>(field.widget)->setCurrentIndex(0);
+        else setValue(field, QString());
+    }
+    m_loading = false;
+    m_form->setUpdatesEnabled(updates);
+}
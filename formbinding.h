@@ -0,0 +1,129 @@
+// formbinding.h
+#ifndef FORMBINDING_H
+#define FORMBINDING_H
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <functional>
+#include "datastore.h"
+
+class QComboBox;
+class QLineEdit;
+class QPlainTextEdit;
+class QWidget;
+
+// --- 表单绑定 ---
+// 编辑表单里的每个控件对应记录的一个文本字段，绑定关系在构造时建立一次，之后不再断开、重连信号。
+// 切换记录时一次性写入所有控件：
+//   - 整个表单暂停重绘，写完后只重绘一次
+//   - 内容与控件现有内容相同的控件直接跳过（长文本的 setPlainText 要重建整个文档，代价最高）
+//   - 写入期间控件发出的修改信号被忽略，不会当成用户编辑
+// 用户修改控件时发出 edited(字段编号, 新内容)。
+class FormBinding : public QObject
+{
+    Q_OBJECT
+
+public:
+    // form 是包含所有绑定控件的窗口部件（通常就是所在的管理面板），写入时暂停它的重绘
+    explicit FormBinding(QWidget *form);
+
+    // 返回字段编号，按添加顺序从 0 开始
+    int addField(QLineEdit *edit);
+    int addField(QPlainTextEdit *edit);
+    int addField(QComboBox *combo); // 取 currentText，可编辑或不可编辑的下拉框都可以
+    int fieldCount() const { return m_fields.size(); }
+
+    // 按字段编号的顺序写入所有控件
+    void load(const QStringList &values);
+    // 清空所有控件（下拉框回到第一项）
+    void clear();
+    QString value(int field) const;
+
+signals:
+    void edited(int field, const QString &text);
+
+private:
+    enum Kind { LineEdit, PlainTextEdit, ComboBox };
+    struct Field {
+        Kind kind;
+        QWidget *widget;
+    };
+
+    int add(Kind kind, QWidget *widget);
+    void setValue(const Field &field, const QString &text);
+    void notify(int field);
+
+    QWidget *m_form;
+    QList<Field> m_fields;
+    bool m_loading = false;
+};
+
+// 按记录类型包装 FormBinding：控件与 T 的 QString 成员一一对应。
+// 切换记录只是换一个 RecordPtr（不拷贝记录）；与正在显示的是同一个、且没有被编辑过的记录时什么都不做。
+// 用户编辑时回调收到字段和新内容，由调用方写回 DataStore。
+template <typename T>
+class RecordBinding
+{
+public:
+    using Field = QString T::*;
+
+    RecordBinding() = default;
+    Q_DISABLE_COPY(RecordBinding)
+
+    // 必须在绑定控件之前调用一次
+    void setForm(QWidget *form)
+    {
+        m_binding = new FormBinding(form);
+    }
+
+    template <typename Widget>
+    void bind(Widget *widget, Field field)
+    {
+        m_binding->addField(widget);
+        m_fields.append(field);
+    }
+
+    void onEdited(std::function<void(Field field, const QString &text)> commit)
+    {
+        QObject::connect(m_binding, &FormBinding::edited, m_binding, [this, commit](int index, const QString &text) {
+            if (!m_record) return;
+            // 控件里已经是修改后的内容，不再与 m_record 一致
+            m_edited = true;
+            commit(m_fields[index], text);
+        });
+    }
+
+    void setRecord(const RecordPtr<T> &record)
+    {
+        if (!record) {
+            clear();
+            return;
+        }
+        if (record == m_record && !m_edited) return;
+        m_record = record;
+        m_edited = false;
+        QStringList values;
+        values.reserve(m_fields.size());
+        for (Field field : std::as_const(m_fields)) values.append((*record).*field);
+        m_binding->load(values);
+    }
+
+    void clear()
+    {
+        m_record.reset();
+        m_edited = false;
+        m_binding->clear();
+    }
+
+    const RecordPtr<T> &record() const { return m_record; }
+
+private:
+    FormBinding *m_binding = nullptr; // 父对象是表单容器
+    QList<Field> m_fields;
+    RecordPtr<T> m_record;
+    bool m_edited = false;
+};
+
+#endif // FORMBINDING_H
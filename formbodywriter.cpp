@@ -0,0 +1,229 @@
+// formbodywriter.cpp
+#include "formbodywriter.h"
+
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QLocale>
+
+namespace {
+
+const char kHex[] = "0123456789ABCDEF";
+
+// RFC 3986 非保留字符：A-Z a-z 0-9 - . _ ~
+bool isUnreserved(uchar c)
+{
+    return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z') || (c >= '0' && c <= '9')
+           || c == '-' || c == '.' || c == '_' || c == '~';
+}
+
+} // namespace
+
+FormBodyWriter::FormBodyWriter(qsizetype reserve)
+{
+    if (reserve > 0) m_body.reserve(reserve);
+}
+
+void FormBodyWriter::put(uchar byte)
+{
+    if (isUnreserved(byte)) {
+        m_body.append(char(byte));
+    } else {
+        const char encoded[3] = {'%', kHex[byte >> 4], kHex[byte & 0xF]};
+        m_body.append(encoded, 3);
+    }
+}
+
+void FormBodyWriter::putAscii(const char *text)
+{
+    for (; *text; ++text) put(uchar(*text));
+}
+
+// 把 UTF-16 直接转换成 UTF-8 字节并编码，不生成中间的 QByteArray；孤立的代理项按 QString::toUtf8() 的方式替换为 U+FFFD
+void FormBodyWriter::putUtf8(QStringView string)
+{
+    const QChar *p = string.data();
+    const QChar *end = p + string.size();
+    while (p < end) {
+        char32_t u = p->unicode();
+        ++p;
+        if (QChar::isHighSurrogate(u) && p < end && p->isLowSurrogate()) {
+            u = QChar::surrogateToUcs4(char16_t(u), p->unicode());
+            ++p;
+        } else if (QChar::isSurrogate(u)) {
+            u = 0xFFFD;
+        }
+
+        if (u < 0x80) {
+            put(uchar(u));
+        } else if (u < 0x800) {
+            put(uchar(0xC0 | (u >> 6)));
+            put(uchar(0x80 | (u & 0x3F)));
+        } else if (u < 0x10000) {
+            put(uchar(0xE0 | (u >> 12)));
+            put(uchar(0x80 | ((u >> 6) & 0x3F)));
+            put(uchar(0x80 | (u & 0x3F)));
+        } else {
+            put(uchar(0xF0 | (u >> 18)));
+            put(uchar(0x80 | ((u >> 12) & 0x3F)));
+            put(uchar(0x80 | ((u >> 6) & 0x3F)));
+            put(uchar(0x80 | (u & 0x3F)));
+        }
+    }
+}
+
+// JSON 字符串，转义规则与 QJsonDocument 相同
+void FormBodyWriter::putString(const QString &string)
+{
+    put('"');
+    qsizetype runStart = 0;
+    const qsizetype length = string.size();
+    for (qsizetype i = 0; i < length; ++i) {
+        const char16_t c = string.at(i).unicode();
+        if (c >= 0x20 && c != '"' && c != '\\') continue;
+
+        // 不需要转义的一段整体写出
+        if (i > runStart) putUtf8(QStringView(string).mid(runStart, i - runStart));
+        runStart = i + 1;
+        put('\\');
+        switch (c) {
+        case '"':  put('"'); break;
+        case '\\': put('\\'); break;
+        case '\b': put('b'); break;
+        case '\f': put('f'); break;
+        case '\n': put('n'); break;
+        case '\r': put('r'); break;
+        case '\t': put('t'); break;
+        default: {
+            const char escaped[] = {'u', '0', '0', "0123456789abcdef"[c >> 4], "0123456789abcdef"[c & 0xF], 0};
+            putAscii(escaped);
+            break;
+        }
+        }
+    }
+    if (runStart < length) putUtf8(QStringView(string).mid(runStart));
+    put('"');
+}
+
+void FormBodyWriter::separator()
+{
+    if (m_afterKey) {
+        m_afterKey = false;
+        return;
+    }
+    if (m_first.isEmpty()) return;
+    if (m_first.last()) m_first.last() = false;
+    else put(',');
+}
+
+void FormBodyWriter::addField(const char *name, const QString &value)
+{
+    if (!m_body.isEmpty()) m_body.append('&');
+    m_body.append(name);
+    m_body.append('=');
+    putUtf8(value);
+}
+
+void FormBodyWriter::beginJsonField(const char *name)
+{
+    if (!m_body.isEmpty()) m_body.append('&');
+    m_body.append(name);
+    m_body.append('=');
+    m_first.clear();
+    m_afterKey = false;
+}
+
+void FormBodyWriter::beginArray()
+{
+    separator();
+    put('[');
+    m_first.append(true);
+}
+
+void FormBodyWriter::endArray()
+{
+    m_first.removeLast();
+    put(']');
+}
+
+void FormBodyWriter::beginObject()
+{
+    separator();
+    put('{');
+    m_first.append(true);
+}
+
+void FormBodyWriter::endObject()
+{
+    m_first.removeLast();
+    put('}');
+}
+
+void FormBodyWriter::key(const char *key)
+{
+    separator();
+    put('"');
+    putAscii(key);
+    put('"');
+    put(':');
+    m_afterKey = true;
+}
+
+void FormBodyWriter::value(const QString &string)
+{
+    separator();
+    putString(string);
+}
+
+void FormBodyWriter::value(const QStringList &strings)
+{
+    beginArray();
+    for (const QString &s : strings) value(s);
+    endArray();
+}
+
+void FormBodyWriter::value(const QJsonValue &json)
+{
+    switch (json.type()) {
+    case QJsonValue::Bool:
+        separator();
+        putAscii(json.toBool() ? "true" : "false");
+        break;
+    case QJsonValue::Double: {
+        separator();
+        // 与 QJsonDocument 一致：能精确表示的整数按整数写，其余取最短的往返表示
+        const double d = json.toDouble();
+        const qint64 i = json.toInteger();
+        const QByteArray number = (double(i) == d)
+                                      ? QByteArray::number(i)
+                                      : QByteArray::number(d, 'g', QLocale::FloatingPointShortest);
+        putAscii(number.constData());
+        break;
+    }
+    case QJsonValue::String:
+        value(json.toString());
+        break;
+    case QJsonValue::Array:
+        beginArray();
+        for (const QJsonValue &v : json.toArray()) value(v);
+        endArray();
+        break;
+    case QJsonValue::Object: {
+        beginObject();
+        const QJsonObject obj = json.toObject();
+        for (auto it = obj.constBegin(); it != obj.constEnd(); ++it) {
+            // 键可能含非 ASCII 字符，不能走 key()
+            separator();
+            putString(it.key());
+            put(':');
+            m_afterKey = true;
+            value(it.value());
+        }
+        endObject();
+        break;
+    }
+    default:
+        separator();
+        putAscii("null");
+        break;
+    }
+}
@@ -0,0 +1,51 @@
+// formbodywriter.h
+#ifndef FORMBODYWRITER_H
+#define FORMBODYWRITER_H
+
+#include <QByteArray>
+#include <QJsonValue>
+#include <QString>
+#include <QStringList>
+#include <QVarLengthArray>
+
+// --- 单遍写出 application/x-www-form-urlencoded 请求体 ---
+// 整表保存原来要经过 QJsonArray → toJson → QString → QUrlQuery → 百分号编码 → toUtf8，
+// 数据被完整复制四次以上。这里把字段值（包括其中的 JSON）直接转义、编码后追加到同一块缓冲区，
+// 每个字符只处理一次，得到的请求体可以原样交给 QNetworkAccessManager::post()。
+// JSON 部分与 QJsonDocument::Compact 的输出逐字节一致（对象的键需由调用方按字母顺序写出）；
+// 百分号编码只保留 RFC 3986 的非保留字符，因此 '+' 等字符也会被编码，服务器解码后与原来相同。
+class FormBodyWriter
+{
+public:
+    explicit FormBodyWriter(qsizetype reserve = 0);
+
+    // 普通字段：name=value
+    void addField(const char *name, const QString &value);
+
+    // JSON 字段：在 beginJsonField() 之后写出恰好一个完整的 JSON 值
+    void beginJsonField(const char *name);
+    void beginArray();
+    void endArray();
+    void beginObject();
+    void endObject();
+    void key(const char *key); // 只能是 ASCII 字面量
+    void value(const QString &string);
+    void value(const QStringList &strings);
+    void value(const QJsonValue &json);
+
+    qsizetype size() const { return m_body.size(); }
+    QByteArray take() { return std::move(m_body); }
+
+private:
+    void separator();        // 数组、对象中第二个及以后的元素前写逗号
+    void put(uchar byte);    // 写一个字节的编码结果
+    void putAscii(const char *text);
+    void putString(const QString &string);
+    void putUtf8(QStringView string);
+
+    QByteArray m_body;
+    QVarLengthArray<bool, 8> m_first; // 每一层容器是否还没有元素
+    bool m_afterKey = false;
+};
+
+#endif // FORMBODYWRITER_H
@@ -0,0 +1,14 @@
+// hrapplication.cpp
+#include "hrapplication.h"
+#include "stallwatchdog.h"
+
+HRApplication::HRApplication(int &argc, char **argv)
+    : QApplication(argc, argv)
+{
+}
+
+bool HRApplication::notify(QObject *receiver, QEvent *event)
+{
+    StallWatchdog::EventScope scope(receiver, event);
+    return QApplication::notify(receiver, event);
+}
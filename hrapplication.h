@@ -0,0 +1,18 @@
+// hrapplication.h
+#ifndef HRAPPLICATION_H
+#define HRAPPLICATION_H
+
+#include <QApplication>
+
+// 应用程序对象：在每一次事件分发外面包一层计时，供 StallWatchdog 归因卡顿
+class HRApplication : public QApplication
+{
+    Q_OBJECT
+
+public:
+    HRApplication(int &argc, char **argv);
+
+    bool notify(QObject *receiver, QEvent *event) override;
+};
+
+#endif // HRAPPLICATION_H
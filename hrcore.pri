@@ -0,0 +1,75 @@
+# hrcore.pri
+# 不依赖界面的核心模块：站点登记、网络会话、数据快照、序列化、离线队列、批量请求、导入、退出协调。
+# 图形界面（HRWindow.pro）和命令行工具（hrwindow-cli.pro）都包含这份文件；
+# 这里的代码只能使用 core / network / concurrent，不能引入 gui 或 widgets，
+# 命令行工具的构建会检查这一点。
+
+QT += core network concurrent
+CONFIG += c++17
+
+INCLUDEPATH += $$PWD
+DEPENDPATH += $$PWD
+
+# qmake CONFIG+=simdjson：编译 simdjson 解析后端（需要系统中已安装 simdjson），见 jsonbackend.h
+simdjson {
+    DEFINES += HRWINDOW_SIMDJSON
+    LIBS += -lsimdjson
+}
+
+SOURCES += \
+    $$PWD/batchclient.cpp \
+    $$PWD/bulkedit.cpp \
+    $$PWD/bulkimporter.cpp \
+    $$PWD/catalogclient.cpp \
+    $$PWD/categoryindex.cpp \
+    $$PWD/dataserializer.cpp \
+    $$PWD/datastore.cpp \
+    $$PWD/formbodywriter.cpp \
+    $$PWD/imagededupe.cpp \
+    $$PWD/jsonbackend.cpp \
+    $$PWD/linkchecker.cpp \
+    $$PWD/lttb.cpp \
+    $$PWD/metricshistory.cpp \
+    $$PWD/multisitesync.cpp \
+    $$PWD/mutationqueue.cpp \
+    $$PWD/networksession.cpp \
+    $$PWD/networkthread.cpp \
+    $$PWD/recordlocks.cpp \
+    $$PWD/recordmerge.cpp \
+    $$PWD/revisionhistory.cpp \
+    $$PWD/shutdowncoordinator.cpp \
+    $$PWD/siteregistry.cpp \
+    $$PWD/stallwatchdog.cpp \
+    $$PWD/startuptrace.cpp \
+    $$PWD/syncbootstrap.cpp \
+    $$PWD/tracelog.cpp
+
+HEADERS += \
+    $$PWD/batchclient.h \
+    $$PWD/bulkedit.h \
+    $$PWD/bulkimporter.h \
+    $$PWD/catalogclient.h \
+    $$PWD/categoryindex.h \
+    $$PWD/dataserializer.h \
+    $$PWD/datastore.h \
+    $$PWD/datastructures.h \
+    $$PWD/formbodywriter.h \
+    $$PWD/imagededupe.h \
+    $$PWD/jsonbackend.h \
+    $$PWD/linkchecker.h \
+    $$PWD/lockfreequeue.h \
+    $$PWD/lttb.h \
+    $$PWD/metricshistory.h \
+    $$PWD/multisitesync.h \
+    $$PWD/mutationqueue.h \
+    $$PWD/networksession.h \
+    $$PWD/networkthread.h \
+    $$PWD/recordlocks.h \
+    $$PWD/recordmerge.h \
+    $$PWD/revisionhistory.h \
+    $$PWD/shutdowncoordinator.h \
+    $$PWD/siteregistry.h \
+    $$PWD/stallwatchdog.h \
+    $$PWD/startuptrace.h \
+    $$PWD/syncbootstrap.h \
+    $$PWD/tracelog.h
@@ -0,0 +1,18 @@
+# 无界面的命令行工具。与 HRWindow.pro 放在同一目录，请使用单独的构建目录：
+#   mkdir build-cli && cd build-cli && qmake ../hrwindow-cli.pro && make
+QT = core network concurrent
+
+CONFIG += c++17 console
+CONFIG -= app_bundle
+
+TARGET = hrwindow-cli
+
+include(hrcore.pri)
+
+SOURCES += \
+    hrwindowcli.cpp
+
+# Default rules for deployment.
+qnx: target.path = /tmp/$${TARGET}/bin
+else: unix:!android: target.path = /opt/$${TARGET}/bin
+!isEmpty(target.path): INSTALLS += target
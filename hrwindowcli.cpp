@@ -0,0 +1,270 @@
+// hrwindowcli.cpp
+// 无界面的命令行工具，用于脚本化的同步、导出、批量保存和批量上传（例如夜间定时更新产品目录）。
+// 只依赖核心模块（hrcore.pri），不需要显示器。
+//
+//   hrwindow-cli sync
+//   hrwindow-cli export <输出文件.json>
+//   hrwindow-cli import <jobs|products> <文件.csv|.jsonl> [--images <图片目录>]
+//   hrwindow-cli upload <product|case> <图片文件...>
+//   hrwindow-cli bench-json <get_all_data 响应.json> [--rounds <次数>]
+//
+// bench-json 在本地对比各 JSON 解析后端（见 jsonbackend.h）的速度并核对结果，不需要登录。
+// 其余命令的密码通过 --password 或环境变量 HRWINDOW_PASSWORD 提供。
+// --trace <文件.json> 在退出时导出本次运行的时间线（Chrome trace-event 格式，可用 Perfetto 打开）。
+#include "catalogclient.h"
+#include "bulkimporter.h"
+#include "dataserializer.h"
+#include "datastore.h"
+#include "jsonbackend.h"
+#include "shutdowncoordinator.h"
+#include "startuptrace.h"
+#include "tracelog.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QTextStream>
+
+namespace {
+
+QTextStream &out()
+{
+    static QTextStream stream(stdout);
+    return stream;
+}
+
+QTextStream &err()
+{
+    static QTextStream stream(stderr);
+    return stream;
+}
+
+bool writeExport(const QString &filePath, const SnapshotPtr &snapshot)
+{
+    QJsonObject root;
+    root["version"] = QString::number(snapshot->version);
+    root["jobs"] = DataSerializer::toJsonArray(snapshot->jobValues());
+    root["products"] = DataSerializer::toJsonArray(snapshot->productValues());
+
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) return false;
+    file.write(QJsonDocument(root).toJson(QJsonDocument::Indented));
+    return true;
+}
+
+bool sameData(const SyncData &a, const SyncData &b)
+{
+    if (a.hasJobs != b.hasJobs || a.hasProducts != b.hasProducts || a.hasStats != b.hasStats) return false;
+    if (a.jobs.size() != b.jobs.size() || a.products.size() != b.products.size()) return false;
+    for (qsizetype i = 0; i < a.jobs.size(); ++i) {
+        const Job &x = a.jobs[i], &y = b.jobs[i];
+        if (x.title != y.title || x.quota != y.quota || x.salaryStart != y.salaryStart
+            || x.salaryEnd != y.salaryEnd || x.requirements != y.requirements) return false;
+    }
+    for (qsizetype i = 0; i < a.products.size(); ++i) {
+        const Product &x = a.products[i], &y = b.products[i];
+        if (x.name != y.name || x.category != y.category || x.description != y.description
+            || x.imageUrls != y.imageUrls) return false;
+    }
+    const DashboardStats &x = a.stats, &y = b.stats;
+    return x.totalJobsCount == y.totalJobsCount && x.totalProductsCount == y.totalProductsCount
+           && x.totalCasesCount == y.totalCasesCount && x.totalRecruitmentQuota == y.totalRecruitmentQuota
+           && x.serverTime == y.serverTime;
+}
+
+// 每个可用的后端先解析一次预热，再计时解析 rounds 次；结果与 qt 后端逐字段核对
+int benchJson(const QString &filePath, int rounds)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) {
+        err() << "无法读取 " << filePath << ": " << file.errorString() << Qt::endl;
+        return 1;
+    }
+    const QByteArray body = file.readAll();
+    out() << "file\t" << filePath << " (" << body.size() << " bytes)\nactive\t" << JsonBackend::active().name() << Qt::endl;
+    out() << "backend\tMB/s\tms/parse\tjobs\tproducts\tmatches qt" << Qt::endl;
+
+    int exitCode = 0;
+    SyncResponse reference;
+    bool haveReference = false;
+    for (const JsonBackend *backend : JsonBackend::available()) {
+        const SyncResponse first = backend->parse(body);
+        if (!first.isValid()) {
+            err() << backend->name() << ": " << first.parseError << Qt::endl;
+            exitCode = 1;
+            continue;
+        }
+        if (!haveReference) {
+            reference = first; // available() 总是先给出 qt
+            haveReference = true;
+        }
+        const bool matches = first.status == reference.status && first.hasData == reference.hasData
+                             && sameData(first.data, reference.data);
+        if (!matches) exitCode = 1;
+
+        QElapsedTimer timer;
+        timer.start();
+        for (int i = 0; i < rounds; ++i) backend->parse(body);
+        const double seconds = qMax<qint64>(1, timer.nsecsElapsed()) / 1e9;
+        out() << backend->name() << '\t' << QString::number(double(body.size()) * rounds / seconds / 1e6, 'f', 1)
+              << '\t' << QString::number(seconds * 1000 / rounds, 'f', 3)
+              << '\t' << first.data.jobs.size() << '\t' << first.data.products.size()
+              << '\t' << (matches ? "yes" : "NO") << Qt::endl;
+    }
+    return exitCode;
+}
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    StartupTrace::begin();
+    QCoreApplication app(argc, argv);
+    // 与图形界面共用本地配置（TLS 会话票据等）
+    app.setOrganizationName("tianyuhuanbao");
+    app.setApplicationName("HRWindow");
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("网站内容管理系统命令行工具");
+    parser.addHelpOption();
+    parser.addPositionalArgument("command", "sync | export | import | upload | bench-json");
+    QCommandLineOption passwordOption("password", "登录密码（默认读取环境变量 HRWINDOW_PASSWORD）", "password");
+    QCommandLineOption imagesOption("images", "import products 时本地图片所在目录", "dir");
+    QCommandLineOption traceOption("trace", "退出时把时间线导出到指定文件", "file");
+    QCommandLineOption roundsOption("rounds", "bench-json 每个后端的解析次数（默认 20）", "n", "20");
+    parser.addOption(passwordOption);
+    parser.addOption(imagesOption);
+    parser.addOption(traceOption);
+    parser.addOption(roundsOption);
+    parser.process(app);
+
+    const QStringList args = parser.positionalArguments();
+    const QString command = args.value(0);
+    if (command == "bench-json") {
+        if (args.size() < 2) parser.showHelp(1);
+        return benchJson(args.value(1), qMax(1, parser.value(roundsOption).toInt()));
+    }
+    const QString password = parser.isSet(passwordOption) ? parser.value(passwordOption)
+                                                          : qEnvironmentVariable("HRWINDOW_PASSWORD");
+    if (command.isEmpty()) parser.showHelp(1);
+    if (password.isEmpty()) {
+        err() << "缺少密码：请使用 --password 或设置 HRWINDOW_PASSWORD" << Qt::endl;
+        return 1;
+    }
+
+    // 导入文件先在本地完整校验，有问题时不必登录服务器
+    BulkImporter::Result imported;
+    const bool importProducts = (args.value(1) == "products");
+    if (command == "import") {
+        if (args.size() < 3 || (args.value(1) != "jobs" && !importProducts)) parser.showHelp(1);
+        BulkImporter::Options options;
+        options.kind = importProducts ? BulkImporter::Kind::Products : BulkImporter::Kind::Jobs;
+        options.filePath = args.value(2);
+        options.imageFolder = parser.value(imagesOption);
+        imported = BulkImporter::run(options);
+        if (!imported.fatalError.isEmpty()) {
+            err() << imported.fatalError << Qt::endl;
+            return 1;
+        }
+        err() << imported.summary() << Qt::endl;
+        if (imported.validCount() == 0) return 1;
+    } else if (command == "export") {
+        if (args.size() < 2) parser.showHelp(1);
+    } else if (command == "upload") {
+        if (args.size() < 3) parser.showHelp(1);
+    } else if (command != "sync") {
+        parser.showHelp(1);
+    }
+
+    CatalogClient client;
+    int exitCode = 0;
+
+    // 结束时通过 ShutdownCoordinator 发送 logout，释放服务器上的登录锁
+    auto finish = [&](int code) {
+        exitCode = code;
+        if (client.sessionKey().isEmpty()) QCoreApplication::exit(code);
+        else ShutdownCoordinator::instance()->shutdown(client.sessionKey());
+    };
+
+    QObject::connect(&client, &CatalogClient::failed, &app,
+                     [&](const QString &action, const QString &message, bool connectivity) {
+        err() << action << " 失败: " << message << (connectivity ? "（无法连接服务器）" : "") << Qt::endl;
+        finish(connectivity ? 3 : 2);
+    });
+    QObject::connect(&client, &CatalogClient::imageUploadFailed, &app,
+                     [](const QString &filePath, const QString &message) {
+        err() << filePath << ": " << message << Qt::endl;
+    });
+    QObject::connect(&client, &CatalogClient::saved, &app, [&](const QString &action, const QString &message) {
+        err() << action << ": " << (message.isEmpty() ? QString("已保存") : message) << Qt::endl;
+        finish(0);
+    });
+
+    QObject::connect(&client, &CatalogClient::loggedIn, &app, [&]() {
+        if (command == "upload") client.uploadImages(args.value(1), args.mid(2));
+        else client.fetchAll();
+    });
+
+    QObject::connect(&client, &CatalogClient::synced, &app, [&](SnapshotPtr snapshot) {
+        if (command == "sync") {
+            out() << "jobs\t" << snapshot->jobs.size() << "\nproducts\t" << snapshot->products.size() << Qt::endl;
+            finish(0);
+        } else if (command == "export") {
+            if (!writeExport(args.value(1), snapshot)) {
+                err() << "无法写入 " << args.value(1) << Qt::endl;
+                finish(1);
+                return;
+            }
+            err() << "已导出 " << snapshot->jobs.size() << " 个职位、" << snapshot->products.size() << " 个产品" << Qt::endl;
+            finish(0);
+        } else if (!importProducts) {
+            // 整表保存：服务器上的现有职位加上导入的职位
+            client.saveJobs(snapshot->jobValues() + imported.jobs);
+        } else {
+            QStringList paths;
+            for (const QStringList &images : std::as_const(imported.productImages)) paths += images;
+            paths.removeDuplicates();
+            client.uploadImages("product", paths);
+        }
+    });
+
+    QObject::connect(&client, &CatalogClient::imageUploaded, &app, [&](const QString &filePath, const QString &url) {
+        if (command == "upload") out() << filePath << '\t' << url << Qt::endl;
+    });
+
+    QObject::connect(&client, &CatalogClient::imagesUploaded, &app,
+                     [&](const QHash<QString, QString> &urls, const QStringList &failed) {
+        if (command == "upload") {
+            finish(failed.isEmpty() ? 0 : 4);
+            return;
+        }
+        if (!failed.isEmpty()) {
+            // 有图片没传上去时不保存，避免产品引用不存在的图片
+            err() << failed.size() << " 张图片上传失败，未保存产品" << Qt::endl;
+            finish(4);
+            return;
+        }
+        QList<Product> all = DataStore::instance()->current()->productValues();
+        for (int i = 0; i < imported.products.size(); ++i) {
+            Product p = imported.products[i];
+            p.imageUrls = BulkImporter::resolveImages(p.imageUrls, [&urls](const QString &path) {
+                return urls.value(path);
+            });
+            all.append(p);
+        }
+        client.saveProducts(all);
+    });
+
+    client.login(password);
+    app.exec();
+
+    if (parser.isSet(traceOption)) {
+        QString error;
+        if (!TraceLog::dump(parser.value(traceOption), &error))
+            err() << "无法写入时间线文件: " << error << Qt::endl;
+    }
+    return exitCode;
+}
@@ -0,0 +1,144 @@
+// imagededupe.cpp
+#include "imagededupe.h"
+#include "networksession.h"
+#include "siteregistry.h"
+#include "networkthread.h"
+
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QCryptographicHash>
+#include <QFile>
+#include <QSettings>
+#include <QUrlQuery>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QDebug>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentMap>
+#include <atomic>
+
+namespace {
+
+std::atomic<bool> g_checkSupported{true};
+
+// 同一张图片在不同站点上传得到的是各自服务器上的地址，按站点分开缓存
+QString cacheKey(const QString &hash)
+{
+    return "imageCache/" + SiteRegistry::instance()->currentSiteId() + "/" + hash;
+}
+
+} // namespace
+
+namespace ImageDedupe {
+
+QString hashFile(const QString &filePath)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::ReadOnly)) return QString();
+
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+    if (!hash.addData(&file)) return QString();
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString cachedUrl(const QString &hash)
+{
+    if (hash.isEmpty()) return QString();
+    return QSettings().value(cacheKey(hash)).toString();
+}
+
+void remember(const QString &hash, const QString &url)
+{
+    if (hash.isEmpty() || url.isEmpty()) return;
+    QSettings().setValue(cacheKey(hash), url);
+}
+
+QNetworkReply *postCheck(QNetworkAccessManager *manager, const QString &sessionKey, const QStringList &hashes)
+{
+    QNetworkRequest request = NetworkSession::apiRequest();
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.setAttribute(QNetworkRequest::User, "check_images");
+
+    QUrlQuery postData;
+    postData.addQueryItem("action", "check_images");
+    postData.addQueryItem("key", sessionKey);
+    postData.addQueryItem("hashes", QString::fromUtf8(QJsonDocument(QJsonArray::fromStringList(hashes)).toJson(QJsonDocument::Compact)));
+    return manager->post(request, postData.query(QUrl::FullyEncoded).toUtf8());
+}
+
+QHash<QString, QString> knownUrls(int httpStatus, const QJsonObject &reply)
+{
+    QHash<QString, QString> urls;
+    // 只有服务器明确不认识 check_images 时才停用之后的查询。
+    // 其它失败（断网、会话过期、服务器临时出错）只是这一次查不到，照常上传即可
+    if (NetworkSession::isUnknownAction(httpStatus, reply)) {
+        if (g_checkSupported.exchange(false))
+            qDebug() << "Server does not support check_images, uploading images without dedupe lookup";
+        return urls;
+    }
+    if (httpStatus != 200 || reply["status"].toString() != "success") {
+        qDebug() << "check_images failed:" << httpStatus << reply["message"].toString();
+        return urls;
+    }
+
+    // PHP 的 json_encode 把空数组编码成 []：一个都不认识时 urls 是空数组而不是对象
+    const QJsonObject known = reply["urls"].toObject();
+    for (auto it = known.begin(); it != known.end(); ++it) {
+        const QString url = it.value().toString();
+        if (!url.isEmpty()) urls.insert(it.key(), url);
+    }
+    return urls;
+}
+
+bool isServerCheckSupported()
+{
+    return g_checkSupported.load();
+}
+
+void lookup(const QStringList &filePaths, const QString &sessionKey, QObject *context,
+            std::function<void(const Lookup &result)> onFinished)
+{
+    if (filePaths.isEmpty()) {
+        onFinished(Lookup());
+        return;
+    }
+
+    auto *watcher = new QFutureWatcher<QString>(context);
+    QObject::connect(watcher, &QFutureWatcher<QString>::finished, context,
+                     [watcher, filePaths, sessionKey, context, onFinished]() {
+        watcher->deleteLater();
+        const QStringList hashes = watcher->future().results();
+
+        Lookup result;
+        QStringList missing;
+        for (int i = 0; i < filePaths.size(); ++i) {
+            const QString hash = hashes.value(i);
+            if (hash.isEmpty()) continue;
+            result.hashes.insert(filePaths[i], hash);
+            const QString cached = cachedUrl(hash);
+            if (!cached.isEmpty()) result.urls.insert(filePaths[i], cached);
+            else if (!missing.contains(hash)) missing.append(hash);
+        }
+        if (missing.isEmpty() || sessionKey.isEmpty() || !isServerCheckSupported()) {
+            onFinished(result);
+            return;
+        }
+
+        NetworkThread::instance()->submit("check_images",
+            [sessionKey, missing](QNetworkAccessManager *manager) { return postCheck(manager, sessionKey, missing); },
+            context, [result, onFinished](const NetworkResult &reply) mutable {
+                result.checkError = reply.error;
+                const QHash<QString, QString> known = knownUrls(reply.httpStatus, reply.json);
+                for (auto it = result.hashes.cbegin(); it != result.hashes.cend(); ++it) {
+                    const QString url = known.value(it.value());
+                    if (url.isEmpty() || result.urls.contains(it.key())) continue;
+                    remember(it.value(), url);
+                    result.urls.insert(it.key(), url);
+                }
+                onFinished(result);
+            });
+    });
+    watcher->setFuture(QtConcurrent::mapped(filePaths, &hashFile));
+}
+
+} // namespace ImageDedupe
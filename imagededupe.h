@@ -0,0 +1,56 @@
+// imagededupe.h
+#ifndef IMAGEDEDUPE_H
+#define IMAGEDEDUPE_H
+
+#include <QString>
+#include <QStringList>
+#include <QHash>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <functional>
+
+class QNetworkAccessManager;
+class QObject;
+
+// --- 按内容去重的图片上传 ---
+// 同一张照片经常被多个产品型号复用。上传前先计算文件内容的 SHA-256：
+//   1. 本地缓存（QSettings 中的 imageCache/<站点 id>/<哈希>）里已有地址的，直接复用
+//   2. 否则用 check_images 询问服务器，服务器已有的同样直接复用
+//   3. 都没有才真正上传，上传时附带哈希，成功后写入本地缓存
+//
+// check_images 请求格式：action=check_images, key, hashes=["<sha256>", ...]
+// 响应格式：{"status":"success","urls":{"<sha256>":"https://...", ...}}（只列出服务器已有的）
+namespace ImageDedupe {
+
+// 文件内容的 SHA-256（十六进制小写）；文件读不了时返回空字符串。
+// 流式读取，可以在任意线程调用
+QString hashFile(const QString &filePath);
+
+QString cachedUrl(const QString &hash);
+void remember(const QString &hash, const QString &url);
+
+// 发送 check_images；请求的 User 属性为 "check_images"
+QNetworkReply *postCheck(QNetworkAccessManager *manager, const QString &sessionKey, const QStringList &hashes);
+
+// 从 check_images 的响应中取出服务器已有的 哈希 -> 地址；
+// 服务器明确不认识 check_images 时自动停用之后的查询，其它错误只当作这一次没有查到
+QHash<QString, QString> knownUrls(int httpStatus, const QJsonObject &reply);
+
+bool isServerCheckSupported();
+
+// 一批本地图片的查找结果
+struct Lookup {
+    QHash<QString, QString> hashes; // 本地路径 -> 内容哈希（读不了的文件没有）
+    QHash<QString, QString> urls;   // 本地路径 -> 本地缓存或服务器已有的地址
+    QNetworkReply::NetworkError checkError = QNetworkReply::NoError; // check_images 的网络错误
+};
+
+// 上传前的完整查找：在工作线程中计算哈希，先查本地缓存，剩下的用一次 check_images
+// （经由 NetworkThread）询问服务器，服务器已有的写入本地缓存。完成后在界面线程回调；
+// context 被销毁后不再回调（filePaths 为空时立即回调）。sessionKey 为空时只查本地缓存
+void lookup(const QStringList &filePaths, const QString &sessionKey, QObject *context,
+            std::function<void(const Lookup &result)> onFinished);
+
+} // namespace ImageDedupe
+
+#endif // IMAGEDEDUPE_H
@@ -0,0 +1,290 @@
+// imagegallery.cpp
+#include "imagegallery.h"
+#include "imagepreview.h"
+#include "networkthread.h"
+#include "mutationqueue.h"
+
+#include <QDropEvent>
+#include <QFileInfo>
+#include <QFutureWatcher>
+#include <QHash>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QUrl>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
+
+namespace {
+// 缩略图缓存的上限（张），足够覆盖几屏内容
+const int kThumbnailCacheSize = 300;
+} // namespace
+
+GalleryModel::GalleryModel(QObject *parent)
+    : QAbstractListModel(parent)
+{
+    m_thumbnails.setMaxCost(kThumbnailCacheSize);
+}
+
+void GalleryModel::setUrls(const QStringList &urls)
+{
+    beginResetModel();
+    m_items.clear();
+    for (const QString &url : urls) {
+        GalleryItem item;
+        item.id = m_nextId++;
+        item.url = url;
+        m_items.append(item);
+    }
+    endResetModel();
+    emit itemsChanged();
+}
+
+void GalleryModel::addLocalFiles(const QStringList &paths)
+{
+    if (paths.isEmpty()) return;
+    beginInsertRows(QModelIndex(), m_items.size(), m_items.size() + paths.size() - 1);
+    for (const QString &path : paths) {
+        GalleryItem item;
+        item.id = m_nextId++;
+        item.localPath = path;
+        m_items.append(item);
+    }
+    endInsertRows();
+    emit itemsChanged();
+}
+
+void GalleryModel::removeItems(QList<int> rows)
+{
+    if (rows.isEmpty()) return;
+    // 从后往前删，前面的行号不受影响
+    std::sort(rows.begin(), rows.end(), std::greater<int>());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    for (int row : std::as_const(rows)) {
+        if (row < 0 || row >= m_items.size()) continue;
+        beginRemoveRows(QModelIndex(), row, row);
+        m_items.removeAt(row);
+        endRemoveRows();
+    }
+    emit itemsChanged();
+}
+
+void GalleryModel::moveItems(QList<int> rows, int destination)
+{
+    std::sort(rows.begin(), rows.end());
+    rows.erase(std::unique(rows.begin(), rows.end()), rows.end());
+    if (rows.isEmpty()) return;
+
+    // 取出被拖动的图片，剩余图片中落点之前的数量就是插入位置
+    QList<GalleryItem> moving;
+    QList<GalleryItem> rest;
+    int insertAt = 0;
+    for (int row = 0; row < m_items.size(); ++row) {
+        if (std::binary_search(rows.cbegin(), rows.cend(), row)) {
+            moving.append(m_items[row]);
+        } else {
+            if (row < destination) ++insertAt;
+            rest.append(m_items[row]);
+        }
+    }
+    for (int i = 0; i < moving.size(); ++i)
+        rest.insert(insertAt + i, moving[i]);
+
+    bool changed = false;
+    for (int i = 0; i < rest.size() && !changed; ++i)
+        changed = rest[i].id != m_items[i].id;
+    if (!changed) return;
+
+    // 多选拖动可能打乱任意多行，用布局变化通知视图即可，缩略图缓存按键保留。
+    // 选择和当前项是持久索引，要随图片一起换到新行，否则之后“移除所选”会删错图片
+    emit layoutAboutToBeChanged();
+    QHash<int, int> newRow; // 图片 id -> 新行号
+    for (int i = 0; i < rest.size(); ++i) newRow.insert(rest[i].id, i);
+    const QModelIndexList from = persistentIndexList();
+    QModelIndexList to;
+    to.reserve(from.size());
+    for (const QModelIndex &old : from)
+        to.append(index(newRow.value(m_items[old.row()].id, old.row()), old.column()));
+    m_items = rest;
+    changePersistentIndexList(from, to);
+    emit layoutChanged();
+    emit itemsChanged();
+}
+
+void GalleryModel::setUploaded(int id, const QString &url)
+{
+    for (int row = 0; row < m_items.size(); ++row) {
+        GalleryItem &item = m_items[row];
+        if (item.id != id) continue;
+        // 已经解码好的本地缩略图直接沿用到新地址上，不必重新下载
+        if (QPixmap *cached = m_thumbnails.object(item.localPath))
+            m_thumbnails.insert(url, new QPixmap(*cached));
+        item.url = url;
+        item.localPath.clear();
+        emit dataChanged(index(row), index(row));
+        emit itemsChanged();
+        return;
+    }
+}
+
+QList<GalleryItem> GalleryModel::pendingItems() const
+{
+    QList<GalleryItem> pending;
+    for (const GalleryItem &item : m_items) {
+        if (item.isPending()) pending.append(item);
+    }
+    return pending;
+}
+
+QStringList GalleryModel::urls() const
+{
+    QStringList urls;
+    for (const GalleryItem &item : m_items) {
+        if (!item.isPending()) urls.append(item.url);
+    }
+    return urls;
+}
+
+int GalleryModel::rowCount(const QModelIndex &parent) const
+{
+    return parent.isValid() ? 0 : m_items.size();
+}
+
+QString GalleryModel::thumbnailKey(const GalleryItem &item)
+{
+    return item.isPending() ? item.localPath : item.url;
+}
+
+QVariant GalleryModel::data(const QModelIndex &index, int role) const
+{
+    if (!index.isValid() || index.row() >= m_items.size()) return QVariant();
+    const GalleryItem &item = m_items[index.row()];
+    const QString key = thumbnailKey(item);
+
+    switch (role) {
+    case Qt::DisplayRole:
+        if (item.isPending()) return "（新）" + QFileInfo(item.localPath).fileName();
+        if (MutationQueue::isPlaceholder(item.url)) return QString("等待上传");
+        if (m_failed.contains(key)) return QString("无法预览");
+        return QString("%1").arg(index.row() + 1);
+    case Qt::ToolTipRole:
+        return item.isPending() ? item.localPath : item.url;
+    case Qt::DecorationRole:
+        // 视图只会为可见的格子请求图标，缩略图的解码因此是按需进行的
+        if (QPixmap *cached = m_thumbnails.object(key)) return *cached;
+        requestThumbnail(key);
+        return QVariant();
+    default:
+        return QVariant();
+    }
+}
+
+Qt::ItemFlags GalleryModel::flags(const QModelIndex &index) const
+{
+    // 根节点可以接受放下（落在格子之间），格子本身只能被拖动
+    if (!index.isValid()) return Qt::ItemIsDropEnabled;
+    return Qt::ItemIsEnabled | Qt::ItemIsSelectable | Qt::ItemIsDragEnabled;
+}
+
+Qt::DropActions GalleryModel::supportedDragActions() const
+{
+    return Qt::MoveAction;
+}
+
+Qt::DropActions GalleryModel::supportedDropActions() const
+{
+    return Qt::MoveAction;
+}
+
+void GalleryModel::requestThumbnail(const QString &key) const
+{
+    if (key.isEmpty() || m_loading.contains(key) || m_failed.contains(key) || MutationQueue::isPlaceholder(key))
+        return;
+    m_loading.insert(key);
+
+    // data() 是 const，但加载完成后需要更新缓存并通知视图
+    auto *self = const_cast<GalleryModel *>(this);
+    const QSize bounds = m_thumbnailSize;
+
+    auto decodeInPool = [self, key](QFuture<QImage> future) {
+        auto *watcher = new QFutureWatcher<QImage>(self);
+        connect(watcher, &QFutureWatcher<QImage>::finished, self, [self, watcher, key]() {
+            watcher->deleteLater();
+            self->onThumbnailReady(key, watcher->result());
+        });
+        watcher->setFuture(future);
+    };
+
+    const QUrl url(key);
+    if (url.scheme() == "http" || url.scheme() == "https") {
+        NetworkThread::instance()->submit("thumbnail",
+            [url](QNetworkAccessManager *manager) { return manager->get(QNetworkRequest(url)); },
+            self, [self, key, bounds, decodeInPool](const NetworkResult &result) {
+                if (!result.ok()) {
+                    self->onThumbnailReady(key, QImage());
+                    return;
+                }
+                decodeInPool(QtConcurrent::run(&ImagePreview::decodeScaledData, result.body, bounds));
+            });
+    } else {
+        decodeInPool(QtConcurrent::run(&ImagePreview::decodeScaled, key, bounds));
+    }
+}
+
+void GalleryModel::onThumbnailReady(const QString &key, const QImage &image)
+{
+    m_loading.remove(key);
+    if (image.isNull()) m_failed.insert(key);
+    else m_thumbnails.insert(key, new QPixmap(QPixmap::fromImage(image)));
+
+    for (int row = 0; row < m_items.size(); ++row) {
+        if (thumbnailKey(m_items[row]) == key) emit dataChanged(index(row), index(row));
+    }
+}
+
+GalleryView::GalleryView(QWidget *parent)
+    : QListView(parent)
+{
+    setViewMode(QListView::IconMode);
+    setResizeMode(QListView::Adjust);
+    setWrapping(true);
+    setUniformItemSizes(true);           // 不必为了布局去询问每一格的内容
+    setLayoutMode(QListView::Batched);   // 大量图片分批布局，不阻塞界面
+    setIconSize(QSize(120, 90));
+    setGridSize(QSize(136, 120));
+    setSelectionMode(QAbstractItemView::ExtendedSelection);
+
+    // Static 会顺带关闭拖放，这里重新打开，排序由 dropEvent 交给模型完成
+    setMovement(QListView::Static);
+    setDragEnabled(true);
+    viewport()->setAcceptDrops(true);
+    setDropIndicatorShown(true);
+    setDragDropMode(QAbstractItemView::InternalMove);
+    setDefaultDropAction(Qt::MoveAction);
+}
+
+void GalleryView::dropEvent(QDropEvent *event)
+{
+    auto *gallery = qobject_cast<GalleryModel *>(model());
+    if (event->source() != this || !gallery) {
+        QListView::dropEvent(event);
+        return;
+    }
+
+    const QPoint pos = event->position().toPoint();
+    const QModelIndex target = indexAt(pos);
+    int destination = gallery->rowCount();
+    if (target.isValid()) {
+        destination = target.row();
+        // 落在格子右半边时放到它后面
+        if (pos.x() > visualRect(target).center().x()) ++destination;
+    }
+
+    QList<int> rows;
+    for (const QModelIndex &index : selectionModel()->selectedIndexes())
+        rows.append(index.row());
+    gallery->moveItems(rows, destination);
+
+    // 与 Qt 自身的内部移动一样报告为复制，避免拖动源再删除一遍被移动的格子
+    event->setDropAction(Qt::CopyAction);
+    event->accept();
+}
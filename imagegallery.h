@@ -0,0 +1,86 @@
+// imagegallery.h
+#ifndef IMAGEGALLERY_H
+#define IMAGEGALLERY_H
+
+#include <QAbstractListModel>
+#include <QListView>
+#include <QCache>
+#include <QPixmap>
+#include <QSet>
+#include <QStringList>
+
+// 图库中的一张图片：要么是已有的地址（包括离线队列的占位地址），要么是新选择、尚未上传的本地文件
+struct GalleryItem {
+    int id = 0; // 模型内唯一，重排后仍然不变，上传完成时用它找回对应的格子
+    QString url;
+    QString localPath;
+
+    bool isPending() const { return !localPath.isEmpty(); }
+};
+
+// --- 产品图库的数据模型 ---
+// 缩略图只在视图真正请求某一格的图标（即这一格可见）时才开始解码：
+// 本地文件在线程池中按缩略图尺寸直接解码，网络图片经 NetworkThread 下载后同样在线程池中解码。
+// 解码结果放在有上限的缓存里，滚出可见区域的格子不会占用额外内存。
+class GalleryModel : public QAbstractListModel
+{
+    Q_OBJECT
+
+public:
+    explicit GalleryModel(QObject *parent = nullptr);
+
+    void setThumbnailSize(const QSize &size) { m_thumbnailSize = size; }
+
+    // 换成另一个产品的图片（清空未上传的本地文件）
+    void setUrls(const QStringList &urls);
+    void addLocalFiles(const QStringList &paths);
+    void removeItems(QList<int> rows);
+    // 把 rows 中的图片按原来的相对顺序移动到 destination 之前
+    void moveItems(QList<int> rows, int destination);
+    // 本地文件上传完成（或进入离线队列），改为使用地址
+    void setUploaded(int id, const QString &url);
+
+    const QList<GalleryItem> &items() const { return m_items; }
+    QList<GalleryItem> pendingItems() const;
+    // 按当前顺序的已有地址，跳过尚未上传的本地文件
+    QStringList urls() const;
+
+    int rowCount(const QModelIndex &parent = QModelIndex()) const override;
+    QVariant data(const QModelIndex &index, int role) const override;
+    Qt::ItemFlags flags(const QModelIndex &index) const override;
+    Qt::DropActions supportedDragActions() const override;
+    Qt::DropActions supportedDropActions() const override;
+
+signals:
+    // 图片数量、顺序或内容发生变化（用于同步到产品数据和更新计数）
+    void itemsChanged();
+
+private:
+    QList<GalleryItem> m_items;
+    int m_nextId = 1;
+    QSize m_thumbnailSize = QSize(120, 90);
+
+    // 以本地路径或地址为键
+    mutable QCache<QString, QPixmap> m_thumbnails;
+    mutable QSet<QString> m_loading;
+    mutable QSet<QString> m_failed;
+
+    static QString thumbnailKey(const GalleryItem &item);
+    void requestThumbnail(const QString &key) const;
+    void onThumbnailReady(const QString &key, const QImage &image);
+};
+
+// --- 图库视图 ---
+// 网格排列、按需绘制的缩略图列表，支持多选和拖动排序
+class GalleryView : public QListView
+{
+    Q_OBJECT
+
+public:
+    explicit GalleryView(QWidget *parent = nullptr);
+
+protected:
+    void dropEvent(QDropEvent *event) override;
+};
+
+#endif // IMAGEGALLERY_H
@@ -0,0 +1,54 @@
+// imagepreview.cpp
+#include "imagepreview.h"
+#include "tracelog.h"
+
+#include <QImageReader>
+#include <QBuffer>
+#include <QDebug>
+
+namespace {
+
+QImage readScaled(QImageReader &reader, const QSize &bounds, const QString &source)
+{
+    TraceLog::Span span("image", "decode image", source);
+    reader.setAutoTransform(true); // 按 EXIF 方向摆正手机照片
+
+    // 只读取文件头就能拿到原始尺寸，不会解码像素
+    const QSize original = reader.size();
+    if (original.isValid() && !bounds.isEmpty()
+        && (original.width() > bounds.width() || original.height() > bounds.height())) {
+        reader.setScaledSize(original.scaled(bounds, Qt::KeepAspectRatio));
+    }
+
+    QImage image = reader.read();
+    if (image.isNull()) {
+        qDebug() << "Cannot decode preview for" << source << ":" << reader.errorString();
+        return image;
+    }
+
+    // 部分格式不支持解码时缩放，或 EXIF 旋转后宽高互换，这里对已经很小的图再做一次平滑缩放
+    if (!bounds.isEmpty() && (image.width() > bounds.width() || image.height() > bounds.height()))
+        image = image.scaled(bounds, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    return image;
+}
+
+} // namespace
+
+namespace ImagePreview {
+
+QImage decodeScaled(const QString &filePath, const QSize &bounds)
+{
+    QImageReader reader(filePath);
+    return readScaled(reader, bounds, filePath);
+}
+
+QImage decodeScaledData(const QByteArray &data, const QSize &bounds)
+{
+    QBuffer buffer;
+    buffer.setData(data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    return readScaled(reader, bounds, QString("%1 bytes of downloaded data").arg(data.size()));
+}
+
+} // namespace ImagePreview
@@ -0,0 +1,25 @@
+// imagepreview.h
+#ifndef IMAGEPREVIEW_H
+#define IMAGEPREVIEW_H
+
+#include <QImage>
+#include <QSize>
+#include <QString>
+#include <QByteArray>
+
+// --- 本地图片预览的缩小解码 ---
+// 直接 QPixmap(file).scaled(...) 会先把整张原图解码到内存再缩小，
+// 几千万像素的照片要解码上百MB，而且只能在GUI线程里做。
+// 这里用 QImageReader::setScaledSize 让解码器直接输出目标尺寸
+// （JPEG 可以在解码阶段按 1/2、1/4、1/8 缩小），且只使用 QImage，可以放在工作线程中调用。
+namespace ImagePreview {
+
+// 按比例缩小到 bounds 以内；文件无法读取时返回空图
+QImage decodeScaled(const QString &filePath, const QSize &bounds);
+
+// 同上，数据来自内存（例如下载下来的网络图片）
+QImage decodeScaledData(const QByteArray &data, const QSize &bounds);
+
+} // namespace ImagePreview
+
+#endif // IMAGEPREVIEW_H
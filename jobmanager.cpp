@@ -1,8 +1,20 @@
 // jobmanager.cpp (最终完整功能版)
 #include "jobmanager.h"
 #include "ui_jobmanager.h"
+#include "networksession.h"
+#include "networkthread.h"
+#include "shutdowncoordinator.h"
+#include "dataserializer.h"
+#include "mutationqueue.h"
+#include "bulkimporter.h"
+#include "stallwatchdog.h"
+#include "bulkeditpanel.h"
+#include "recordlocks.h"
+#include "recordmerge.h"
+#include "jsonbackend.h"
 
 #include <QMessageBox>
+#include <QFileDialog>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QUrl>
@@ -11,18 +23,71 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QListWidgetItem>
+#include <QTimer>
+#include <algorithm>
 
 JobManager::JobManager(const QString &sessionKey, QWidget *parent) :
     QWidget(parent),
     ui(new Ui::JobManager),
-    m_networkManager(new QNetworkAccessManager(this)),
     m_sessionKey(sessionKey)
 {
     ui->setupUi(this);
-    connect(m_networkManager, &QNetworkAccessManager::finished, this, &JobManager::onSaveReply);
     ui->groupBox->setEnabled(false);
     ui->deleteButton->setEnabled(false);
     ui->saveButton->setEnabled(false);
+    ui->fileGetButton->setToolTip("从 CSV 或 JSON Lines 文件批量导入职位");
+
+    // 表单控件与职位字段的对应关系只建立一次，切换职位时不再断开、重连信号
+    m_form.setForm(this);
+    m_form.bind(ui->titleEdit,       &Job::title);
+    m_form.bind(ui->quotaEdit,       &Job::quota);
+    m_form.bind(ui->startsalaryEdit, &Job::salaryStart);
+    m_form.bind(ui->endsalaryEdit,   &Job::salaryEnd);
+    m_form.bind(ui->requirementEdit, &Job::requirements);
+    m_form.onEdited([this](QString Job::*field, const QString &text) {
+        editCurrentJob([&](Job &j) { j.*field = text; });
+        const int idx = ui->jobListWidget->currentRow();
+        if (field == &Job::title && idx >= 0) {
+            updateLockMark(idx);
+            m_relockTimer->start();
+        }
+    });
+
+    // 编辑锁按职位名称标识：改名后等输入停下来再换锁，不必每次按键都释放、申请一次
+    m_relockTimer = new QTimer(this);
+    m_relockTimer->setSingleShot(true);
+    m_relockTimer->setInterval(800);
+    connect(m_relockTimer, &QTimer::timeout, this, &JobManager::relockRenamed);
+
+    // 列表可以多选，选中多个职位时显示批量修改面板
+    ui->jobListWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_bulkPanel = new BulkEditPanel(this);
+    m_bulkPanel->setFields(BulkEdit::fields(DataStore::Jobs));
+    m_bulkPanel->setSuggestions("quota", {"若干"});
+    m_bulkPanel->setSuggestions("salaryStart", {"面议"});
+    ui->jobListLayout->addWidget(m_bulkPanel);
+    connect(ui->jobListWidget, &QListWidget::itemSelectionChanged, this, [this]() {
+        m_bulkPanel->setSelectionCount(int(ui->jobListWidget->selectedItems().size()));
+    });
+    connect(m_bulkPanel, &BulkEditPanel::applyRequested, this, &JobManager::onBulkApply);
+    connect(m_bulkPanel, &BulkEditPanel::undoRequested, this, &JobManager::onBulkUndo);
+    connect(m_bulkPanel, &BulkEditPanel::redoRequested, this, &JobManager::onBulkRedo);
+
+    // 数据来自全局快照；标签页懒加载时，创建前已经同步到的数据直接拿来显示
+    auto *store = DataStore::instance();
+    m_snapshot = store->current();
+    connect(store, &DataStore::dataReset, this, &JobManager::onDataReset);
+    connect(store, &DataStore::dataEdited, this, &JobManager::onDataEdited);
+
+    // 其他管理员正在编辑的职位在列表中标出，选中时只读
+    auto *locks = RecordLocks::instance();
+    connect(locks, &RecordLocks::acquireFinished, this, &JobManager::onLockAcquired);
+    connect(locks, &RecordLocks::lockLost, this, &JobManager::onLockLost);
+    connect(locks, &RecordLocks::locksChanged, this, [this](const QString &type) {
+        if (type == "jobs") updateLockMarks();
+    });
+
+    if (!jobs().isEmpty()) updateJobListWidget();
 }
 
 JobManager::~JobManager()
@@ -30,71 +95,342 @@ JobManager::~JobManager()
     delete ui;
 }
 
-void JobManager::updateData(const QList<Job> &jobs)
+void JobManager::onDataReset(SnapshotPtr snapshot, DataStore::Sections sections)
 {
-    m_jobs = jobs;
-    updateJobListWidget();
+    m_snapshot = snapshot;
+    if (sections & DataStore::Jobs) {
+        // 整体替换后记录都换了新的，之前的批量修改已经无从撤销
+        m_bulkHistory.clear();
+        updateBulkPanel();
+        updateJobListWidget();
+    }
 }
 
-void JobManager::on_saveButton_clicked()
+void JobManager::onDataEdited(SnapshotPtr snapshot)
 {
-    QJsonArray jobsArray;
-    for (const auto &job : m_jobs) {
-        QJsonObject jobObj;
-        jobObj["title"] = job.title;
-        jobObj["quota"] = job.quota;
-        jobObj["salary"] = job.salaryEnd.isEmpty() ? job.salaryStart : job.salaryStart.trimmed() + " - " + job.salaryEnd.trimmed();
-        jobObj["requirements"] = job.requirements;
-        jobsArray.append(jobObj);
-    }
-    QJsonDocument doc(jobsArray);
-    QString jsonDataString = QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+    // 本模块的编辑在发出修改前已经更新了界面，这里只需换成最新的快照
+    m_snapshot = snapshot;
+}
 
-    QUrl url("https://tianyuhuanbao.com/api.php");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+void JobManager::editCurrentJob(const std::function<void(Job &)> &edit)
+{
+    int idx = ui->jobListWidget->currentRow();
+    if (idx < 0 || idx >= jobs().size()) return;
+    Job job = *jobs()[idx];
+    edit(job);
+    DataStore::instance()->setJob(idx, job);
+}
+
+void JobManager::restoreUnfinishedWork(const QJsonObject &state)
+{
+    DataStore::instance()->resetJobs(DataSerializer::jobsFromJson(state["jobs"].toArray()));
+    ui->labelStatus->setText("已恢复上次退出时未保存完成的修改，请确认后重新保存");
+}
 
-    QUrlQuery postData;
-    postData.addQueryItem("action", "save_jobs");
-    postData.addQueryItem("key", m_sessionKey);
-    postData.addQueryItem("data", jsonDataString);
+void JobManager::on_saveButton_clicked()
+{
+    // 离线中，或队列里还有没同步的修改时，本次保存也排进队列，保证按顺序提交
+    auto *queue = MutationQueue::instance();
+    if (queue->isOffline() || queue->pendingCount() > 0) {
+        queueSaveOffline();
+        return;
+    }
 
-    m_networkManager->post(request, postData.query(QUrl::FullyEncoded).toUtf8());
+    // 登记为在途工作，退出时若来不及完成，本地修改会被保留到下次启动
+    auto *coordinator = ShutdownCoordinator::instance();
+    QJsonObject resumeState;
+    resumeState["jobs"] = DataSerializer::toJsonArray(m_snapshot->jobValues());
+    m_saveWorkId = coordinator->beginWork("jobs", resumeState);
 
     ui->labelStatus->setText("正在保存职位信息...");
     ui->saveButton->setEnabled(false);
+
+    const QList<Job> mine = m_snapshot->jobValues();
+    if (!RecordLocks::instance()->isSupported()) {
+        m_mergeConflicts.clear();
+        submitSave(mine, mine);
+        return;
+    }
+
+    // 多人同时编辑：先取回服务器上的最新数据，与本地数据三方合并后再整表保存，
+    // 其他管理员刚保存的修改不会被覆盖
+    ui->labelStatus->setText("正在获取服务器上的最新数据...");
+    RecordMerge::fetchServer(this, [this, mine](const NetworkResult &result, const SyncResponse &response) {
+        if (!result.ok()) {
+            onSaveReply(result); // 断网转入离线队列，其它网络错误直接报告
+            return;
+        }
+        if (!response.isSuccess() || !response.data.hasJobs) {
+            // 拿不到服务器的最新数据时不冒险整表覆盖
+            ShutdownCoordinator::instance()->endWork(m_saveWorkId);
+            m_saveWorkId = 0;
+            ui->saveButton->setEnabled(true);
+            ui->labelStatus->clear();
+            const QString reason = !response.isValid() ? response.parseError
+                                   : response.message.isEmpty() ? QString("响应中没有职位列表") : response.message;
+            QMessageBox::critical(this, "保存失败", "无法获取服务器上的最新数据: " + reason);
+            return;
+        }
+        const auto merged = RecordMerge::threeWay(DataStore::instance()->syncBase().jobValues(), mine,
+                                                  response.data.jobs, RecordMerge::jobKey);
+        m_mergeConflicts = merged.conflicts;
+        ui->labelStatus->setText("正在保存职位信息...");
+        submitSave(mine, merged.records);
+    });
+}
+
+void JobManager::submitSave(const QList<Job> &mine, const QList<Job> &payload)
+{
+    m_sentMine = mine;
+    m_sentPayload = payload;
+
+    // 请求在网络线程中发出，序列化也放在那里完成：直接编码成表单请求体，不经过 QJsonArray 和 QUrlQuery
+    const QString sessionKey = m_sessionKey;
+    const quint64 requestId = NetworkThread::instance()->submit("save_jobs",
+        [sessionKey, payload](QNetworkAccessManager *manager) {
+            return NetworkSession::postForm(manager, "save_jobs", DataSerializer::saveBody(sessionKey, payload));
+        },
+        this, [this](const NetworkResult &result) { onSaveReply(result); });
+    ShutdownCoordinator::instance()->attachRequest(m_saveWorkId, requestId);
+}
+
+// 服务器上现在是合并后的列表：记为新的基准，并把合并进来的其他管理员的修改应用到本地
+// （保存期间本地又做的修改仍然保留）
+void JobManager::applySavedMerge()
+{
+    DataStore::instance()->markSaved(m_sentPayload);
+    if (m_sentPayload == m_sentMine) return;
+
+    const auto local = RecordMerge::threeWay(m_sentMine, m_snapshot->jobValues(), m_sentPayload, RecordMerge::jobKey);
+    const int row = ui->jobListWidget->currentRow();
+    const QString title = (row >= 0 && row < jobs().size()) ? jobs()[row]->title : QString();
+    DataStore::instance()->resetJobs(local.records);
+    for (int i = 0; i < jobs().size(); ++i) {
+        if (jobs()[i]->title == title) {
+            ui->jobListWidget->setCurrentRow(i);
+            break;
+        }
+    }
 }
 
-void JobManager::onSaveReply(QNetworkReply *reply)
+void JobManager::onSaveReply(const NetworkResult &result)
 {
+    ShutdownCoordinator::instance()->endWork(m_saveWorkId);
+    m_saveWorkId = 0;
+
+    // 退出过程中不再弹出任何对话框，以免阻塞限时退出
+    if (ShutdownCoordinator::instance()->isShuttingDown()) return;
+
     ui->saveButton->setEnabled(true);
     ui->labelStatus->clear();
 
-    if (reply->error() != QNetworkReply::NoError) {
-        QMessageBox::critical(this, "网络错误", "保存请求失败: " + reply->errorString());
-    } else {
-        auto doc = QJsonDocument::fromJson(reply->readAll());
-        auto obj = doc.object();
-        if (obj["status"].toString() == "success") {
-            QMessageBox::information(this, "保存成功", "职位信息已成功更新到服务器。");
+    if (NetworkSession::isConnectivityError(result.error)) {
+        MutationQueue::instance()->reportOffline();
+        queueSaveOffline();
+    } else if (!result.ok()) {
+        QMessageBox::critical(this, "网络错误", "保存请求失败: " + result.errorString);
+    } else if (result.json["status"].toString() == "success") {
+        const bool merged = m_sentPayload != m_sentMine;
+        applySavedMerge();
+        if (!m_mergeConflicts.isEmpty()) {
+            QMessageBox::warning(this, "保存成功（有冲突）",
+                                 "以下职位同时被其他管理员修改过，已保存为您的版本：\n" + m_mergeConflicts.join("\n"));
         } else {
-            QMessageBox::critical(this, "保存失败", "服务器返回错误: " + obj["message"].toString());
+            QMessageBox::information(this, "保存成功", merged ? "职位信息已成功更新到服务器，并已合并其他管理员的修改。"
+                                                              : "职位信息已成功更新到服务器。");
         }
+    } else {
+        QMessageBox::critical(this, "保存失败", "服务器返回错误: " + result.json["message"].toString());
+    }
+}
+
+void JobManager::queueSaveOffline()
+{
+    auto *queue = MutationQueue::instance();
+    queue->enqueueSave(m_snapshot->jobValues());
+    ui->saveButton->setEnabled(true);
+    ui->labelStatus->setText(QString("网络不可用，修改已加入离线队列（%1 项待同步）").arg(queue->pendingCount()));
+}
+
+QList<int> JobManager::selectedRows() const
+{
+    QList<int> rows;
+    for (QListWidgetItem *item : ui->jobListWidget->selectedItems()) rows.append(ui->jobListWidget->row(item));
+    std::sort(rows.begin(), rows.end());
+    return rows;
+}
+
+void JobManager::updateBulkPanel()
+{
+    m_bulkPanel->setHistory(m_bulkHistory.canUndo() ? m_bulkHistory.nextUndo().description() : QString(),
+                            m_bulkHistory.canRedo() ? m_bulkHistory.nextRedo().description() : QString());
+}
+
+void JobManager::onBulkApply(const QString &field, const QString &value)
+{
+    if (m_saveWorkId != 0) {
+        ui->labelStatus->setText("正在保存，请稍后再批量修改");
+        return;
+    }
+
+    // 其他管理员正在编辑的职位跳过
+    QList<int> rows;
+    QStringList locked;
+    for (int row : selectedRows()) {
+        const QString &title = jobs()[row]->title;
+        if (RecordLocks::instance()->otherHolder("jobs", title).isEmpty()) rows.append(row);
+        else locked.append(title);
+    }
+
+    const BulkEdit::Edit edit = BulkEdit::apply(DataStore::Jobs, rows, field, value);
+    if (!locked.isEmpty())
+        QMessageBox::information(this, "部分职位未修改", "以下职位正在由其他管理员编辑，已跳过：\n" + locked.join("\n"));
+    if (edit.isEmpty()) {
+        ui->labelStatus->setText("选中的职位不需要修改");
+        return;
+    }
+    m_bulkHistory.push(edit);
+    updateBulkPanel();
+    populateForm(ui->jobListWidget->currentRow());
+    submitBulkPatch(edit.result(), edit.description());
+}
+
+void JobManager::onBulkUndo()
+{
+    if (!m_bulkHistory.canUndo() || m_saveWorkId != 0) return;
+    const QString what = "撤销" + m_bulkHistory.nextUndo().description();
+    const BulkEdit::Patch patch = m_bulkHistory.undo();
+    updateBulkPanel();
+    if (patch.isEmpty()) {
+        ui->labelStatus->setText("这些职位之后都已被修改或删除，没有需要恢复的内容");
+        return;
+    }
+    populateForm(ui->jobListWidget->currentRow());
+    submitBulkPatch(patch, what);
+}
+
+void JobManager::onBulkRedo()
+{
+    if (!m_bulkHistory.canRedo() || m_saveWorkId != 0) return;
+    const QString what = "重做" + m_bulkHistory.nextRedo().description();
+    const BulkEdit::Patch patch = m_bulkHistory.redo();
+    updateBulkPanel();
+    if (patch.isEmpty()) {
+        ui->labelStatus->setText("这些职位之后都已被修改或删除，没有需要重做的内容");
+        return;
+    }
+    populateForm(ui->jobListWidget->currentRow());
+    submitBulkPatch(patch, what);
+}
+
+void JobManager::submitBulkPatch(const BulkEdit::Patch &patch, const QString &what)
+{
+    auto *queue = MutationQueue::instance();
+    if (queue->isOffline() || queue->pendingCount() > 0) {
+        queueSaveOffline();
+        return;
+    }
+    if (!BulkEdit::isSupported()) {
+        on_saveButton_clicked();
+        return;
     }
-    reply->deleteLater();
+
+    auto *coordinator = ShutdownCoordinator::instance();
+    QJsonObject resumeState;
+    resumeState["jobs"] = DataSerializer::toJsonArray(m_snapshot->jobValues());
+    m_saveWorkId = coordinator->beginWork("jobs", resumeState);
+
+    ui->saveButton->setEnabled(false);
+    m_bulkPanel->setBusy(true);
+    ui->labelStatus->setText(QString("正在保存：%1...").arg(what));
+    const quint64 requestId = BulkEdit::submit(m_sessionKey, patch, this, [this, patch, what](const NetworkResult &result) {
+        onBulkPatchReply(result, patch, what);
+    });
+    coordinator->attachRequest(m_saveWorkId, requestId);
+}
+
+void JobManager::onBulkPatchReply(const NetworkResult &result, const BulkEdit::Patch &patch, const QString &what)
+{
+    ShutdownCoordinator::instance()->endWork(m_saveWorkId);
+    m_saveWorkId = 0;
+    if (ShutdownCoordinator::instance()->isShuttingDown()) return;
+
+    m_bulkPanel->setBusy(false);
+    ui->saveButton->setEnabled(true);
+    ui->labelStatus->clear();
+
+    if (NetworkSession::isConnectivityError(result.error)) {
+        MutationQueue::instance()->reportOffline();
+        queueSaveOffline();
+    } else if (!BulkEdit::checkSupported(result)) {
+        on_saveButton_clicked(); // 老版本服务器：整表保存一次
+    } else if (!result.ok()) {
+        QMessageBox::critical(this, "网络错误", "保存请求失败: " + result.errorString);
+    } else if (result.json["status"].toString() == "success") {
+        BulkEdit::markSaved(patch);
+        ui->labelStatus->setText(QString("已保存：%1").arg(what));
+    } else {
+        QMessageBox::critical(this, "保存失败", "服务器返回错误: " + result.json["message"].toString());
+    }
+}
+
+void JobManager::on_fileGetButton_clicked()
+{
+    const QString file = QFileDialog::getOpenFileName(this, "批量导入职位", "", "数据文件 (*.csv *.jsonl *.ndjson)");
+    if (file.isEmpty()) return;
+
+    BulkImporter::Options options;
+    options.kind = BulkImporter::Kind::Jobs;
+    options.filePath = file;
+
+    ui->fileGetButton->setEnabled(false);
+    ui->labelStatus->setText("正在读取导入文件...");
+    BulkImporter::runAsync(options, this,
+        [this](qint64 rows) { ui->labelStatus->setText(QString("正在校验... 已读取 %1 行").arg(rows)); },
+        [this](const BulkImporter::Result &result) { onImportFinished(result); });
+}
+
+void JobManager::onImportFinished(const BulkImporter::Result &result)
+{
+    ui->fileGetButton->setEnabled(true);
+    ui->labelStatus->clear();
+
+    if (!result.fatalError.isEmpty()) {
+        QMessageBox::critical(this, "导入失败", result.fatalError);
+        return;
+    }
+    if (result.validCount() == 0) {
+        QMessageBox::warning(this, "没有可导入的职位", result.summary());
+        return;
+    }
+    if (QMessageBox::question(this, "确认导入", result.summary() + "\n\n是否把有效的职位追加到列表并提交到服务器？",
+                              QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+        return;
+
+    QList<Job> all = m_snapshot->jobValues();
+    all.append(result.jobs);
+    DataStore::instance()->resetJobs(all);
+    ui->jobListWidget->setCurrentRow(all.count() - result.jobs.size());
+
+    // 整表只需保存一次；经由离线队列发送，断网时也不会丢失
+    auto *queue = MutationQueue::instance();
+    queue->enqueueSave(all);
+    ui->labelStatus->setText(QString("已导入 %1 个职位，正在提交...").arg(result.jobs.size()));
 }
 
 // --- [核心修正] 以下是完整的UI交互逻辑实现 ---
 
 void JobManager::updateJobListWidget()
 {
+    StallWatchdog::Scope stallScope("JobManager::updateJobListWidget");
     ui->jobListWidget->blockSignals(true);
     ui->jobListWidget->clear();
-    for (const auto &j: m_jobs)
-        ui->jobListWidget->addItem(j.title);
+    for (const auto &j: jobs())
+        ui->jobListWidget->addItem(j->title);
     ui->jobListWidget->blockSignals(false);
+    updateLockMarks();
 
-    bool hasJobs = !m_jobs.isEmpty();
+    bool hasJobs = !jobs().isEmpty();
     ui->deleteButton->setEnabled(hasJobs);
     ui->saveButton->setEnabled(true);
 
@@ -116,44 +452,93 @@ void JobManager::on_jobListWidget_currentItemChanged(QListWidgetItem *current, Q
     } else {
         clearForm();
     }
+    requestEditLock(idx);
 }
 
-void JobManager::populateForm(int index)
+void JobManager::requestEditLock(int index)
+{
+    const QString record = (index >= 0 && index < jobs().size()) ? jobs()[index]->title : QString();
+    if (!record.isEmpty() && record == m_lockRecord) return;
+    if (!m_lockRecord.isEmpty()) RecordLocks::instance()->release("jobs", m_lockRecord);
+    m_lockRecord.clear();
+    m_pendingLock = record;
+    if (record.isEmpty()) return;
+
+    // 申请到锁之前表单只读；服务器不支持记录锁时会立即得到结果
+    ui->groupBox->setEnabled(false);
+    RecordLocks::instance()->acquire("jobs", record);
+}
+
+// 改名并不真正受记录锁保护（见 RecordLocks）：这里只是让锁跟上新名称
+void JobManager::relockRenamed()
+{
+    const int idx = ui->jobListWidget->currentRow();
+    if (idx < 0 || idx >= jobs().size() || m_lockRecord.isEmpty()) return;
+    const QString record = jobs()[idx]->title;
+    if (record.isEmpty() || record == m_lockRecord || record == m_pendingLock) return;
+
+    RecordLocks::instance()->release("jobs", m_lockRecord);
+    m_lockRecord.clear();
+    m_pendingLock = record;
+    // 表单保持可编辑，不打断正在输入的名称；新名称已被别人锁住时再转为只读
+    RecordLocks::instance()->acquire("jobs", record);
+}
+
+void JobManager::onLockAcquired(const QString &type, const QString &record, bool granted, const QString &holder)
 {
-    if (index < 0 || index >= m_jobs.count()) return;
+    if (type != "jobs") return;
+    if (record != m_pendingLock) {
+        // 申请期间切换了选中或改了名称，已经用不上的锁立即放回
+        if (granted && record != m_lockRecord) RecordLocks::instance()->release("jobs", record);
+        return;
+    }
+    m_pendingLock.clear();
+    if (granted) {
+        m_lockRecord = record;
+        ui->groupBox->setEnabled(true);
+    } else {
+        ui->groupBox->setEnabled(false);
+        ui->labelStatus->setText(QString("“%1”正在由 %2 编辑，暂时只读").arg(record, holder));
+    }
+}
 
-    // 断开信号，防止在用代码填充表单时，触发textChanged信号，造成不必要的数据更新
-    QObject::disconnect(ui->titleEdit, &QLineEdit::textChanged, this, &JobManager::on_titleEdit_textChanged);
-    QObject::disconnect(ui->quotaEdit, &QLineEdit::textChanged, this, &JobManager::on_quotaEdit_textChanged);
-    QObject::disconnect(ui->startsalaryEdit, &QLineEdit::textChanged, this, &JobManager::on_startsalaryEdit_textChanged);
-    QObject::disconnect(ui->endsalaryEdit, &QLineEdit::textChanged, this, &JobManager::on_endsalaryEdit_textChanged);
-    QObject::disconnect(ui->requirementEdit, &QPlainTextEdit::textChanged, this, &JobManager::on_requirementEdit_textChanged);
+void JobManager::onLockLost(const QString &type, const QString &record)
+{
+    if (type != "jobs" || record != m_lockRecord) return;
+    // 租约过期（例如网络中断过一段时间）：重新申请，拿不到时转为只读
+    m_lockRecord.clear();
+    m_pendingLock = record;
+    ui->groupBox->setEnabled(false);
+    RecordLocks::instance()->acquire("jobs", record);
+}
 
-    // 从 m_jobs 列表中取出对应的数据
-    const Job &j = m_jobs[index];
+void JobManager::updateLockMarks()
+{
+    const int count = qMin(ui->jobListWidget->count(), int(jobs().size()));
+    for (int row = 0; row < count; ++row) updateLockMark(row);
+}
 
-    // 将数据设置到UI控件上
-    ui->titleEdit->setText(j.title);
-    ui->quotaEdit->setText(j.quota);
-    ui->startsalaryEdit->setText(j.salaryStart);
-    ui->endsalaryEdit->setText(j.salaryEnd);
-    ui->requirementEdit->setPlainText(j.requirements);
+void JobManager::updateLockMark(int row)
+{
+    QListWidgetItem *item = ui->jobListWidget->item(row);
+    if (!item || row >= jobs().size()) return;
+    const QString &title = jobs()[row]->title;
+    const QString holder = RecordLocks::instance()->otherHolder("jobs", title);
+    item->setText(holder.isEmpty() ? title : QString("%1（%2 正在编辑）").arg(title, holder));
+    item->setForeground(holder.isEmpty() ? QBrush() : QBrush(Qt::gray));
+    item->setToolTip(holder.isEmpty() ? QString() : QString("%1 正在编辑这个职位").arg(holder));
+}
 
-    // 填充完毕后，重新连接信号，以便响应用户的编辑操作
-    connect(ui->titleEdit,       &QLineEdit::textChanged,      this, &JobManager::on_titleEdit_textChanged);
-    connect(ui->quotaEdit,       &QLineEdit::textChanged,      this, &JobManager::on_quotaEdit_textChanged);
-    connect(ui->startsalaryEdit, &QLineEdit::textChanged,      this, &JobManager::on_startsalaryEdit_textChanged);
-    connect(ui->endsalaryEdit,   &QLineEdit::textChanged,      this, &JobManager::on_endsalaryEdit_textChanged);
-    connect(ui->requirementEdit, &QPlainTextEdit::textChanged, this, &JobManager::on_requirementEdit_textChanged);
+void JobManager::populateForm(int index)
+{
+    StallWatchdog::Scope stallScope("JobManager::populateForm");
+    if (index < 0 || index >= jobs().count()) return;
+    m_form.setRecord(jobs()[index]);
 }
 
 void JobManager::clearForm()
 {
-    ui->titleEdit->clear();
-    ui->quotaEdit->clear();
-    ui->startsalaryEdit->clear();
-    ui->endsalaryEdit->clear();
-    ui->requirementEdit->clear();
+    m_form.clear();
 }
 
 void JobManager::on_addButton_clicked()
@@ -162,9 +547,9 @@ void JobManager::on_addButton_clicked()
     j.title = "新职位 - 请修改";
     j.quota = "若干";
     j.salaryStart = "面议";
-    m_jobs.append(j);
+    DataStore::instance()->insertJob(jobs().count(), j);
     updateJobListWidget();
-    ui->jobListWidget->setCurrentRow(m_jobs.count() - 1);
+    ui->jobListWidget->setCurrentRow(jobs().count() - 1);
 }
 
 void JobManager::on_deleteButton_clicked()
@@ -173,43 +558,10 @@ void JobManager::on_deleteButton_clicked()
     if (row < 0) return;
 
     QMessageBox::StandardButton reply;
-    reply = QMessageBox::question(this, "确认删除", "您确定要删除职位 “" + m_jobs[row].title + "” 吗？\n此操作将立即影响服务器数据！",
+    reply = QMessageBox::question(this, "确认删除", "您确定要删除职位 “" + jobs()[row]->title + "” 吗？\n此操作将立即影响服务器数据！",
                                   QMessageBox::Yes|QMessageBox::No);
     if (reply == QMessageBox::Yes) {
-        m_jobs.removeAt(row);
+        DataStore::instance()->removeJob(row);
         updateJobListWidget();
     }
 }
-
-void JobManager::on_titleEdit_textChanged(const QString &text)
-{
-    int idx = ui->jobListWidget->currentRow();
-    if (idx >= 0) {
-        m_jobs[idx].title = text;
-        ui->jobListWidget->item(idx)->setText(text);
-    }
-}
-
-void JobManager::on_quotaEdit_textChanged(const QString &text)
-{
-    int idx = ui->jobListWidget->currentRow();
-    if (idx >= 0) m_jobs[idx].quota = text;
-}
-
-void JobManager::on_startsalaryEdit_textChanged(const QString &text)
-{
-    int idx = ui->jobListWidget->currentRow();
-    if (idx >= 0) m_jobs[idx].salaryStart = text;
-}
-
-void JobManager::on_endsalaryEdit_textChanged(const QString &text)
-{
-    int idx = ui->jobListWidget->currentRow();
-    if (idx >= 0) m_jobs[idx].salaryEnd = text;
-}
-
-void JobManager::on_requirementEdit_textChanged()
-{
-    int idx = ui->jobListWidget->currentRow();
-    if (idx >= 0) m_jobs[idx].requirements = ui->requirementEdit->toPlainText();
-}
@@ -4,17 +4,28 @@
 
 #include <QWidget>
 #include "datastructures.h" // 包含 struct Job 的定义
+#include "datastore.h"
+#include "formbinding.h"
+#include "bulkedit.h"
 #include <QList>
+#include <functional>
 
 // 向前声明，以减少头文件依赖
-class QNetworkAccessManager;
-class QNetworkReply;
 class QListWidgetItem;
+class QJsonObject;
+class QTimer;
+class BulkEditPanel;
 
 namespace Ui {
 class JobManager;
 }
 
+struct NetworkResult;
+
+namespace BulkImporter {
+struct Result;
+}
+
 class JobManager : public QWidget
 {
     Q_OBJECT
@@ -24,11 +35,8 @@ public:
     ~JobManager();
 
 public slots:
-    /**
-     * @brief updateData 是该模块的核心入口。
-     * @param jobs 由MainWindow在获取到最新数据后调用，传入完整的职位列表。
-     */
-    void updateData(const QList<Job> &jobs);
+    // 恢复上次退出时没能保存完成的职位列表（状态由 ShutdownCoordinator 保存）
+    void restoreUnfinishedWork(const QJsonObject &state);
 
 private slots:
     // UI 交互
@@ -36,27 +44,75 @@ private slots:
     void on_deleteButton_clicked();
     void on_jobListWidget_currentItemChanged(QListWidgetItem *current, QListWidgetItem *previous);
 
-    // 编辑框内容改动
-    void on_titleEdit_textChanged(const QString &text);
-    void on_quotaEdit_textChanged(const QString &text);
-    void on_startsalaryEdit_textChanged(const QString &text);
-    void on_endsalaryEdit_textChanged(const QString &text);
-    void on_requirementEdit_textChanged();
-
     // 保存功能
     void on_saveButton_clicked();
-    void onSaveReply(QNetworkReply *reply);
+
+    // 批量导入（“浏览”按钮）
+    void on_fileGetButton_clicked();
+
+    // DataStore 发布了新快照
+    void onDataReset(SnapshotPtr snapshot, DataStore::Sections sections);
+    void onDataEdited(SnapshotPtr snapshot);
+
+    // 记录级编辑锁
+    void onLockAcquired(const QString &type, const QString &record, bool granted, const QString &holder);
+    void onLockLost(const QString &type, const QString &record);
+    void updateLockMarks();
+
+    // 多选后的批量修改
+    void onBulkApply(const QString &field, const QString &value);
+    void onBulkUndo();
+    void onBulkRedo();
 
 private:
     Ui::JobManager *ui;
-    QList<Job>     m_jobs;
-    QNetworkAccessManager *m_networkManager;
+    // 当前持有的数据快照；职位列表就是 m_snapshot->jobs，本模块不再保存自己的拷贝
+    SnapshotPtr    m_snapshot;
     const QString  m_sessionKey;
+    int            m_saveWorkId = 0; // 正在进行的保存在 ShutdownCoordinator 中的编号
+    RecordBinding<Job> m_form;       // 编辑表单与当前职位的绑定
+
+    // 当前选中职位的编辑锁（按职位名称），以及正在申请中的锁；
+    // 改名停下来一会儿后由 m_relockTimer 把锁换到新名称上
+    QString        m_lockRecord;
+    QString        m_pendingLock;
+    QTimer        *m_relockTimer;
+    // 合并保存：发送时本地的列表和实际发送的（合并后的）列表
+    QList<Job>     m_sentMine;
+    QList<Job>     m_sentPayload;
+    QStringList    m_mergeConflicts;
+    // 批量修改面板和它的撤销记录
+    BulkEditPanel *m_bulkPanel;
+    BulkEdit::History m_bulkHistory;
+
+    const RecordList<Job> &jobs() const { return m_snapshot->jobs; }
+    // 修改当前选中的职位，生成新版本的快照
+    void editCurrentJob(const std::function<void(Job &)> &edit);
+
+    void requestEditLock(int index);
+    void relockRenamed();         // 放掉旧名称的锁，改用当前名称申请
+    void updateLockMark(int row); // 只刷新列表中的一行（编辑职位名称时）
+    // 发送保存请求；mine 是发送时本地的列表，payload 是与服务器最新数据合并后的列表
+    void submitSave(const QList<Job> &mine, const QList<Job> &payload);
+    void onSaveReply(const NetworkResult &result);
+    // 保存成功后更新同步基准，并把合并进来的其他管理员的修改应用到本地
+    void applySavedMerge();
 
     // 纯 UI 更新函数
     void updateJobListWidget();
     void populateForm(int index);
     void clearForm();
+
+    // 把当前职位列表作为一次保存放入离线队列
+    void queueSaveOffline();
+
+    void onImportFinished(const BulkImporter::Result &result);
+
+    QList<int> selectedRows() const;
+    void updateBulkPanel();
+    // 把批量修改（或它的撤销、重做）作为一个补丁保存；服务器不支持补丁时整表保存
+    void submitBulkPatch(const BulkEdit::Patch &patch, const QString &what);
+    void onBulkPatchReply(const NetworkResult &result, const BulkEdit::Patch &patch, const QString &what);
 };
 
 #endif // JOBMANAGER_H
@@ -0,0 +1,255 @@
+// jsonbackend.cpp
+#include "jsonbackend.h"
+#include "dataserializer.h"
+#include "tracelog.h"
+
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QSettings>
+#include <QDebug>
+
+#ifdef HRWINDOW_SIMDJSON
+#include <simdjson.h>
+#include <limits>
+#endif
+
+namespace {
+
+class QtJsonBackend : public JsonBackend
+{
+public:
+    const char *name() const override { return "qt"; }
+
+    SyncResponse parse(const QByteArray &body) const override
+    {
+        SyncResponse response;
+        QJsonParseError error;
+        QJsonDocument doc;
+        {
+            TraceLog::Span span("parse", "parse document", QString("%1 bytes, qt").arg(body.size()));
+            doc = QJsonDocument::fromJson(body, &error);
+        }
+        if (!doc.isObject()) {
+            response.parseError = doc.isNull() ? error.errorString() : QString("不是 JSON 对象");
+            return response;
+        }
+        const QJsonObject root = doc.object();
+        response.status = root["status"].toString();
+        response.message = root["message"].toString();
+        if (root["data"].isObject()) {
+            response.hasData = true;
+            response.data = DataSerializer::syncDataFromJson(root["data"].toObject());
+        }
+        return response;
+    }
+};
+
+#ifdef HRWINDOW_SIMDJSON
+namespace od = simdjson::ondemand;
+
+QString toQString(std::string_view text)
+{
+    return QString::fromUtf8(text.data(), qsizetype(text.size()));
+}
+
+// 与 QJsonValue::toString() 一致：不是字符串时为空
+QString stringValue(od::value value)
+{
+    if (value.type() != od::json_type::string) return QString();
+    return toQString(value.get_string());
+}
+
+// 与 QJsonValue::toInt() 一致：不是整数值或超出 int 范围时为 0
+int intValue(od::value value)
+{
+    if (value.type() != od::json_type::number) return 0;
+    const double d = value.get_double();
+    // 先检查范围再转换，超出范围的 double 转成 int 是未定义行为
+    if (!(d >= double(std::numeric_limits<int>::min()) && d <= double(std::numeric_limits<int>::max()))) return 0;
+    const int i = int(d);
+    return double(i) == d ? i : 0;
+}
+
+QStringList stringList(od::value value)
+{
+    QStringList list;
+    if (value.type() != od::json_type::array) return list;
+    for (od::value item : value.get_array()) list.append(stringValue(item));
+    return list;
+}
+
+// 字段名与 DataSerializer::jobFromJson / productFromJson / statsFromJson 保持一致
+Job parseJob(od::object obj)
+{
+    Job job;
+    for (od::field field : obj) {
+        const std::string_view key = field.unescaped_key();
+        if (key == "title") job.title = stringValue(field.value());
+        else if (key == "quota") job.quota = stringValue(field.value());
+        else if (key == "salaryStart") job.salaryStart = stringValue(field.value());
+        else if (key == "salaryEnd") job.salaryEnd = stringValue(field.value());
+        else if (key == "requirements") job.requirements = stringValue(field.value());
+    }
+    return job;
+}
+
+Product parseProduct(od::object obj)
+{
+    Product product;
+    for (od::field field : obj) {
+        const std::string_view key = field.unescaped_key();
+        if (key == "name") product.name = stringValue(field.value());
+        else if (key == "category") product.category = stringValue(field.value());
+        else if (key == "description") product.description = stringValue(field.value());
+        else if (key == "imageUrls") product.imageUrls = stringList(field.value());
+    }
+    return product;
+}
+
+DashboardStats parseStats(od::object obj)
+{
+    DashboardStats stats;
+    for (od::field field : obj) {
+        const std::string_view key = field.unescaped_key();
+        if (key == "total_jobs_count") stats.totalJobsCount = intValue(field.value());
+        else if (key == "total_products_count") stats.totalProductsCount = intValue(field.value());
+        else if (key == "total_cases_count") stats.totalCasesCount = intValue(field.value());
+        else if (key == "total_recruitment_quota") stats.totalRecruitmentQuota = intValue(field.value());
+        else if (key == "server_time") stats.serverTime = stringValue(field.value());
+    }
+    return stats;
+}
+
+// 数组元素不是对象时按空对象处理，与 QJsonValue::toObject() 一致
+template <typename T, typename Parse>
+QList<T> parseList(od::array array, Parse parseItem)
+{
+    QList<T> list;
+    for (od::value item : array)
+        list.append(item.type() == od::json_type::object ? parseItem(item.get_object()) : T());
+    return list;
+}
+
+void parseData(od::object obj, SyncData &sync)
+{
+    for (od::field field : obj) {
+        const std::string_view key = field.unescaped_key();
+        od::value value = field.value();
+        const od::json_type type = value.type();
+        if (key == "jobs" && type == od::json_type::array) {
+            sync.jobs = parseList<Job>(value.get_array(), parseJob);
+            sync.hasJobs = true;
+        } else if (key == "products" && type == od::json_type::array) {
+            sync.products = parseList<Product>(value.get_array(), parseProduct);
+            sync.hasProducts = true;
+        } else if (key == "stats" && type == od::json_type::object) {
+            sync.stats = parseStats(value.get_object());
+            sync.hasStats = true;
+        }
+    }
+}
+
+class SimdJsonBackend : public JsonBackend
+{
+public:
+    const char *name() const override { return "simdjson"; }
+
+    // 没有可用的 SIMD 指令集时 simdjson 只能使用逐字节的通用实现，那样并不比 Qt 快
+    static bool isSupported()
+    {
+        return simdjson::get_active_implementation()->name() != "fallback";
+    }
+
+    SyncResponse parse(const QByteArray &body) const override
+    {
+        TraceLog::Span span("parse", "parse document", QString("%1 bytes, simdjson").arg(body.size()));
+        SyncResponse response;
+
+        // 输入末尾需要 SIMDJSON_PADDING 字节的可读空间；QByteArray 的容量够用时直接解析，否则复制一份
+        simdjson::padded_string copy;
+        simdjson::padded_string_view input;
+        if (body.capacity() - body.size() >= qsizetype(simdjson::SIMDJSON_PADDING)) {
+            input = simdjson::padded_string_view(body.constData(), size_t(body.size()), size_t(body.capacity()));
+        } else {
+            copy = simdjson::padded_string(body.constData(), size_t(body.size()));
+            input = copy;
+        }
+
+        // 解析器内部缓冲区按线程复用
+        thread_local od::parser parser;
+        try {
+            od::document doc = parser.iterate(input);
+            if (doc.type() != od::json_type::object) {
+                response.parseError = "不是 JSON 对象";
+                return response;
+            }
+            for (od::field field : doc.get_object()) {
+                const std::string_view key = field.unescaped_key();
+                if (key == "status") {
+                    response.status = stringValue(field.value());
+                } else if (key == "message") {
+                    response.message = stringValue(field.value());
+                } else if (key == "data") {
+                    od::value value = field.value();
+                    if (value.type() != od::json_type::object) continue;
+                    response.hasData = true;
+                    response.data = SyncData();
+                    parseData(value.get_object(), response.data);
+                }
+            }
+            // 按需解析只读到需要的地方，末尾的多余内容要单独检查
+            if (!doc.at_end()) response.parseError = "JSON 对象之后还有多余的内容";
+        } catch (const simdjson::simdjson_error &error) {
+            response = SyncResponse();
+            response.parseError = QString::fromLatin1(error.what());
+        }
+        if (response.hasData)
+            span.setDetail(QString("%1 bytes, simdjson, %2 个职位, %3 个产品")
+                               .arg(body.size()).arg(response.data.jobs.size()).arg(response.data.products.size()));
+        return response;
+    }
+};
+#endif
+
+const QtJsonBackend &qtBackend()
+{
+    static const QtJsonBackend backend;
+    return backend;
+}
+
+} // namespace
+
+QList<const JsonBackend *> JsonBackend::available()
+{
+    QList<const JsonBackend *> backends{&qtBackend()};
+#ifdef HRWINDOW_SIMDJSON
+    static const SimdJsonBackend simd;
+    if (SimdJsonBackend::isSupported()) backends.append(&simd);
+#endif
+    return backends;
+}
+
+const JsonBackend *JsonBackend::byName(const QString &name)
+{
+    for (const JsonBackend *backend : available()) {
+        if (name == QLatin1String(backend->name())) return backend;
+    }
+    return nullptr;
+}
+
+const JsonBackend &JsonBackend::active()
+{
+    static const JsonBackend *backend = [] {
+        QString requested = qEnvironmentVariable("HRWINDOW_JSON_BACKEND");
+        if (requested.isEmpty()) requested = QSettings().value("sync/jsonBackend").toString();
+        // 没有指定时优先使用最快的可用后端
+        if (requested.isEmpty()) return available().last();
+        const JsonBackend *found = byName(requested);
+        if (!found) {
+            qDebug() << "JSON backend" << requested << "is not available, using qt";
+            found = &qtBackend();
+        }
+        return found;
+    }();
+    return *backend;
+}
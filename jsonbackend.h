@@ -0,0 +1,45 @@
+// jsonbackend.h
+#ifndef JSONBACKEND_H
+#define JSONBACKEND_H
+
+#include <QByteArray>
+#include <QList>
+#include <QString>
+#include "datastructures.h"
+
+// 一次 get_all_data 响应的解析结果
+struct SyncResponse {
+    QString parseError; // 非空表示响应体不是有效的 JSON 对象
+    QString status;
+    QString message;
+    bool hasData = false; // data 是否为对象
+    SyncData data;
+
+    bool isValid() const { return parseError.isEmpty(); }
+    bool isSuccess() const { return isValid() && status == "success"; }
+};
+
+// --- get_all_data 的 JSON 解析后端 ---
+// 同步路径的绝大部分时间花在把响应体变成数据结构上。这里把“响应体 -> SyncResponse”抽象出来：
+//   - qt：QJsonDocument::fromJson 建立完整的 DOM，再由 DataSerializer 转换，始终可用
+//   - simdjson：按需（on-demand）解析，边扫描边直接填充数据结构，不建立 DOM；
+//     仅在以 CONFIG+=simdjson 构建时编译进来，CPU 不支持 SIMD 指令集时（simdjson 只能退回通用实现）不启用
+// 运行时通过环境变量 HRWINDOW_JSON_BACKEND 或本地配置 sync/jsonBackend 选择，
+// 指定的后端不可用时退回 qt。两个后端的结果完全一致，hrwindow-cli bench-json 可以对比它们的速度。
+// parse() 可在任意线程调用。
+class JsonBackend
+{
+public:
+    virtual ~JsonBackend() = default;
+
+    virtual const char *name() const = 0;
+    virtual SyncResponse parse(const QByteArray &body) const = 0;
+
+    // 当前选用的后端（第一次调用时确定）
+    static const JsonBackend &active();
+    // 本次构建、本机 CPU 上可用的全部后端，qt 总在第一个
+    static QList<const JsonBackend *> available();
+    static const JsonBackend *byName(const QString &name);
+};
+
+#endif // JSONBACKEND_H
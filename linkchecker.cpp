@@ -0,0 +1,321 @@
+// linkchecker.cpp
+#include "linkchecker.h"
+#include "mutationqueue.h"
+#include "networkthread.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QNetworkRequest>
+#include <QSet>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QTimer>
+#include <QUrl>
+#include <QDebug>
+#include <cmath>
+#include <utility>
+
+namespace {
+
+// 同步完成后等界面安静下来再开始扫描
+const int kStartDelayMs = 3000;
+// 结果合并通知的间隔
+const int kNotifyMs = 200;
+// 单个检查请求的超时
+const int kTimeoutMs = 10000;
+// 这么久没有再检查过的地址（多半已经不在目录里了）写盘时丢弃
+const qint64 kForgetMs = 30LL * 24 * 3600 * 1000;
+
+} // namespace
+
+LinkChecker *LinkChecker::instance()
+{
+    static LinkChecker *checker = new LinkChecker(qApp);
+    return checker;
+}
+
+LinkChecker::LinkChecker(QObject *parent)
+    : QObject(parent)
+    , m_startTimer(new QTimer(this))
+    , m_pumpTimer(new QTimer(this))
+    , m_notifyTimer(new QTimer(this))
+{
+    QSettings settings;
+    m_maxConcurrent = qMax(1, settings.value("links/maxConcurrent", 32).toInt());
+    m_perHostConcurrent = qMax(1, settings.value("links/perHostConcurrent", 4).toInt());
+    m_perHostPerSecond = qMax(1.0, settings.value("links/perHostPerSecond", 50).toDouble());
+    m_ttlMs = qMax(1, settings.value("links/ttlHours", 24).toInt()) * 3600LL * 1000;
+    m_clock.start();
+
+    m_startTimer->setSingleShot(true);
+    m_startTimer->setInterval(kStartDelayMs);
+    connect(m_startTimer, &QTimer::timeout, this, [this]() { scan(std::exchange(m_scheduled, QStringList())); });
+    m_pumpTimer->setSingleShot(true);
+    connect(m_pumpTimer, &QTimer::timeout, this, &LinkChecker::pump);
+    m_notifyTimer->setSingleShot(true);
+    m_notifyTimer->setInterval(kNotifyMs);
+    connect(m_notifyTimer, &QTimer::timeout, this, [this]() {
+        if (isRunning()) emit progress(m_done, m_total);
+        if (m_changed) {
+            m_changed = false;
+            emit resultsChanged();
+        }
+    });
+}
+
+QString LinkChecker::cacheFilePath()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::AppDataLocation) + "/links_cache.json";
+}
+
+bool LinkChecker::isCheckable(const QString &url)
+{
+    if (MutationQueue::isPlaceholder(url)) return false;
+    const QUrl parsed(url);
+    return parsed.scheme() == "http" || parsed.scheme() == "https";
+}
+
+bool LinkChecker::isFresh(const LinkStatus &status, qint64 now) const
+{
+    return status.state != LinkStatus::Unknown && now - status.checkedAt < m_ttlMs;
+}
+
+QStringList LinkChecker::brokenUrls(const QStringList &urls) const
+{
+    QStringList broken;
+    for (const QString &url : urls) {
+        if (isBroken(url)) broken.append(url);
+    }
+    return broken;
+}
+
+void LinkChecker::scanCatalog(const Snapshot &snapshot)
+{
+    QStringList urls;
+    for (const auto &product : snapshot.products) urls += product->imageUrls;
+    for (const auto &caseStudy : snapshot.cases) urls += caseStudy->imageUrls;
+    m_scheduled = urls;
+    m_startTimer->start();
+}
+
+void LinkChecker::cancel()
+{
+    m_startTimer->stop();
+    m_scheduled.clear();
+    m_pumpTimer->stop();
+    ++m_generation;
+    m_total = 0;
+    m_done = 0;
+    // 已经发出的请求照常完成并更新缓存，只是不再计入任何一轮
+    for (auto it = m_hosts.begin(); it != m_hosts.end();) {
+        if (it->inFlight == 0) {
+            it = m_hosts.erase(it);
+        } else {
+            it->waiting.clear();
+            ++it;
+        }
+    }
+    m_hostOrder = m_hosts.keys();
+    m_nextHost = 0;
+}
+
+void LinkChecker::scan(const QStringList &urls)
+{
+    load();
+    cancel();
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    const qint64 clock = m_clock.elapsed();
+    QSet<QString> seen;
+    m_scanUrls.clear();
+    for (const QString &url : urls) {
+        if (!isCheckable(url) || seen.contains(url)) continue;
+        seen.insert(url);
+        m_scanUrls.append(url);
+        if (isFresh(m_cache.value(url), now)) continue;
+
+        const QString host = QUrl(url).host();
+        auto it = m_hosts.find(host);
+        if (it == m_hosts.end()) {
+            it = m_hosts.insert(host, Host());
+            it->tokens = m_perHostPerSecond; // 起步时允许一次突发
+            it->refilledAt = clock;
+            m_hostOrder.append(host);
+        }
+        it->waiting.enqueue(url);
+        ++m_total;
+    }
+
+    m_elapsed.start();
+    if (m_total == 0) {
+        emit scanFinished(0, brokenUrls(m_scanUrls).size(), 0);
+        return;
+    }
+    qDebug().noquote() << QString("[links] checking %1 of %2 image url(s) on %3 host(s)")
+                          .arg(m_total).arg(m_scanUrls.size()).arg(m_hostOrder.size());
+    emit progress(0, m_total);
+    pump();
+}
+
+// 在并发上限内轮流从各主机取出地址发出检查；令牌不够时定时到下一个令牌产生再继续
+void LinkChecker::pump()
+{
+    const qint64 now = m_clock.elapsed();
+    qint64 wait = -1;
+    bool started = true;
+    while (started && m_inFlight < m_maxConcurrent && !m_hostOrder.isEmpty()) {
+        started = false;
+        for (int n = 0; n < m_hostOrder.size() && m_inFlight < m_maxConcurrent; ++n) {
+            m_nextHost = (m_nextHost + 1) % m_hostOrder.size();
+            Host &host = m_hosts[m_hostOrder[m_nextHost]];
+            if (host.waiting.isEmpty() || host.inFlight >= m_perHostConcurrent) continue;
+
+            host.tokens = qMin(m_perHostPerSecond, host.tokens + (now - host.refilledAt) * m_perHostPerSecond / 1000.0);
+            host.refilledAt = now;
+            if (host.tokens < 1) {
+                const qint64 ms = qint64(std::ceil((1 - host.tokens) * 1000 / m_perHostPerSecond));
+                wait = wait < 0 ? ms : qMin(wait, ms);
+                continue;
+            }
+            host.tokens -= 1;
+            ++host.inFlight;
+            ++m_inFlight;
+            check(host.waiting.dequeue(), false, m_generation);
+            started = true;
+        }
+    }
+    if (wait >= 0 && !m_pumpTimer->isActive()) m_pumpTimer->start(int(wait));
+}
+
+void LinkChecker::check(const QString &url, bool rangedGet, quint64 generation)
+{
+    const LinkStatus cached = m_cache.value(url);
+    const QByteArray etag = cached.etag;
+    const QByteArray lastModified = cached.lastModified;
+    NetworkThread::instance()->submit("check_link",
+        [url, etag, lastModified, rangedGet](QNetworkAccessManager *manager) {
+            QNetworkRequest request{QUrl(url)};
+            request.setAttribute(QNetworkRequest::User, "check_link");
+            request.setAttribute(NetworkThread::RawBodyAttribute, true);
+            request.setTransferTimeout(kTimeoutMs);
+            if (!etag.isEmpty()) request.setRawHeader("If-None-Match", etag);
+            if (!lastModified.isEmpty()) request.setRawHeader("If-Modified-Since", lastModified);
+            if (!rangedGet) return manager->head(request);
+            request.setRawHeader("Range", "bytes=0-0");
+            return manager->get(request);
+        },
+        this, [this, url, rangedGet, generation](const NetworkResult &result) {
+            onResult(url, rangedGet, generation, result);
+        });
+}
+
+void LinkChecker::onResult(const QString &url, bool rangedGet, quint64 generation, const NetworkResult &result)
+{
+    const int status = result.httpStatus;
+    if (!rangedGet && (status == 405 || status == 501)) {
+        check(url, true, generation); // 不支持 HEAD，占用的并发名额直接转给 GET
+        return;
+    }
+
+    Host &host = m_hosts[QUrl(url).host()];
+    --host.inFlight;
+    --m_inFlight;
+
+    LinkStatus &entry = m_cache[url];
+    const LinkStatus::State before = entry.state;
+    if ((status >= 200 && status < 300) || status == 304) {
+        entry.state = LinkStatus::Ok;
+        entry.checkedAt = QDateTime::currentMSecsSinceEpoch();
+        if (status != 304) {
+            entry.etag = result.etag;
+            entry.lastModified = result.lastModified;
+        }
+    } else if (status >= 400 && status < 500 && status != 408 && status != 429) {
+        entry.state = LinkStatus::Broken;
+        entry.checkedAt = QDateTime::currentMSecsSinceEpoch();
+        entry.etag.clear();
+        entry.lastModified.clear();
+    }
+    // 其余情况（5xx、超时、断网）暂时查不到：保留以前的结论，下次扫描再查
+    if (status > 0) entry.httpStatus = status;
+    if (entry.state != before) m_changed = true;
+
+    if (generation == m_generation && isRunning()) {
+        ++m_done;
+        if (m_done >= m_total) {
+            finish();
+            return;
+        }
+        if (!m_notifyTimer->isActive()) m_notifyTimer->start();
+    } else if (m_changed && !m_notifyTimer->isActive()) {
+        m_notifyTimer->start();
+    }
+    pump();
+}
+
+void LinkChecker::finish()
+{
+    const int checked = m_total;
+    const int broken = brokenUrls(m_scanUrls).size();
+    const qint64 elapsed = m_elapsed.elapsed();
+    m_total = 0;
+    m_done = 0;
+    m_notifyTimer->stop();
+    emit progress(checked, checked);
+    if (m_changed) {
+        m_changed = false;
+        emit resultsChanged();
+    }
+    qDebug().noquote() << QString("[links] checked %1 url(s) in %2 ms, %3 broken").arg(checked).arg(elapsed).arg(broken);
+    emit scanFinished(checked, broken, elapsed);
+    save();
+}
+
+void LinkChecker::load()
+{
+    if (m_loaded) return;
+    m_loaded = true;
+
+    QFile file(cacheFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return;
+    const QJsonObject links = QJsonDocument::fromJson(file.readAll()).object()["links"].toObject();
+    m_cache.reserve(links.size());
+    for (auto it = links.constBegin(); it != links.constEnd(); ++it) {
+        const QJsonObject obj = it.value().toObject();
+        LinkStatus status;
+        status.state = LinkStatus::State(obj["s"].toInt());
+        status.httpStatus = obj["h"].toInt();
+        status.checkedAt = qint64(obj["t"].toDouble());
+        status.etag = obj["e"].toString().toUtf8();
+        status.lastModified = obj["m"].toString().toUtf8();
+        m_cache.insert(it.key(), status);
+    }
+}
+
+void LinkChecker::save()
+{
+    const qint64 oldest = QDateTime::currentMSecsSinceEpoch() - kForgetMs;
+    QJsonObject links;
+    for (auto it = m_cache.cbegin(); it != m_cache.cend(); ++it) {
+        const LinkStatus &status = it.value();
+        if (status.state == LinkStatus::Unknown || status.checkedAt < oldest) continue;
+        QJsonObject obj{{"s", int(status.state)}, {"h", status.httpStatus}, {"t", double(status.checkedAt)}};
+        if (!status.etag.isEmpty()) obj["e"] = QString::fromUtf8(status.etag);
+        if (!status.lastModified.isEmpty()) obj["m"] = QString::fromUtf8(status.lastModified);
+        links.insert(it.key(), obj);
+    }
+
+    const QString path = cacheFilePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(QJsonDocument(QJsonObject{{"version", 1}, {"links", links}}).toJson(QJsonDocument::Compact));
+    else
+        qDebug() << "Cannot write link cache to" << path;
+}
@@ -0,0 +1,105 @@
+// linkchecker.h
+#ifndef LINKCHECKER_H
+#define LINKCHECKER_H
+
+#include <QObject>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include <QQueue>
+#include <QStringList>
+#include "datastore.h"
+
+class QTimer;
+struct NetworkResult;
+
+// 一个图片地址的检查结果
+struct LinkStatus {
+    enum State { Unknown, Ok, Broken };
+    State state = Unknown;
+    int httpStatus = 0;     // 最近一次得到的 HTTP 状态码，0 表示没有收到响应
+    qint64 checkedAt = 0;   // 得出结论的时间（毫秒，UTC），0 表示从未得出结论
+    QByteArray etag;        // 条件请求用的校验字段
+    QByteArray lastModified;
+};
+
+// --- 失效图片链接扫描 ---
+// 在后台对产品和案例的所有图片地址发 HEAD 请求，找出已被删除或不存在的文件：
+//   - 结果按地址缓存在本地（links_cache.json），有效期内（links/ttlHours，默认 24 小时）的地址不再请求，
+//     重复扫描是增量的；过期的地址带上 ETag / Last-Modified 发条件请求，没变时服务器只回 304
+//   - 并发有上限（links/maxConcurrent，默认 32），每个主机还有单独的并发上限（links/perHostConcurrent，默认 4）
+//     和令牌桶限速（links/perHostPerSecond，默认 50 次/秒）。同一主机的连接不会被扫描占满，
+//     保存、上传等交互请求不用排在几千个检查后面
+//   - 请求走网络线程，结果合并后每 200 ms 最多通知一次界面
+// 404/410 等 4xx 视为失效；5xx、429 和网络错误只是暂时查不到，不下结论也不缓存。
+// 不支持 HEAD 的服务器（405/501）改用只取 1 个字节的 GET。
+class LinkChecker : public QObject
+{
+    Q_OBJECT
+
+public:
+    static LinkChecker *instance();
+
+    // 扫描快照中所有产品和案例的图片；短时间内多次调用（例如连续几次同步）只扫描最后一次
+    void scanCatalog(const Snapshot &snapshot);
+    // 立即扫描给定的地址；正在排队的旧地址被替换，已经发出的请求照常完成
+    void scan(const QStringList &urls);
+    void cancel();
+    bool isRunning() const { return m_total > 0; }
+
+    LinkStatus status(const QString &url) const { return m_cache.value(url); }
+    bool isBroken(const QString &url) const { return m_cache.value(url).state == LinkStatus::Broken; }
+    // urls 中已确认失效的地址
+    QStringList brokenUrls(const QStringList &urls) const;
+
+signals:
+    void progress(int done, int total);
+    // 有地址的结论发生了变化（合并通知）
+    void resultsChanged();
+    void scanFinished(int checked, int broken, qint64 elapsedMs);
+
+private:
+    explicit LinkChecker(QObject *parent = nullptr);
+
+    struct Host {
+        QQueue<QString> waiting;
+        int inFlight = 0;
+        double tokens = 0;
+        qint64 refilledAt = 0; // m_clock 毫秒
+    };
+
+    static bool isCheckable(const QString &url);
+    bool isFresh(const LinkStatus &status, qint64 now) const;
+    void pump();
+    void check(const QString &url, bool rangedGet, quint64 generation);
+    void onResult(const QString &url, bool rangedGet, quint64 generation, const NetworkResult &result);
+    void finish();
+    void load();
+    void save();
+    static QString cacheFilePath();
+
+    int m_maxConcurrent = 32;
+    int m_perHostConcurrent = 4;
+    double m_perHostPerSecond = 50;
+    qint64 m_ttlMs = 0;
+
+    bool m_loaded = false;
+    QHash<QString, LinkStatus> m_cache;
+    QHash<QString, Host> m_hosts;
+    QStringList m_hostOrder; // 轮流从各主机取地址
+    int m_nextHost = 0;
+    int m_inFlight = 0;
+    quint64 m_generation = 0; // 每轮扫描加一，取消之前发出的请求不计入新的一轮
+    QStringList m_scanUrls;   // 本轮涉及的全部地址（包括缓存中还有效的）
+    int m_total = 0;          // 本轮需要请求的地址数
+    int m_done = 0;
+    bool m_changed = false;   // 有结论变化，尚未通知
+    QElapsedTimer m_clock;    // 令牌桶计时
+    QElapsedTimer m_elapsed;  // 本轮耗时
+    QStringList m_scheduled;  // scanCatalog 延迟启动时要扫描的地址
+    QTimer *m_startTimer;
+    QTimer *m_pumpTimer;      // 令牌不足时等到下一个令牌
+    QTimer *m_notifyTimer;
+};
+
+#endif // LINKCHECKER_H
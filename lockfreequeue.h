@@ -0,0 +1,64 @@
+// lockfreequeue.h
+#ifndef LOCKFREEQUEUE_H
+#define LOCKFREEQUEUE_H
+
+#include <atomic>
+#include <utility>
+
+// --- 无锁队列（多生产者、单消费者）---
+// 生产者只做一次原子交换把节点挂到队尾，消费者独占队头，双方都不会阻塞对方。
+// 用于网络线程把已经解码好的结果交给界面线程：网络线程从不等待界面线程，
+// 界面线程在每一帧统一取走所有结果。T 需要可默认构造（队列里始终有一个哨兵节点）。
+template <typename T>
+class LockFreeQueue
+{
+public:
+    LockFreeQueue()
+    {
+        Node *stub = new Node;
+        m_head.store(stub, std::memory_order_relaxed);
+        m_tail = stub;
+    }
+
+    ~LockFreeQueue()
+    {
+        T discarded;
+        while (tryPop(discarded)) {}
+        delete m_tail;
+    }
+
+    LockFreeQueue(const LockFreeQueue &) = delete;
+    LockFreeQueue &operator=(const LockFreeQueue &) = delete;
+
+    // 任意线程
+    void push(T value)
+    {
+        Node *node = new Node;
+        node->value = std::move(value);
+        Node *previous = m_head.exchange(node, std::memory_order_acq_rel);
+        previous->next.store(node, std::memory_order_release);
+    }
+
+    // 只能在消费者线程调用；队列为空（或生产者尚未挂上节点）时返回 false
+    bool tryPop(T &out)
+    {
+        Node *tail = m_tail;
+        Node *next = tail->next.load(std::memory_order_acquire);
+        if (!next) return false;
+        out = std::move(next->value);
+        m_tail = next; // next 成为新的哨兵
+        delete tail;
+        return true;
+    }
+
+private:
+    struct Node {
+        std::atomic<Node *> next{nullptr};
+        T value;
+    };
+
+    std::atomic<Node *> m_head; // 最近入队的节点（生产者一侧）
+    Node *m_tail;               // 哨兵节点（消费者一侧）
+};
+
+#endif // LOCKFREEQUEUE_H
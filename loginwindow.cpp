@@ -1,6 +1,11 @@
 // loginwindow.cpp
 #include "loginwindow.h"
 #include "ui_loginwindow.h"
+#include "startuptrace.h"
+#include "networksession.h"
+#include "tracelog.h"
+#include "syncbootstrap.h"
+#include "siteregistry.h"
 
 // 引入所有需要的Qt类
 #include <QNetworkAccessManager>
@@ -12,6 +17,7 @@
 #include <QJsonObject>
 #include <QMessageBox>
 #include <QInputDialog>
+#include <QShowEvent>
 
 LoginWindow::LoginWindow(QWidget *parent) :
     QDialog(parent),
@@ -26,6 +32,21 @@ LoginWindow::LoginWindow(QWidget *parent) :
     // 2. 连接网络请求完成的信号到我们的处理槽函数上
     //    一旦网络请求有任何结果返回，onLoginReply函数就会被自动调用
     connect(m_networkManager, &QNetworkAccessManager::finished, this, &LoginWindow::onLoginReply);
+    NetworkSession::attach(m_networkManager);
+
+    // 3. 用户输入密码期间，提前完成与服务器的TCP和TLS握手，登录请求可以直接复用这条连接
+    NetworkSession::prewarm(m_networkManager);
+
+    // 4. 登录到哪个网站；只登记了一个网站时不显示选择框
+    const QList<Site> sites = SiteRegistry::instance()->sites();
+    const QString currentId = SiteRegistry::instance()->currentSiteId();
+    ui->siteComboBox->blockSignals(true);
+    for (const Site &site : sites) {
+        ui->siteComboBox->addItem(site.name, site.id);
+        if (site.id == currentId) ui->siteComboBox->setCurrentIndex(ui->siteComboBox->count() - 1);
+    }
+    ui->siteComboBox->blockSignals(false);
+    ui->siteComboBox->setVisible(sites.size() > 1);
 
     // 我们可以直接在UI设计器里将按钮的clicked()信号连接到on_passwordInputButton_clicked()槽
     // 如果没有，也可以在这里手动连接
@@ -37,6 +58,12 @@ LoginWindow::~LoginWindow()
     delete ui;
 }
 
+void LoginWindow::showEvent(QShowEvent *event)
+{
+    QDialog::showEvent(event);
+    StartupTrace::mark(StartupTrace::LoginShown);
+}
+
 // 当“登录”按钮被点击时，此函数被触发
 void LoginWindow::on_passwordInputButton_clicked()
 {
@@ -49,11 +76,11 @@ void LoginWindow::on_passwordInputButton_clicked()
     // 禁用UI，防止用户在等待时重复点击，并给出提示
     ui->passwordInputLine->setEnabled(false);
     ui->passwordInputButton->setEnabled(false);
+    ui->siteComboBox->setEnabled(false);
     ui->noticeTxt->setText("正在登录，请稍候...");
 
     // --- 准备网络请求 ---
-    QUrl url("https://tianyuhuanbao.com/api.php");
-    QNetworkRequest request(url);
+    QNetworkRequest request = NetworkSession::apiRequest();
 
     // 设置请求头，表明我们发送的是表单数据
     request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
@@ -62,17 +89,36 @@ void LoginWindow::on_passwordInputButton_clicked()
     QUrlQuery postData;
     postData.addQueryItem("action", "login");
     postData.addQueryItem("password", password);
+    // 请服务器把首批数据直接放进登录响应；不支持的服务器会忽略这个参数，客户端随后单独拉取
+    postData.addQueryItem("include_data", "1");
+    // 按记录加锁，允许多个管理员同时登录；老版本服务器会忽略这个参数，仍使用全局锁
+    postData.addQueryItem("lock_mode", "record");
 
     // 发送POST请求
+    m_loginStartedAt = TraceLog::now();
     m_networkManager->post(request, postData.query(QUrl::FullyEncoded).toUtf8());
 }
 
 // 当服务器返回响应时，此函数被自动调用
 void LoginWindow::onLoginReply(QNetworkReply *reply)
 {
+    // 预连接完成时也会走到这里，它不是登录响应，直接忽略
+    if (NetworkSession::isPrewarmReply(reply)) {
+        reply->deleteLater();
+        return;
+    }
+
+    // 时间线：从点击登录到收到响应
+    if (m_loginStartedAt >= 0) {
+        TraceLog::async("ui", "login", 1, m_loginStartedAt, TraceLog::now(),
+                        reply->error() == QNetworkReply::NoError ? QString() : reply->errorString());
+        m_loginStartedAt = -1;
+    }
+
     // 恢复UI
     ui->passwordInputLine->setEnabled(true);
     ui->passwordInputButton->setEnabled(true);
+    ui->siteComboBox->setEnabled(true);
     ui->noticeTxt->setText("请输入密码");
 
     if (reply->error() != QNetworkReply::NoError) {
@@ -96,8 +142,13 @@ void LoginWindow::onLoginReply(QNetworkReply *reply)
         // --- 核心修正：增加对 session_key 的判断 ---
         if (obj.contains("session_key")) {
             // 如果包含 session_key，这一定是一次成功的“登录”响应
+            StartupTrace::mark(StartupTrace::LoginReply);
             m_sessionKey = obj["session_key"].toString();
             m_username = obj["username"].toString();
+            SiteRegistry::instance()->setSessionKey(SiteRegistry::instance()->currentSiteId(), m_sessionKey);
+            // 趁提示框显示、主窗口构造的这段时间把数据取回来
+            if (obj["data"].isObject()) SyncBootstrap::instance()->adopt(obj["data"].toObject());
+            else SyncBootstrap::instance()->start();
             QMessageBox::information(this, "登录成功", "欢迎回来, " + m_username + "！");
             accept(); // 关闭对话框，通知main.cpp成功
         } else {
@@ -112,6 +163,13 @@ void LoginWindow::onLoginReply(QNetworkReply *reply)
     reply->deleteLater();
 }
 
+// 切换网站后，所有模块的请求都指向新网站；重新预连接
+void LoginWindow::on_siteComboBox_currentIndexChanged(int index)
+{
+    SiteRegistry::instance()->setCurrentSite(ui->siteComboBox->itemData(index).toString());
+    NetworkSession::prewarm(m_networkManager);
+}
+
 // 这两个函数让 main.cpp 可以在登录成功后获取到密钥和用户名
 QString LoginWindow::sessionKey() const
 {
@@ -136,8 +194,7 @@ void LoginWindow::on_forceLogoutButton_clicked()
         // 用户输入了密码并点击了OK
         ui->noticeTxt->setText("正在发送强制清除请求...");
 
-        QUrl url("https://tianyuhuanbao.com/api.php"); // 您的API地址
-        QNetworkRequest request(url);
+        QNetworkRequest request = NetworkSession::apiRequest();
         request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
 
         QUrlQuery postData;
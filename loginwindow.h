@@ -7,6 +7,7 @@
 // 向前声明，避免在头文件中引入过多的头文件
 class QNetworkAccessManager;
 class QNetworkReply;
+class QShowEvent;
 
 namespace Ui {
 class LoginWindow;
@@ -24,9 +25,13 @@ public:
     QString sessionKey() const;
     QString username() const;
 
+protected:
+    void showEvent(QShowEvent *event) override;
+
 private slots:
     void on_passwordInputButton_clicked();
     void on_forceLogoutButton_clicked();
+    void on_siteComboBox_currentIndexChanged(int index);
     void onLoginReply(QNetworkReply *reply);
 
 private:
@@ -36,6 +41,9 @@ private:
     // 用于存储登录成功后从服务器获取的信息
     QString m_sessionKey;
     QString m_username;
+
+    // 点击“登录”的时刻（TraceLog 微秒），-1 表示没有进行中的登录
+    qint64 m_loginStartedAt = -1;
 };
 
 #endif // LOGINWINDOW_H
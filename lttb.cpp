@@ -0,0 +1,61 @@
+// lttb.cpp
+#include "lttb.h"
+
+#include <cmath>
+
+namespace Lttb {
+
+QList<QPointF> downsample(const QList<QPointF> &data, int threshold)
+{
+    const int n = data.size();
+    if (threshold < 3 || n <= threshold) return data;
+
+    QList<QPointF> sampled;
+    sampled.reserve(threshold);
+    sampled.append(data.first());
+
+    // 首尾两点之外的 n - 2 个点平均分到 threshold - 2 个桶里
+    const double bucketSize = double(n - 2) / (threshold - 2);
+    int selected = 0; // 上一个选中点的下标
+
+    for (int bucket = 0; bucket < threshold - 2; ++bucket) {
+        // 下一个桶的平均点（最后一个桶的“下一个桶”就是末点）
+        const int nextStart = int(std::floor((bucket + 1) * bucketSize)) + 1;
+        const int nextEnd = qMin(int(std::floor((bucket + 2) * bucketSize)) + 1, n);
+        double avgX = 0, avgY = 0;
+        for (int i = nextStart; i < nextEnd; ++i) {
+            avgX += data[i].x();
+            avgY += data[i].y();
+        }
+        const int nextCount = nextEnd - nextStart;
+        if (nextCount > 0) {
+            avgX /= nextCount;
+            avgY /= nextCount;
+        } else {
+            avgX = data.last().x();
+            avgY = data.last().y();
+        }
+
+        // 当前桶里与 (上一个选中点, 下一个桶的平均点) 构成最大三角形的点
+        const int start = int(std::floor(bucket * bucketSize)) + 1;
+        const int end = int(std::floor((bucket + 1) * bucketSize)) + 1;
+        const QPointF a = data[selected];
+        double maxArea = -1;
+        int maxIndex = start;
+        for (int i = start; i < end; ++i) {
+            const double area = std::abs((a.x() - avgX) * (data[i].y() - a.y())
+                                         - (a.x() - data[i].x()) * (avgY - a.y()));
+            if (area > maxArea) {
+                maxArea = area;
+                maxIndex = i;
+            }
+        }
+        sampled.append(data[maxIndex]);
+        selected = maxIndex;
+    }
+
+    sampled.append(data.last());
+    return sampled;
+}
+
+} // namespace Lttb
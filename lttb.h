@@ -0,0 +1,20 @@
+// lttb.h
+#ifndef LTTB_H
+#define LTTB_H
+
+#include <QList>
+#include <QPointF>
+
+// --- LTTB（Largest-Triangle-Three-Buckets）降采样 ---
+// 把按 x 升序排列的折线缩减到 threshold 个点，同时保留峰值、谷值等视觉特征：
+// 首尾两点原样保留，中间按 x 顺序分成 threshold - 2 个桶，每个桶选出与
+// “上一个选中点”和“下一个桶的平均点”构成的三角形面积最大的那个点。
+// 时间复杂度 O(n)，输出点数只取决于 threshold（通常就是绘图区的像素宽度）。
+namespace Lttb {
+
+// data 的点数不超过 threshold（或 threshold < 3）时原样返回
+QList<QPointF> downsample(const QList<QPointF> &data, int threshold);
+
+} // namespace Lttb
+
+#endif // LTTB_H
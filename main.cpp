@@ -1,11 +1,18 @@
 // main.cpp
 #include "mainwindow.h"
 #include "loginwindow.h" // 您的登录窗口类名可能是 LoginDialog，请按需修改
-#include <QApplication>
+#include "startuptrace.h"
+#include "stallwatchdog.h"
+#include "hrapplication.h"
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
+    StartupTrace::begin(); // 启动计时，尽量靠前
+    HRApplication a(argc, argv);
+    // QSettings 依赖这两个名称来确定本地配置的存放位置
+    a.setOrganizationName("tianyuhuanbao");
+    a.setApplicationName("HRWindow");
+    StallWatchdog::instance()->start(); // 读取阈值需要上面的 QSettings 名称
 
     LoginWindow loginDialog; // 使用您自己的类名 LoginWindow 或 LoginDialog
     if (loginDialog.exec() == QDialog::Accepted) {
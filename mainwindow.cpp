@@ -7,10 +7,25 @@
 #include "casemanager.h"
 #include "dashboardmanager.h"
 #include "datastructures.h"
+#include "datastore.h"
+#include "dataserializer.h"
+#include "startuptrace.h"
+#include "networksession.h"
+#include "networkthread.h"
+#include "shutdowncoordinator.h"
+#include "mutationqueue.h"
+#include "stallwatchdog.h"
+#include "diagnosticsdialog.h"
+#include "jsonbackend.h"
+#include "syncbootstrap.h"
+#include "metricshistory.h"
+#include "recordlocks.h"
+#include "linkchecker.h"
+#include "revisionhistory.h"
+#include "revisionhistorydialog.h"
 
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
-#include <QNetworkReply>
 #include <QUrl>
 #include <QUrlQuery>
 #include <QJsonDocument>
@@ -18,6 +33,12 @@
 #include <QJsonArray>
 #include <QMessageBox>
 #include <QCloseEvent>
+#include <QSettings>
+#include <QTimer>
+#include <QVBoxLayout>
+#include <QLabel>
+#include <QShortcut>
+#include <QPushButton>
 
 MainWindow::MainWindow(const QString &username, const QString &sessionKey, QWidget *parent)
     : QMainWindow(parent)
@@ -27,22 +48,81 @@ MainWindow::MainWindow(const QString &username, const QString &sessionKey, QWidg
     ui->setupUi(this);
     setWindowTitle("网站内容管理系统 v3.0 - 欢迎您, " + username);
 
-    m_networkManager = new QNetworkAccessManager(this);
-    connect(m_networkManager, &QNetworkAccessManager::finished, this, &MainWindow::onServerReply);
+    // 只创建空的占位页，各管理面板的 setupUi 推迟到首次显示时再执行，
+    // 这样主窗口可以尽快完成第一次绘制
+    const char *tabTitles[TabCount] = { "数据中心", "招聘管理", "产品管理", "案例管理" };
+    for (int i = 0; i < TabCount; ++i) {
+        m_tabPages[i] = new QWidget(ui->tabWidget);
+        auto *layout = new QVBoxLayout(m_tabPages[i]);
+        layout->setContentsMargins(0, 0, 0, 0);
+        ui->tabWidget->addTab(m_tabPages[i], tabTitles[i]);
+    }
+
+    // 预热顺序：上次关闭时停留的标签页优先，其余按界面顺序
+    const int lastTab = QSettings().value("ui/lastTab", JobTab).toInt();
+    if (lastTab > DashboardTab && lastTab < TabCount) m_prewarmQueue.append(lastTab);
+    for (int i = JobTab; i < TabCount; ++i) {
+        if (!m_prewarmQueue.contains(i)) m_prewarmQueue.append(i);
+    }
+
+    // 数据中心是启动后第一个看到的页面，直接创建
+    ensureTab(DashboardTab);
+    ui->tabWidget->setCurrentIndex(DashboardTab);
+    connect(ui->tabWidget, &QTabWidget::currentChanged, this, &MainWindow::onTabChanged);
+
+    // 监听第一次绘制，绘制完成后再利用空闲时间预热其它标签页
+    ui->tabWidget->installEventFilter(this);
 
-    m_dashboardManager = new DashboardManager(this);
-    m_jobManager = new JobManager(m_sessionKey, this);
-    m_productManager = new ProductManager(m_sessionKey, this);
-    m_caseManager = new CaseManager(m_sessionKey, this);
+    // 离线队列：状态栏显示待同步数量，重放完成后重新拉取服务器数据
+    m_queueStatusLabel = new QLabel(this);
+    ui->statusbar->addPermanentWidget(m_queueStatusLabel);
+    auto *queue = MutationQueue::instance();
+    connect(queue, &MutationQueue::pendingCountChanged, this, &MainWindow::updateQueueStatus);
+    connect(queue, &MutationQueue::offlineChanged, this, &MainWindow::updateQueueStatus);
+    connect(queue, &MutationQueue::heldChanged, this, &MainWindow::updateQueueStatus);
+    // 多次同步失败的修改在状态栏给出链接，点开查看原因并选择重试或放弃
+    connect(m_queueStatusLabel, &QLabel::linkActivated, this, &MainWindow::showHeldMutations);
+    connect(queue, &MutationQueue::replayFinished, this, &MainWindow::refreshAllData);
+    connect(queue, &MutationQueue::replayError, this, [this](const QString &message) {
+        ui->statusbar->showMessage(message, 5000);
+    });
+    queue->setSessionKey(m_sessionKey);
+    updateQueueStatus();
 
-    ui->tabWidget->insertTab(0, m_dashboardManager, "数据中心");
-    ui->tabWidget->addTab(m_jobManager, "招聘管理");
-    ui->tabWidget->addTab(m_productManager, "产品管理");
-    ui->tabWidget->addTab(m_caseManager, "案例管理");
+    // 记录级编辑锁：开始按心跳续租，各管理模块选中记录时申请
+    RecordLocks::instance()->setSessionKey(m_sessionKey);
 
-    connect(m_dashboardManager, &DashboardManager::requestRefreshAllData, this, &MainWindow::refreshAllData);
+    // 每次同步到新的产品或案例数据后，在后台检查图片链接（有效期内的结果直接用缓存）
+    connect(DataStore::instance(), &DataStore::dataReset, this,
+            [](SnapshotPtr snapshot, DataStore::Sections sections) {
+        if (sections & (DataStore::Products | DataStore::Cases)) LinkChecker::instance()->scanCatalog(*snapshot);
+    });
 
-    refreshAllData();
+    // 每次同步和保存都在本地留一个历史版本，可以浏览、对比和恢复
+    RevisionHistory::instance()->startRecording();
+    auto *historyShortcut = new QShortcut(QKeySequence("Ctrl+Shift+H"), this);
+    connect(historyShortcut, &QShortcut::activated, this, &MainWindow::showRevisionHistory);
+
+    // 性能诊断窗口（界面卡顿统计），现场排查时使用
+    auto *diagnosticsShortcut = new QShortcut(QKeySequence("Ctrl+Shift+D"), this);
+    connect(diagnosticsShortcut, &QShortcut::activated, this, &MainWindow::showDiagnostics);
+
+    // 首批数据在登录成功时就已经开始拉取（或随登录响应一起返回），与主窗口的构造同时进行；
+    // 这里只需等它完成。拉取失败时改走常规同步，由 onSyncReply 报告错误或进入离线模式
+    auto *bootstrap = SyncBootstrap::instance();
+    switch (bootstrap->state()) {
+    case SyncBootstrap::State::Ready:
+        onSyncApplied();
+        break;
+    case SyncBootstrap::State::Fetching:
+        ui->statusbar->showMessage("正在从服务器同步所有数据...");
+        connect(bootstrap, &SyncBootstrap::ready, this, &MainWindow::onSyncApplied);
+        connect(bootstrap, &SyncBootstrap::failed, this, &MainWindow::refreshAllData);
+        break;
+    default:
+        refreshAllData();
+        break;
+    }
 }
 
 MainWindow::~MainWindow()
@@ -50,163 +130,258 @@ MainWindow::~MainWindow()
     delete ui;
 }
 
+bool MainWindow::eventFilter(QObject *watched, QEvent *event)
+{
+    if (watched == ui->tabWidget && event->type() == QEvent::Paint) {
+        ui->tabWidget->removeEventFilter(this);
+        StartupTrace::mark(StartupTrace::MainWindowPaint);
+        // 零间隔定时器会在事件队列空闲时才触发，不会与首帧绘制抢时间
+        QTimer::singleShot(0, this, &MainWindow::prewarmNextTab);
+    }
+    return QMainWindow::eventFilter(watched, event);
+}
+
+void MainWindow::onTabChanged(int index)
+{
+    ensureTab(index);
+    QSettings().setValue("ui/lastTab", index);
+}
+
+// 每次空闲只预热一个标签页，避免一次性占用事件循环太久
+void MainWindow::prewarmNextTab()
+{
+    while (!m_prewarmQueue.isEmpty()) {
+        const int index = m_prewarmQueue.takeFirst();
+        if (m_tabPages[index]->layout()->count() > 0) continue; // 已经被用户打开过
+        ensureTab(index);
+        break;
+    }
+    if (!m_prewarmQueue.isEmpty())
+        QTimer::singleShot(0, this, &MainWindow::prewarmNextTab);
+}
+
+void MainWindow::ensureTab(int index)
+{
+    if (index < 0 || index >= TabCount) return;
+
+    QWidget *page = m_tabPages[index];
+    QWidget *panel = nullptr;
+    switch (index) {
+    case DashboardTab:
+        if (m_dashboardManager) return;
+        m_dashboardManager = new DashboardManager(page);
+        connect(m_dashboardManager, &DashboardManager::requestRefreshAllData, this, &MainWindow::refreshAllData);
+        panel = m_dashboardManager;
+        break;
+    case JobTab:
+        if (m_jobManager) return;
+        m_jobManager = new JobManager(m_sessionKey, page);
+        panel = m_jobManager;
+        break;
+    case ProductTab:
+        if (m_productManager) return;
+        m_productManager = new ProductManager(m_sessionKey, page);
+        panel = m_productManager;
+        break;
+    case CaseTab:
+        if (m_caseManager) return;
+        m_caseManager = new CaseManager(m_sessionKey, page);
+        panel = m_caseManager;
+        break;
+    }
+
+    // 面板创建时直接从 DataStore 的当前快照取数据，这里不再需要补发
+    page->layout()->addWidget(panel);
+}
+
+void MainWindow::restoreLeftoverWork()
+{
+    const QList<QJsonObject> leftovers = ShutdownCoordinator::takeLeftoverWork();
+    for (const QJsonObject &item : leftovers) {
+        const QString kind = item["kind"].toString();
+        const QJsonObject state = item["state"].toObject();
+        if (kind == "jobs") {
+            ensureTab(JobTab);
+            m_jobManager->restoreUnfinishedWork(state);
+        } else if (kind == "products") {
+            ensureTab(ProductTab);
+            m_productManager->restoreUnfinishedWork(state);
+        }
+    }
+    if (!leftovers.isEmpty())
+        ui->statusbar->showMessage(QString("已恢复 %1 项上次退出时未完成的工作").arg(leftovers.size()), 5000);
+}
+
+void MainWindow::showDiagnostics()
+{
+    if (!m_diagnosticsDialog) m_diagnosticsDialog = new DiagnosticsDialog(this);
+    m_diagnosticsDialog->show();
+    m_diagnosticsDialog->raise();
+    m_diagnosticsDialog->activateWindow();
+}
+
+void MainWindow::showRevisionHistory()
+{
+    if (!m_revisionDialog) m_revisionDialog = new RevisionHistoryDialog(this);
+    m_revisionDialog->show();
+    m_revisionDialog->raise();
+    m_revisionDialog->activateWindow();
+}
+
+void MainWindow::updateQueueStatus()
+{
+    auto *queue = MutationQueue::instance();
+    QString text;
+    if (queue->isOffline()) text = "离线模式";
+    if (queue->pendingCount() > 0) {
+        if (!text.isEmpty()) text += " · ";
+        text += QString("%1 项修改待同步").arg(queue->pendingCount());
+    }
+    if (queue->heldCount() > 0)
+        text += QString(" · <a href=\"held\">%1 项同步失败</a>").arg(queue->heldCount());
+    m_queueStatusLabel->setText(text);
+    m_queueStatusLabel->setVisible(!text.isEmpty());
+}
+
+void MainWindow::showHeldMutations()
+{
+    auto *queue = MutationQueue::instance();
+    const QList<MutationQueue::HeldEntry> held = queue->heldEntries();
+    if (held.isEmpty()) return;
+
+    QStringList lines;
+    for (const auto &entry : held)
+        lines.append(QString("%1（已尝试 %2 次）：%3").arg(MutationQueue::describe(entry.action)).arg(entry.attempts).arg(entry.lastError));
+
+    QMessageBox box(QMessageBox::Warning, "同步失败",
+                    QString("以下 %1 项修改多次同步失败，已暂停自动同步。").arg(held.size()), QMessageBox::Cancel, this);
+    box.setInformativeText(lines.join("\n"));
+    QPushButton *retryButton = box.addButton("重试", QMessageBox::AcceptRole);
+    QPushButton *discardButton = box.addButton("放弃这些修改", QMessageBox::DestructiveRole);
+    box.exec();
+
+    if (box.clickedButton() == retryButton) {
+        queue->retryHeld();
+    } else if (box.clickedButton() == discardButton) {
+        for (const auto &entry : held) queue->discard(entry.id);
+        refreshAllData();
+    }
+}
+
 void MainWindow::refreshAllData()
 {
     ui->statusbar->showMessage("正在从服务器同步所有数据...");
-    QUrl url("https://tianyuhuanbao.com/api.php?action=get_all_data");
-    QNetworkRequest request(url);
-    m_networkManager->get(request);
+    // 在网络线程上收取，界面线程被模态对话框占住时下载照常进行
+    NetworkThread::instance()->submit("get_all_data",
+        [](QNetworkAccessManager *manager) {
+            QNetworkRequest request = NetworkSession::apiRequest("get_all_data");
+            request.setAttribute(QNetworkRequest::User, "get_all_data");
+            request.setAttribute(NetworkThread::RawBodyAttribute, true);
+            return manager->get(request);
+        },
+        this, [this](const NetworkResult &result) { onSyncReply(result); });
 }
 
 // --- [核心升级] 增加了详细的调试输出和健壮性检查 ---
-void MainWindow::onServerReply(QNetworkReply *reply)
+void MainWindow::onSyncReply(const NetworkResult &result)
 {
-    qDebug() << "--- onServerReply triggered ---";
+    StallWatchdog::Scope stallScope("MainWindow::onSyncReply");
+    qDebug() << "--- onSyncReply triggered ---";
 
-    if (reply->error() != QNetworkReply::NoError) {
-        qDebug() << "Network Error:" << reply->errorString();
-        QMessageBox::critical(this, "网络错误", "请求失败: " + reply->errorString());
+    if (NetworkSession::isConnectivityError(result.error)) {
+        // 连不上服务器：进入离线模式，本地修改会进入离线队列，不再弹框打断
+        qDebug() << "Network unreachable:" << result.errorString;
+        MutationQueue::instance()->reportOffline();
+        ui->statusbar->showMessage("网络不可用，已进入离线模式，恢复连接后会自动同步");
+        return;
+    }
+
+    if (!result.ok()) {
+        qDebug() << "Network Error:" << result.errorString;
+        QMessageBox::critical(this, "网络错误", "请求失败: " + result.errorString);
         ui->statusbar->showMessage("网络错误！");
-        reply->deleteLater();
         return;
     }
 
-    QByteArray responseData = reply->readAll();
+    const QByteArray &responseData = result.body;
     // 我们不再打印完整的原始数据，因为它太长了
     qDebug() << "Received" << responseData.size() << "bytes from server.";
 
-    QJsonDocument doc = QJsonDocument::fromJson(responseData);
-    if (doc.isNull() || !doc.isObject()) {
-        qDebug() << "JSON parsing failed: Document is null or not an object.";
+    // 解析方式由 JsonBackend 决定（simdjson 或 Qt），结果已经是数据结构
+    const SyncResponse response = JsonBackend::active().parse(responseData);
+    if (!response.isValid()) {
+        qDebug() << "JSON parsing failed:" << response.parseError;
         QMessageBox::critical(this, "数据格式错误", "服务器返回的数据不是有效的JSON对象。");
         ui->statusbar->showMessage("数据格式错误！");
-        reply->deleteLater();
         return;
     }
 
-    QJsonObject rootObj = doc.object();
-    if (rootObj["status"].toString() != "success") {
-        QString errorMessage = rootObj["message"].toString("未知错误");
+    if (response.status != "success") {
+        QString errorMessage = response.message.isEmpty() ? QString("未知错误") : response.message;
         qDebug() << "API Error:" << errorMessage;
         QMessageBox::critical(this, "API错误", "获取数据失败: " + errorMessage);
         ui->statusbar->showMessage("API返回错误！");
-        reply->deleteLater();
         return;
     }
 
     qDebug() << "API status is success. Starting data parsing...";
 
     // --- 关键诊断区 ---
-    if (!rootObj.contains("data") || !rootObj["data"].isObject()) {
+    if (!response.hasData) {
         qDebug() << "CRITICAL ERROR: 'data' field is missing or is not an object!";
         ui->statusbar->showMessage("数据结构错误：缺少 'data' 对象。");
-        reply->deleteLater();
         return;
     }
-    QJsonObject data = rootObj["data"].toObject();
-
-    // 检查 'jobs' 字段
-    if (!data.contains("jobs")) {
-        qDebug() << "CRITICAL ERROR: 'jobs' field is missing in 'data' object!";
-    } else {
-        QJsonValue jobsValue = data.value("jobs");
-        qDebug() << "'jobs' field found. Its type is:" << jobsValue.type()
-                 << "(Note: Array is type 4)";
-
-        if (jobsValue.isArray()) {
-            QList<Job> jobs;
-            QJsonArray jobsArray = jobsValue.toArray();
-            qDebug() << "Successfully parsed 'jobs' as an array. Size:" << jobsArray.size();
-
-            for (const QJsonValue &value : jobsArray) {
-                // ... (解析单个Job的逻辑) ...
-                if (value.isObject()){
-                    QJsonObject jobObj = value.toObject();
-                    Job currentJob;
-                    currentJob.title = jobObj["title"].toString();
-                    currentJob.title       = jobObj["title"].toString();
-                    currentJob.quota       = jobObj["quota"].toString();
-                    currentJob.salaryStart = jobObj["salaryStart"].toString();
-                    currentJob.salaryEnd   = jobObj["salaryEnd"].toString();
-                    currentJob.requirements= jobObj["requirements"].toString();
-                    jobs.append(currentJob);
-                }
-            }
-            m_jobManager->updateData(jobs);
-            qDebug() << "Jobs data updated with" << jobs.count() << "items.";
-        } else {
-            qDebug() << "ERROR: 'jobs' field is NOT an array!";
-        }
-    }
 
-    if (data.contains("products") && data["products"].isArray()) {
-        QList<Product> products;
-        QJsonArray productsArray = data["products"].toArray();
-        for (const QJsonValue &value : productsArray) {
-            QJsonObject productObj = value.toObject();
-            Product currentProduct;
-            currentProduct.name = productObj["name"].toString();
-            currentProduct.category = productObj["category"].toString();
-            currentProduct.description = productObj["description"].toString();
-            // 将JSON数组转换为QStringList
-            QJsonArray urlsArray = productObj["imageUrls"].toArray();
-            for(const QJsonValue& urlVal : urlsArray) {
-                currentProduct.imageUrls.append(urlVal.toString());
-            }
-            products.append(currentProduct);
-        }
-        m_productManager->updateData(products); // 调用ProductManager的入口函数
-    }
+    // 各部分合并成一个快照版本发布；已创建的面板通过 dataReset 信号刷新，
+    // 未创建的面板在创建时读取当前快照
+    const SyncData &sync = response.data;
+    if (!sync.hasJobs) qDebug() << "ERROR: 'jobs' field is missing or is NOT an array!";
+    qDebug() << "Parsed" << sync.jobs.count() << "jobs and" << sync.products.count() << "products.";
+    DataStore::instance()->resetFromSync(sync);
+    onSyncApplied();
 
-    if (data.contains("stats") && data["stats"].isObject()) {
-        DashboardStats stats;
-        QJsonObject statsObj = data["stats"].toObject();
-        stats.totalJobsCount = statsObj["total_jobs_count"].toInt();
-        stats.totalProductsCount = statsObj["total_products_count"].toInt();
-        stats.totalCasesCount = statsObj["total_cases_count"].toInt();
-        stats.totalRecruitmentQuota = statsObj["total_recruitment_quota"].toInt();
-        stats.serverTime = statsObj["server_time"].toString();
-        m_dashboardManager->updateStats(stats); // 调用Dashboard的入口函数
-    }
+}
+
+void MainWindow::onSyncApplied()
+{
+    // 每次同步记录一条统计样本，供数据中心绘制历史趋势
+    const SnapshotPtr snapshot = DataStore::instance()->current();
+    if (snapshot->hasStats) MetricsHistory::instance()->append(snapshot->stats);
 
     ui->statusbar->showMessage("所有数据已同步！", 3000);
     qDebug() << "--- Sync finished ---";
+    StartupTrace::mark(StartupTrace::FirstDataApplied);
 
-    reply->deleteLater();
+    // 第一次同步完成后，再把上次退出时遗留的修改覆盖回去，避免被服务器数据冲掉
+    if (!m_leftoverRestored) {
+        m_leftoverRestored = true;
+        restoreLeftoverWork();
+    }
 }
 
 // --- 实现带登出请求的窗口关闭事件 ---
 void MainWindow::closeEvent(QCloseEvent *event)
 {
+    // 所有分支都先忽略关闭事件，真正的退出由 ShutdownCoordinator 在收尾后完成
+    event->ignore();
+
+    auto *coordinator = ShutdownCoordinator::instance();
+    if (coordinator->isShuttingDown()) return;
+
+    QString question = "您确定要退出吗？\n退出后您在服务器上的会话将被注销。";
+    if (coordinator->hasPendingWork())
+        question += "\n仍有正在进行的保存/上传，未能及时完成的修改会在下次启动时恢复。";
+
     QMessageBox::StandardButton resBtn = QMessageBox::question( this, "退出程序",
-                                                               "您确定要退出吗？\n退出后您在服务器上的会话将被注销。",
+                                                               question,
                                                                QMessageBox::Cancel | QMessageBox::Yes,
                                                                QMessageBox::Yes);
     if (resBtn == QMessageBox::Yes) {
-        // 用户确认退出
-
-        // 1. 我们先“假装”忽略关闭事件，阻止窗口立刻关闭
-        event->ignore();
         ui->statusbar->showMessage("正在安全登出...");
         setEnabled(false); // 禁用整个主窗口，防止用户在登出时进行其他操作
 
-        // 2. 将网络请求完成的信号，连接到整个应用程序的“退出”槽上
-        connect(m_networkManager, &QNetworkAccessManager::finished, qApp, &QCoreApplication::quit);
-
-        // 3. 现在，我们放心地发送登出请求
-        QUrl url("https://tianyuhuanbao.com/api.php");
-        QNetworkRequest request(url);
-        request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-
-        QUrlQuery postData;
-        postData.addQueryItem("action", "logout");
-        postData.addQueryItem("key", m_sessionKey);
-
-        m_networkManager->post(request, postData.query(QUrl::FullyEncoded).toUtf8());
-
-        // 程序现在会等待网络请求完成后，自动调用 qApp->quit() 来安全退出
-    } else {
-        // 用户点击了“取消”，则忽略关闭事件
-        event->ignore();
+        // 等待在途工作（有期限）、发送 logout，并在固定时间预算内退出
+        coordinator->shutdown(m_sessionKey);
     }
 }
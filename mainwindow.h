@@ -3,15 +3,20 @@
 #define MAINWINDOW_H
 
 #include <QMainWindow>
+#include <QList>
+#include <QPointer>
+#include "datastructures.h"
 
 // 向前声明，避免引入过多头文件
-class QNetworkAccessManager;
-class QNetworkReply;
 class QCloseEvent;
+class QLabel;
 class JobManager;         // 使用向前声明，而不是包含头文件
 class ProductManager;
 class CaseManager;
 class DashboardManager;
+class DiagnosticsDialog;
+class RevisionHistoryDialog;
+struct NetworkResult;
 
 QT_BEGIN_NAMESPACE
 namespace Ui { class MainWindow; }
@@ -27,21 +32,60 @@ public:
 
 protected:
     void closeEvent(QCloseEvent *event) override;
+    bool eventFilter(QObject *watched, QEvent *event) override;
 
 private slots:
-    void onServerReply(QNetworkReply *reply);
     void refreshAllData();
+    // 一次完整同步已经发布到 DataStore（来自 onSyncReply 或登录时的预取）
+    void onSyncApplied();
+
+    // 标签页懒加载
+    void onTabChanged(int index);
+    void prewarmNextTab();
+
+    // 离线队列状态
+    void updateQueueStatus();
+    // 查看多次同步失败的修改，重试或放弃
+    void showHeldMutations();
+
+    // 性能诊断窗口（Ctrl+Shift+D）
+    void showDiagnostics();
+    // 历史版本窗口（Ctrl+Shift+H）
+    void showRevisionHistory();
 
 private:
+    // 标签页的固定顺序，与 tabWidget 中的位置一一对应
+    enum TabIndex { DashboardTab = 0, JobTab, ProductTab, CaseTab, TabCount };
+
     Ui::MainWindow *ui;
-    QNetworkAccessManager *m_networkManager;
     QString m_sessionKey;
 
-    // 保存对各个管理面板的指针
-    JobManager* m_jobManager;
-    ProductManager* m_productManager;
-    CaseManager* m_caseManager;
-    DashboardManager* m_dashboardManager; // 新增Dashboard指针
+    // 保存对各个管理面板的指针（懒加载：首次显示前为 nullptr）
+    JobManager* m_jobManager = nullptr;
+    ProductManager* m_productManager = nullptr;
+    CaseManager* m_caseManager = nullptr;
+    DashboardManager* m_dashboardManager = nullptr; // 新增Dashboard指针
+
+    // 每个标签页先放一个空的占位页，真正的管理面板在首次显示时才创建
+    QWidget* m_tabPages[TabCount] = {};
+
+    // 空闲时预热的标签页队列（按用户最可能打开的顺序）
+    QList<int> m_prewarmQueue;
+
+    void ensureTab(int index);
+    // get_all_data 的响应（来自网络线程）
+    void onSyncReply(const NetworkResult &result);
+
+    // 状态栏右侧常驻的离线队列指示
+    QLabel *m_queueStatusLabel;
+
+    // 上次退出时未完成的保存，只在第一次同步成功后恢复一次
+    bool m_leftoverRestored = false;
+
+    // 关闭时自行销毁，再次打开时重新创建
+    QPointer<DiagnosticsDialog> m_diagnosticsDialog;
+    QPointer<RevisionHistoryDialog> m_revisionDialog;
+    void restoreLeftoverWork();
 };
 
 #endif // MAINWINDOW_H
@@ -0,0 +1,143 @@
+// metricshistory.cpp
+#include "metricshistory.h"
+#include "siteregistry.h"
+
+#include <QCoreApplication>
+#include <QDataStream>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+const char kMagic[4] = { 'H', 'R', 'M', 'S' };
+const qint32 kFormatVersion = 1;
+const int kHeaderSize = 8;
+const int kRecordSize = 24;
+
+qint32 valueOf(const MetricSample &sample, MetricsHistory::Metric metric)
+{
+    switch (metric) {
+    case MetricsHistory::Jobs:     return sample.jobs;
+    case MetricsHistory::Products: return sample.products;
+    case MetricsHistory::Cases:    return sample.cases;
+    case MetricsHistory::Quota:    return sample.quota;
+    default:                       return 0;
+    }
+}
+
+} // namespace
+
+MetricsHistory *MetricsHistory::instance()
+{
+    static MetricsHistory *history = new MetricsHistory(qApp);
+    return history;
+}
+
+MetricsHistory::MetricsHistory(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QString MetricsHistory::historyFilePath()
+{
+    return SiteRegistry::instance()->localDataPath("metrics_history.bin");
+}
+
+void MetricsHistory::load()
+{
+    if (m_loaded) return;
+    m_loaded = true;
+
+    // 样本属于载入时的站点，之后的样本也追加到同一个文件
+    m_filePath = historyFilePath();
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    const QByteArray header = file.read(kHeaderSize);
+    if (header.size() < kHeaderSize || !header.startsWith(QByteArray(kMagic, 4))) {
+        qDebug() << "Ignoring unrecognised metrics history file" << file.fileName();
+        return;
+    }
+
+    QDataStream in(&file);
+    in.setByteOrder(QDataStream::LittleEndian);
+    const qint64 count = (file.size() - kHeaderSize) / kRecordSize; // 不完整的尾部记录不读
+    m_samples.reserve(count);
+    for (qint64 i = 0; i < count; ++i) {
+        MetricSample s;
+        in >> s.time >> s.jobs >> s.products >> s.cases >> s.quota;
+        m_samples.append(s);
+    }
+}
+
+void MetricsHistory::append(const DashboardStats &stats)
+{
+    load();
+
+    MetricSample sample;
+    sample.time = QDateTime::currentMSecsSinceEpoch();
+    sample.jobs = stats.totalJobsCount;
+    sample.products = stats.totalProductsCount;
+    sample.cases = stats.totalCasesCount;
+    sample.quota = stats.totalRecruitmentQuota;
+    m_samples.append(sample);
+
+    const QString &path = m_filePath;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+        qDebug() << "Cannot append to metrics history" << path;
+    } else {
+        QDataStream out(&file);
+        out.setByteOrder(QDataStream::LittleEndian);
+        if (file.size() < kHeaderSize) {
+            file.resize(0);
+            out.writeRawData(kMagic, 4);
+            out << kFormatVersion;
+        } else if ((file.size() - kHeaderSize) % kRecordSize != 0) {
+            // 上次写到一半：截掉不完整的记录，保持定长对齐
+            file.resize(file.size() - (file.size() - kHeaderSize) % kRecordSize);
+        }
+        out << sample.time << sample.jobs << sample.products << sample.cases << sample.quota;
+    }
+
+    emit sampleAppended(sample);
+}
+
+const QList<MetricSample> &MetricsHistory::samples()
+{
+    load();
+    return m_samples;
+}
+
+QList<QPointF> MetricsHistory::series(Metric metric, qint64 since)
+{
+    load();
+    // 样本按时间追加，二分找到起点
+    auto first = std::lower_bound(m_samples.cbegin(), m_samples.cend(), since,
+                                  [](const MetricSample &s, qint64 t) { return s.time < t; });
+    QList<QPointF> points;
+    points.reserve(int(m_samples.cend() - first));
+    for (auto it = first; it != m_samples.cend(); ++it)
+        points.append(QPointF(double(it->time), valueOf(*it, metric)));
+    return points;
+}
+
+QString MetricsHistory::metricName(Metric metric)
+{
+    switch (metric) {
+    case Jobs:     return "职位数量";
+    case Products: return "产品数量";
+    case Cases:    return "案例数量";
+    case Quota:    return "招聘名额";
+    default:       return QString();
+    }
+}
+
+QString MetricsHistory::metricUnit(Metric metric)
+{
+    return metric == Quota ? QString("人") : QString("个");
+}
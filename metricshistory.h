@@ -0,0 +1,57 @@
+// metricshistory.h
+#ifndef METRICSHISTORY_H
+#define METRICSHISTORY_H
+
+#include <QObject>
+#include <QList>
+#include <QPointF>
+#include "datastructures.h"
+
+// 一次同步时的统计数据；磁盘上固定 24 字节
+struct MetricSample {
+    qint64 time = 0; // 毫秒，UTC
+    qint32 jobs = 0;
+    qint32 products = 0;
+    qint32 cases = 0;
+    qint32 quota = 0;
+};
+
+// --- 数据中心统计的本地历史 ---
+// 每次同步到统计数据就追加一条样本。每个站点一个文件，是只追加的定长二进制记录
+// （文件头 8 字节 + 每条 24 字节，一年每天同步十次也不到 100 KB），
+// 追加只写一条记录，不重写整个文件；读取在第一次使用时进行一次，之后样本常驻内存。
+// 写到一半被中断时，末尾不完整的记录在读取时被丢弃。
+class MetricsHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Metric { Jobs, Products, Cases, Quota, MetricCount };
+
+    static MetricsHistory *instance();
+
+    void append(const DashboardStats &stats);
+
+    // 全部样本，按时间升序
+    const QList<MetricSample> &samples();
+    // 某项指标在 [since, 现在] 内的折线（x 为毫秒时间，y 为数值）
+    QList<QPointF> series(Metric metric, qint64 since = 0);
+
+    static QString metricName(Metric metric);
+    static QString metricUnit(Metric metric);
+
+signals:
+    void sampleAppended(const MetricSample &sample);
+
+private:
+    explicit MetricsHistory(QObject *parent = nullptr);
+
+    void load();
+    static QString historyFilePath();
+
+    bool m_loaded = false;
+    QString m_filePath; // 当前站点的历史文件
+    QList<MetricSample> m_samples;
+};
+
+#endif // METRICSHISTORY_H
@@ -0,0 +1,223 @@
+// multisitesync.cpp
+#include "multisitesync.h"
+#include "siteregistry.h"
+#include "networkthread.h"
+#include "networksession.h"
+#include "dataserializer.h"
+#include "tracelog.h"
+
+#include <QCoreApplication>
+#include <QNetworkAccessManager>
+#include <QSet>
+#include <QSettings>
+#include <QUrlQuery>
+#include <QDebug>
+
+MultiSiteSync *MultiSiteSync::instance()
+{
+    static MultiSiteSync *sync = new MultiSiteSync(qApp);
+    return sync;
+}
+
+MultiSiteSync::MultiSiteSync(QObject *parent)
+    : QObject(parent)
+{
+    m_maxInFlight = qBound(1, QSettings().value("sites/maxConcurrent", 4).toInt(), 16);
+
+    auto *store = DataStore::instance();
+    connect(store, &DataStore::dataReset, this, &MultiSiteSync::onDataReset);
+    connect(SiteRegistry::instance(), &SiteRegistry::sitesChanged, this, &MultiSiteSync::onSitesChanged);
+    connect(SiteRegistry::instance(), &SiteRegistry::sessionChanged, this, [this](const QString &siteId) {
+        SiteSyncStatus &status = m_status[siteId];
+        const bool loggedIn = !SiteRegistry::instance()->sessionKey(siteId).isEmpty();
+        if (!loggedIn) status = SiteSyncStatus();
+        else if (status.state == SiteSyncStatus::NotLoggedIn) status.state = SiteSyncStatus::Idle;
+        emit statusChanged(siteId);
+    });
+    if (store->current()->hasStats) onDataReset(store->current(), DataStore::Stats);
+}
+
+SiteSyncStatus MultiSiteSync::status(const QString &siteId) const
+{
+    return m_status.value(siteId);
+}
+
+DashboardStats MultiSiteSync::totals() const
+{
+    DashboardStats sum;
+    for (const Site &site : SiteRegistry::instance()->sites()) {
+        const SiteSyncStatus status = m_status.value(site.id);
+        if (!status.hasStats) continue;
+        sum.totalJobsCount += status.stats.totalJobsCount;
+        sum.totalProductsCount += status.stats.totalProductsCount;
+        sum.totalCasesCount += status.stats.totalCasesCount;
+        sum.totalRecruitmentQuota += status.stats.totalRecruitmentQuota;
+    }
+    return sum;
+}
+
+void MultiSiteSync::onDataReset(SnapshotPtr snapshot, DataStore::Sections sections)
+{
+    if (!(sections & DataStore::Stats) || !snapshot->hasStats) return;
+    const QString siteId = SiteRegistry::instance()->currentSiteId();
+    SiteSyncStatus &status = m_status[siteId];
+    status.state = SiteSyncStatus::Synced;
+    status.stats = snapshot->stats;
+    status.hasStats = true;
+    status.syncedAt = QDateTime::currentDateTime();
+    status.error.clear();
+    emit statusChanged(siteId);
+}
+
+void MultiSiteSync::onSitesChanged()
+{
+    // 已移除的站点：丢掉状态和排队中的任务（在途的请求完成后按站点编号找不到，自然作废）
+    QSet<QString> ids;
+    for (const Site &site : SiteRegistry::instance()->sites()) ids.insert(site.id);
+    for (auto it = m_status.begin(); it != m_status.end();) {
+        if (ids.contains(it.key())) ++it;
+        else it = m_status.erase(it);
+    }
+    m_waiting.removeIf([&ids](const Task &task) { return !ids.contains(task.siteId); });
+}
+
+void MultiSiteSync::login(const QString &siteId, const QString &password)
+{
+    if (SiteRegistry::instance()->site(siteId).id.isEmpty() || password.isEmpty()) return;
+    enqueue(Task{siteId, password});
+}
+
+void MultiSiteSync::syncAll()
+{
+    const QString currentId = SiteRegistry::instance()->currentSiteId();
+    bool any = false;
+    for (const Site &site : SiteRegistry::instance()->sites()) {
+        if (site.id == currentId || SiteRegistry::instance()->sessionKey(site.id).isEmpty()) continue;
+        const SiteSyncStatus::State state = m_status.value(site.id).state;
+        if (state == SiteSyncStatus::Queued || state == SiteSyncStatus::Syncing || state == SiteSyncStatus::LoggingIn)
+            continue;
+        enqueue(Task{site.id, QString()});
+        any = true;
+    }
+    // 上一轮还没结束时并入上一轮；一个站点都没有提交也要通知界面，否则“刷新”按钮不会恢复
+    if (any && !m_roundTimer.isValid()) m_roundTimer.start();
+    else if (!any && !m_roundTimer.isValid()) emit allFinished(0);
+}
+
+void MultiSiteSync::sync(const QString &siteId)
+{
+    if (SiteRegistry::instance()->sessionKey(siteId).isEmpty()) return;
+    enqueue(Task{siteId, QString()});
+}
+
+void MultiSiteSync::enqueue(const Task &task)
+{
+    setState(task.siteId, task.password.isEmpty() ? SiteSyncStatus::Queued : SiteSyncStatus::LoggingIn);
+    m_waiting.append(task);
+    pump();
+}
+
+void MultiSiteSync::pump()
+{
+    while (m_inFlight < m_maxInFlight && !m_waiting.isEmpty())
+        startTask(m_waiting.takeFirst());
+}
+
+void MultiSiteSync::startTask(const Task &task)
+{
+    const Site site = SiteRegistry::instance()->site(task.siteId);
+    if (site.id.isEmpty()) return;
+    ++m_inFlight;
+    QElapsedTimer timer;
+    timer.start();
+
+    if (!task.password.isEmpty()) {
+        const QString password = task.password;
+        const QUrl api = site.apiUrl;
+        NetworkThread::instance()->submit("login",
+            [api, password](QNetworkAccessManager *manager) {
+                QNetworkRequest request = NetworkSession::apiRequest(api);
+                request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+                request.setAttribute(QNetworkRequest::User, "login");
+                QUrlQuery postData;
+                postData.addQueryItem("action", "login");
+                postData.addQueryItem("password", password);
+                return manager->post(request, postData.query(QUrl::FullyEncoded).toUtf8());
+            },
+            this, [this, siteId = site.id, timer](const NetworkResult &result) {
+                QString error;
+                if (!result.ok()) error = "无法连接服务器: " + result.errorString;
+                else if (result.json["status"].toString() != "success") error = result.json["message"].toString("未知错误");
+                else if (result.json["session_key"].toString().isEmpty()) error = "登录响应中没有会话密钥";
+
+                if (m_status.contains(siteId)) {
+                    m_status[siteId].elapsedMs = timer.elapsed();
+                    if (error.isEmpty()) {
+                        SiteRegistry::instance()->setSessionKey(siteId, result.json["session_key"].toString());
+                        setState(siteId, SiteSyncStatus::Idle);
+                    } else {
+                        setState(siteId, SiteSyncStatus::NotLoggedIn, error);
+                    }
+                    emit loginFinished(siteId, error.isEmpty(), error);
+                }
+                finishTask();
+            });
+        return;
+    }
+
+    setState(site.id, SiteSyncStatus::Syncing);
+    const QUrl api = site.apiUrl;
+    const QString sessionKey = SiteRegistry::instance()->sessionKey(site.id);
+    NetworkThread::instance()->submit("get_all_data",
+        [api, sessionKey](QNetworkAccessManager *manager) {
+            QNetworkRequest request = NetworkSession::apiRequest(api, "get_all_data");
+            QUrl url = request.url();
+            QUrlQuery query(url);
+            query.addQueryItem("key", sessionKey);
+            url.setQuery(query);
+            request.setUrl(url);
+            request.setAttribute(QNetworkRequest::User, "get_all_data");
+            return manager->get(request);
+        },
+        this, [this, siteId = site.id, timer](const NetworkResult &result) {
+            QString error;
+            if (!result.ok()) error = result.errorString;
+            else if (result.json["status"].toString() != "success") error = result.json["message"].toString("未知错误");
+            else if (!result.json["data"].toObject()["stats"].isObject()) error = "数据结构错误：缺少 'stats' 对象";
+
+            if (m_status.contains(siteId)) {
+                SiteSyncStatus &status = m_status[siteId];
+                status.elapsedMs = timer.elapsed();
+                if (error.isEmpty()) {
+                    status.stats = DataSerializer::statsFromJson(result.json["data"].toObject()["stats"].toObject());
+                    status.hasStats = true;
+                    status.syncedAt = QDateTime::currentDateTime();
+                    setState(siteId, SiteSyncStatus::Synced);
+                } else {
+                    qDebug() << "Site sync failed:" << siteId << error;
+                    setState(siteId, SiteSyncStatus::Failed, error);
+                }
+            }
+            finishTask();
+        });
+}
+
+void MultiSiteSync::finishTask()
+{
+    --m_inFlight;
+    pump();
+    if (!isBusy() && m_roundTimer.isValid()) {
+        const qint64 elapsed = m_roundTimer.elapsed();
+        m_roundTimer.invalidate();
+        TraceLog::instant("network", "multi-site sync finished");
+        emit allFinished(elapsed);
+    }
+}
+
+void MultiSiteSync::setState(const QString &siteId, SiteSyncStatus::State state, const QString &error)
+{
+    SiteSyncStatus &status = m_status[siteId];
+    status.state = state;
+    status.error = error;
+    emit statusChanged(siteId);
+}
@@ -0,0 +1,83 @@
+// multisitesync.h
+#ifndef MULTISITESYNC_H
+#define MULTISITESYNC_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+#include "datastructures.h"
+#include "datastore.h"
+
+// 一个站点在数据中心汇总中的状态
+struct SiteSyncStatus {
+    enum State { NotLoggedIn, Idle, LoggingIn, Queued, Syncing, Synced, Failed };
+
+    State state = NotLoggedIn;
+    DashboardStats stats; // 最近一次成功同步的统计数据
+    bool hasStats = false;
+    QDateTime syncedAt;
+    qint64 elapsedMs = 0; // 最近一次请求从发出到完成的时长
+    QString error;
+};
+
+// --- 多站点汇总同步 ---
+// 对 SiteRegistry 中的每个站点分别登录，并发拉取 get_all_data，只保留其中的统计数据用于汇总。
+// 所有站点共用一个连接预算（sites/maxConcurrent，默认 4）：同时在途的请求不超过预算，
+// 其余排队，任何一个完成后立刻补上。站点数不超过预算时，刷新全部站点的耗时约等于最慢的那个站点，
+// 而不是各站点耗时之和。
+// 当前站点的数据由主窗口的常规同步负责（写入 DataStore），这里直接取 DataStore 中的统计数据，
+// 不重复拉取。
+class MultiSiteSync : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MultiSiteSync *instance();
+
+    int maxInFlight() const { return m_maxInFlight; }
+
+    // 登录指定站点；结果通过 loginFinished 报告，成功后会话密钥记入 SiteRegistry
+    void login(const QString &siteId, const QString &password);
+    // 同步除当前站点以外所有已登录的站点；正在同步的站点不会重复提交
+    void syncAll();
+    void sync(const QString &siteId);
+    bool isBusy() const { return m_inFlight > 0 || !m_waiting.isEmpty(); }
+
+    SiteSyncStatus status(const QString &siteId) const;
+    // 所有已有统计数据的站点之和（serverTime 为空）
+    DashboardStats totals() const;
+
+signals:
+    void statusChanged(const QString &siteId);
+    void loginFinished(const QString &siteId, bool ok, const QString &message);
+    // 一轮 syncAll() 全部完成，elapsedMs 为整轮耗时
+    void allFinished(qint64 elapsedMs);
+
+private slots:
+    void onDataReset(SnapshotPtr snapshot, DataStore::Sections sections);
+    void onSitesChanged();
+
+private:
+    explicit MultiSiteSync(QObject *parent = nullptr);
+
+    struct Task {
+        QString siteId;
+        QString password; // 非空表示登录，否则是拉取数据
+    };
+
+    void enqueue(const Task &task);
+    void pump();
+    void startTask(const Task &task);
+    void finishTask();
+    void setState(const QString &siteId, SiteSyncStatus::State state, const QString &error = QString());
+
+    int m_maxInFlight = 4;
+    int m_inFlight = 0;
+    QList<Task> m_waiting;
+    QHash<QString, SiteSyncStatus> m_status;
+    QElapsedTimer m_roundTimer; // 有效表示一轮 syncAll() 正在进行
+};
+
+#endif // MULTISITESYNC_H
@@ -0,0 +1,670 @@
+// mutationqueue.cpp
+#include "mutationqueue.h"
+#include "networksession.h"
+#include "batchclient.h"
+#include "dataserializer.h"
+#include "datastore.h"
+#include "jsonbackend.h"
+#include "recordlocks.h"
+#include "recordmerge.h"
+#include "networkthread.h"
+#include "siteregistry.h"
+#include "imagededupe.h"
+
+#include <QCoreApplication>
+#include <QNetworkAccessManager>
+#include <QHttpMultiPart>
+#include <QUrlQuery>
+#include <QTimer>
+#include <QSet>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+// 离线期间探测服务器的间隔
+const int kProbeIntervalMs = 10000;
+const char *const kPlaceholderScheme = "pending-upload://";
+// 单个批量请求最多携带的图片数，避免批量导入时一个请求大到无法完成
+const int kMaxUploadsPerBatch = 16;
+// 服务器拒绝或出错（不是断网）时的重试：间隔从 5 秒起每次翻倍，最多 5 次，之后暂停等待用户处理
+const int kRetryBaseMs = 5000;
+const int kMaxAttempts = 5;
+
+bool isHeld(const QJsonObject &entry)
+{
+    return entry["attempts"].toInt() >= kMaxAttempts;
+}
+}
+
+MutationQueue *MutationQueue::instance()
+{
+    static MutationQueue *queue = new MutationQueue(qApp);
+    return queue;
+}
+
+MutationQueue::MutationQueue(QObject *parent)
+    : QObject(parent)
+    , m_probeTimer(new QTimer(this))
+    , m_persistTimer(new QTimer(this))
+    , m_retryTimer(new QTimer(this))
+{
+    m_persistTimer->setSingleShot(true);
+    m_persistTimer->setInterval(0);
+    connect(m_persistTimer, &QTimer::timeout, this, &MutationQueue::writeToDisk);
+    // 退出前把还没写盘的变动写进去
+    connect(qApp, &QCoreApplication::aboutToQuit, this, [this]() {
+        if (m_persistTimer->isActive()) writeToDisk();
+    });
+
+    m_probeTimer->setInterval(kProbeIntervalMs);
+    connect(m_probeTimer, &QTimer::timeout, this, &MutationQueue::probe);
+    m_retryTimer->setSingleShot(true);
+    connect(m_retryTimer, &QTimer::timeout, this, &MutationQueue::probe);
+    load();
+}
+
+void MutationQueue::setSessionKey(const QString &sessionKey)
+{
+    m_sessionKey = sessionKey;
+    // 上次运行遗留的队列项，登录后立即尝试重放；换了会话，之前失败的项也重新计数
+    for (auto &entry : m_entries) entry.remove("attempts");
+    if (!m_entries.isEmpty()) probe();
+}
+
+int MutationQueue::heldCount() const
+{
+    return int(std::count_if(m_entries.cbegin(), m_entries.cend(), isHeld));
+}
+
+QList<MutationQueue::HeldEntry> MutationQueue::heldEntries() const
+{
+    QList<HeldEntry> held;
+    for (const auto &entry : m_entries) {
+        if (!isHeld(entry)) continue;
+        HeldEntry info;
+        info.id = entry["id"].toInt();
+        info.action = entry["action"].toString();
+        info.attempts = entry["attempts"].toInt();
+        info.lastError = entry["lastError"].toString();
+        held.append(info);
+    }
+    return held;
+}
+
+void MutationQueue::retryHeld()
+{
+    for (auto &entry : m_entries) {
+        if (isHeld(entry)) entry.remove("attempts");
+    }
+    persist();
+    emit heldChanged(0);
+    probe();
+}
+
+void MutationQueue::discard(int id)
+{
+    for (const auto &entry : std::as_const(m_entries)) {
+        if (entry["id"].toInt() != id) continue;
+        // 放弃的图片从待保存数据中去掉，不留下无法解析的占位地址
+        if (entry["action"].toString() == "upload_image")
+            replacePlaceholders({{entry["placeholder"].toString(), QString()}});
+        break;
+    }
+    removeEntry(id);
+    emit heldChanged(heldCount());
+}
+
+QString MutationQueue::describe(const QString &action)
+{
+    if (action == "save_jobs") return "职位列表";
+    if (action == "save_products") return "产品列表";
+    if (action == "upload_image") return "图片上传";
+    return action;
+}
+
+bool MutationQueue::isPlaceholder(const QString &url)
+{
+    return url.startsWith(kPlaceholderScheme);
+}
+
+QString MutationQueue::enqueueUpload(const QString &type, const QString &filePath)
+{
+    const int id = m_nextId++;
+    const QString placeholder = kPlaceholderScheme + QString::number(id);
+
+    QJsonObject entry;
+    entry["id"] = id;
+    entry["action"] = "upload_image";
+    entry["type"] = type;
+    entry["path"] = filePath;
+    entry["placeholder"] = placeholder;
+    m_entries.append(entry);
+
+    persist();
+    emit pendingCountChanged(m_entries.size());
+    return placeholder;
+}
+
+void MutationQueue::enqueueSave(const QList<Job> &jobs)
+{
+    enqueueSave("save_jobs", DataSerializer::toJsonArray(jobs),
+                DataSerializer::toJsonArray(DataStore::instance()->syncBase().jobValues()));
+}
+
+void MutationQueue::enqueueSave(const QList<Product> &products)
+{
+    enqueueSave("save_products", DataSerializer::toJsonArray(products),
+                DataSerializer::toJsonArray(DataStore::instance()->syncBase().productValues()));
+}
+
+void MutationQueue::enqueueSave(const QString &action, const QJsonArray &records, const QJsonArray &base)
+{
+    // 整表保存只需保留最新一份；正在发送中的那一份也一并替换，
+    // 它的回复到达时找不到对应编号，不会误删新数据。
+    // 合并的共同祖先是第一次排队时的基准：离线期间没有同步，之后的修改都是在它的基础上做的
+    QJsonArray ancestor = base;
+    for (int i = m_entries.size() - 1; i >= 0; --i) {
+        if (m_entries[i]["action"].toString() != action) continue;
+        if (m_entries[i].contains("base")) ancestor = m_entries[i]["base"].toArray();
+        m_entries.removeAt(i);
+    }
+
+    QJsonObject entry;
+    entry["id"] = m_nextId++;
+    entry["action"] = action;
+    entry["records"] = records;
+    entry["base"] = ancestor;
+    m_entries.append(entry);
+
+    persist();
+    emit pendingCountChanged(m_entries.size());
+
+    if (!m_offline) probe();
+}
+
+// 发给服务器的整表数据
+QJsonArray MutationQueue::wirePayload(const QJsonObject &entry)
+{
+    if (entry.contains("payload")) return entry["payload"].toArray();
+    const QJsonArray records = entry["records"].toArray();
+    if (entry["action"].toString() == "save_jobs")
+        return DataSerializer::toWireArray(DataSerializer::jobsFromJson(records));
+    return DataSerializer::toWireArray(DataSerializer::productsFromJson(records));
+}
+
+void MutationQueue::reportOffline()
+{
+    setOffline(true);
+}
+
+void MutationQueue::setOffline(bool offline)
+{
+    if (offline) m_probeTimer->start();
+    else m_probeTimer->stop();
+
+    if (m_offline == offline) return;
+    m_offline = offline;
+    qDebug() << (offline ? "Network unreachable, entering offline mode" : "Network is back online");
+    emit offlineChanged(offline);
+}
+
+void MutationQueue::probe()
+{
+    if (m_replaying || m_sessionKey.isEmpty()) return;
+
+    // 探测和重放都在网络线程中进行，界面线程被对话框占住时同步照常进行。
+    // 任何 HTTP 响应（哪怕是错误码）都说明服务器可达
+    NetworkThread::instance()->submit("probe",
+        [](QNetworkAccessManager *manager) { return manager->head(NetworkSession::apiRequest()); },
+        this, [this](const NetworkResult &result) {
+            if (NetworkSession::isConnectivityError(result.error)) {
+                setOffline(true);
+                return;
+            }
+            setOffline(false);
+            startReplay();
+        });
+}
+
+void MutationQueue::startReplay()
+{
+    if (m_replaying || m_sessionKey.isEmpty() || m_retryTimer->isActive()) return;
+    if (heldCount() == m_entries.size()) return; // 只剩暂停的项，等用户重试或放弃
+    qDebug() << "Replaying" << m_entries.size() - heldCount() << "queued mutation(s)";
+    m_replaying = true;
+    dedupeUploads();
+}
+
+// 离线保存和批量导入排进来的图片，重放前先按内容查找：本地缓存或服务器已有的
+// 直接把地址替换进待保存数据，不再上传；其余的记下哈希，上传时一并提交
+void MutationQueue::dedupeUploads()
+{
+    QStringList paths;
+    for (const auto &entry : std::as_const(m_entries)) {
+        if (entry["action"].toString() == "upload_image" && !entry.contains("hash") && !isHeld(entry))
+            paths.append(entry["path"].toString());
+    }
+    const QSet<QString> looked(paths.cbegin(), paths.cend());
+    ImageDedupe::lookup(paths, m_sessionKey, this, [this, looked](const ImageDedupe::Lookup &lookup) {
+        if (NetworkSession::isConnectivityError(lookup.checkError)) {
+            m_replaying = false;
+            setOffline(true);
+            return;
+        }
+        QHash<QString, QString> known;
+        QList<int> resolved;
+        for (auto &entry : m_entries) {
+            const QString path = entry["path"].toString();
+            if (entry["action"].toString() != "upload_image" || entry.contains("hash") || !looked.contains(path)) continue;
+            const QString url = lookup.urls.value(path);
+            if (!url.isEmpty()) {
+                known.insert(entry["placeholder"].toString(), url);
+                resolved.append(entry["id"].toInt());
+            }
+            // 读不了的文件留给上传时报告；哈希为空也记下，下次不再重复计算
+            entry["hash"] = lookup.hashes.value(path);
+        }
+        replacePlaceholders(known);
+        for (int id : std::as_const(resolved)) removeEntry(id);
+        if (!resolved.isEmpty()) qDebug() << "Reused" << resolved.size() << "queued image(s) already on the server";
+        persist();
+        mergeIfNeeded();
+    });
+}
+
+void MutationQueue::mergeIfNeeded()
+{
+    bool needsMerge = false;
+    for (const auto &entry : std::as_const(m_entries)) {
+        if (entry.contains("base") && !isHeld(entry)) needsMerge = true;
+    }
+    // 老版本服务器只允许一个管理员登录，不会有别人的修改，不必合并
+    if (needsMerge && RecordLocks::instance()->isSupported()) mergeWithServer();
+    else continueReplay();
+}
+
+void MutationQueue::continueReplay()
+{
+    if (BatchClient::isSupported()) replayBatch();
+    else replayNext();
+}
+
+// 取回服务器的最新数据，与排队的整表保存三方合并后再重放
+void MutationQueue::mergeWithServer()
+{
+    RecordMerge::fetchServer(this, [this](const NetworkResult &result, const SyncResponse &response) {
+        if (NetworkSession::isConnectivityError(result.error)) {
+            m_replaying = false;
+            setOffline(true);
+            return;
+        }
+        if (!result.ok() || !response.isSuccess()) {
+            // 拿不到服务器的最新数据时不冒险整表覆盖，队列原样保留，稍后重试
+            const QString reason = !result.ok() ? result.errorString
+                                   : !response.isValid() ? response.parseError : response.message;
+            QList<int> ids;
+            for (const auto &entry : std::as_const(m_entries)) {
+                if (entry.contains("base") && !isHeld(entry)) ids.append(entry["id"].toInt());
+            }
+            replayFailed(ids, "离线队列同步前无法获取服务器上的最新数据: " + reason);
+            return;
+        }
+
+        QStringList conflicts;
+        for (auto &entry : m_entries) {
+            if (!entry.contains("base") || isHeld(entry)) continue;
+            const QString action = entry["action"].toString();
+            const QJsonArray base = entry["base"].toArray();
+            const QJsonArray records = entry["records"].toArray();
+            if (action == "save_jobs" && response.data.hasJobs) {
+                const auto merged = RecordMerge::threeWay(DataSerializer::jobsFromJson(base),
+                                                          DataSerializer::jobsFromJson(records),
+                                                          response.data.jobs, RecordMerge::jobKey);
+                entry["records"] = DataSerializer::toJsonArray(merged.records);
+                entry["base"] = DataSerializer::toJsonArray(response.data.jobs);
+                conflicts += merged.conflicts;
+            } else if (action == "save_products" && response.data.hasProducts) {
+                const auto merged = RecordMerge::threeWay(DataSerializer::productsFromJson(base),
+                                                          DataSerializer::productsFromJson(records),
+                                                          response.data.products, RecordMerge::productKey);
+                entry["records"] = DataSerializer::toJsonArray(merged.records);
+                entry["base"] = DataSerializer::toJsonArray(response.data.products);
+                conflicts += merged.conflicts;
+            }
+        }
+        // 合并结果以服务器的最新数据为新的基准写回队列，重放中断后再次合并不会重复计入
+        persist();
+        if (!conflicts.isEmpty())
+            emit replayError("以下记录离线期间也被其他管理员修改过，已保存为您的版本: " + conflicts.join("、"));
+        continueReplay();
+    });
+}
+
+void MutationQueue::replayBatch()
+{
+    if (heldCount() == m_entries.size()) {
+        m_replaying = false;
+        emit replayFinished();
+        return;
+    }
+
+    // 图片在前、保存在后；队列里的占位地址直接作为批量请求中的图片引用。
+    // 图片太多时先发只含图片的批次，所有图片都能放进本批时才带上保存
+    BatchRequest batch;
+    QList<int> ids;
+    int uploads = 0;
+    bool morePending = false;
+    for (const auto &entry : std::as_const(m_entries)) {
+        if (entry["action"].toString() != "upload_image" || isHeld(entry)) continue;
+        if (uploads == kMaxUploadsPerBatch) {
+            morePending = true;
+            break;
+        }
+        batch.addImage(entry["type"].toString(), entry["path"].toString(), entry["placeholder"].toString(),
+                       entry["hash"].toString());
+        ids.append(entry["id"].toInt());
+        ++uploads;
+    }
+    if (!morePending) {
+        for (const auto &entry : std::as_const(m_entries)) {
+            if (entry["action"].toString() == "upload_image" || isHeld(entry)) continue;
+            batch.addSave(entry["action"].toString(), wirePayload(entry));
+            ids.append(entry["id"].toInt());
+        }
+    }
+
+    const QString failedFile = batch.unreadableFile();
+    if (!failedFile.isEmpty()) {
+        // 本地图片已经不在了：放弃这一项后重新打包
+        emit replayError("离线队列中的图片已无法读取: " + failedFile);
+        for (const auto &entry : std::as_const(m_entries)) {
+            if (entry["action"].toString() == "upload_image" && entry["path"].toString() == failedFile) {
+                const int id = entry["id"].toInt();
+                replacePlaceholders({{entry["placeholder"].toString(), QString()}});
+                removeEntry(id);
+                break;
+            }
+        }
+        replayBatch();
+        return;
+    }
+
+    const QString sessionKey = m_sessionKey;
+    NetworkThread::instance()->submit("batch",
+        [sessionKey, batch](QNetworkAccessManager *manager) {
+            return BatchClient::post(manager, sessionKey, batch);
+        },
+        this, [this, batch, ids](const NetworkResult &result) { handleBatchResult(result, batch, ids); });
+}
+
+void MutationQueue::handleBatchResult(const NetworkResult &result, const BatchRequest &batch, const QList<int> &ids)
+{
+    if (NetworkSession::isConnectivityError(result.error)) {
+        // 重放途中又断网了，剩下的队列项原样保留，等下一次探测成功
+        m_replaying = false;
+        setOffline(true);
+        return;
+    }
+    const BatchResponse response = BatchClient::parseResult(result, batch);
+    if (!response.supported) {
+        BatchClient::markUnsupported();
+        replayNext();
+        return;
+    }
+    if (!response.committed) {
+        // 事务整体回滚：改用逐项重放，让能成功的部分先生效，有问题的项单独报告
+        emit replayError("离线队列批量同步失败，改为逐项同步: " + response.message);
+        replayNext();
+        return;
+    }
+
+    // 只含图片的批次里，服务器不会替换保存数据，需要在本地把占位地址换成真实地址
+    for (const auto &entry : std::as_const(m_entries)) {
+        const QString url = response.imageUrls.value(entry["placeholder"].toString());
+        if (!url.isEmpty()) ImageDedupe::remember(entry["hash"].toString(), url);
+    }
+    replacePlaceholders(response.imageUrls);
+    for (int id : ids)
+        removeEntry(id);
+    qDebug() << "Batch replay committed" << response.results.size() << "operation(s)";
+
+    // 重放期间又有新的修改进入队列时，继续下一批
+    replayBatch();
+}
+
+void MutationQueue::replayNext()
+{
+    if (heldCount() == m_entries.size()) {
+        m_replaying = false;
+        emit replayFinished();
+        return;
+    }
+
+    // 图片优先：保存数据里的占位地址要等图片上传完成后才能替换。
+    // 服务器不支持 batch 时只能一张图片一个请求
+    QJsonObject entry;
+    for (const auto &candidate : std::as_const(m_entries)) {
+        if (isHeld(candidate)) continue;
+        if (entry.isEmpty()) entry = candidate;
+        if (candidate["action"].toString() == "upload_image") {
+            entry = candidate;
+            break;
+        }
+    }
+
+    const int id = entry["id"].toInt();
+    const QString action = entry["action"].toString();
+    const QString sessionKey = m_sessionKey;
+    NetworkThread::RequestFactory factory;
+
+    if (action == "upload_image") {
+        const QString path = entry["path"].toString();
+        if (!QFileInfo(path).isReadable()) {
+            // 本地文件已经不在了，这张图片无法再上传，放弃它并继续
+            emit replayError("离线队列中的图片已无法读取: " + path);
+            replacePlaceholders({{entry["placeholder"].toString(), QString()}});
+            removeEntry(id);
+            replayNext();
+            return;
+        }
+        const QString type = entry["type"].toString();
+        const QString hash = entry["hash"].toString();
+        factory = [sessionKey, type, path, hash](QNetworkAccessManager *manager) -> QNetworkReply * {
+            QHttpMultiPart *multiPart = NetworkSession::createImageUpload(sessionKey, type, path, hash);
+            if (!multiPart) return nullptr;
+            QNetworkReply *reply = manager->post(NetworkSession::apiRequest(), multiPart);
+            multiPart->setParent(reply);
+            return reply;
+        };
+    } else {
+        const QJsonArray payload = wirePayload(entry);
+        factory = [sessionKey, action, payload](QNetworkAccessManager *manager) {
+            return NetworkSession::postSave(manager, sessionKey, action, payload);
+        };
+    }
+
+    NetworkThread::instance()->submit(action, factory, this, [this, id](const NetworkResult &result) {
+        onReplayResult(result, id);
+    });
+}
+
+void MutationQueue::onReplayResult(const NetworkResult &result, int id)
+{
+    if (NetworkSession::isConnectivityError(result.error)) {
+        // 重放途中又断网了，剩下的队列项原样保留，等下一次探测成功
+        m_replaying = false;
+        setOffline(true);
+        return;
+    }
+    if (!result.ok()) {
+        replayFailed({id}, "离线队列同步失败: " + result.json["message"].toString(result.errorString));
+        return;
+    }
+
+    const QJsonObject &obj = result.json;
+    const bool success = obj["status"].toString() == "success";
+
+    if (result.tag == "upload_image") {
+        QString placeholder;
+        QString hash;
+        for (const auto &entry : std::as_const(m_entries)) {
+            if (entry["id"].toInt() != id) continue;
+            placeholder = entry["placeholder"].toString();
+            hash = entry["hash"].toString();
+        }
+        if (!success) {
+            // 服务器拒绝这张图片（格式、大小等），重试也没有意义
+            emit replayError("离线队列中的图片上传失败: " + obj["message"].toString());
+        } else {
+            ImageDedupe::remember(hash, obj["url"].toString());
+        }
+        replacePlaceholders({{placeholder, success ? obj["url"].toString() : QString()}});
+        removeEntry(id);
+        replayNext();
+        return;
+    }
+
+    if (!success) {
+        // 保存被拒绝（例如会话失效），保留队列项，按退避间隔重试
+        replayFailed({id}, "离线队列保存失败: " + obj["message"].toString());
+        return;
+    }
+    removeEntry(id);
+    replayNext();
+}
+
+// 服务器拒绝或出错（不是断网）：给失败的项计数，隔一段时间再重放整个队列。
+// 多次失败的图片直接放弃；多次失败的保存暂停自动重放，其余的项照常同步，
+// 由用户在状态栏查看原因后选择重试或放弃（见 heldEntries）
+void MutationQueue::replayFailed(const QList<int> &ids, const QString &message)
+{
+    m_replaying = false;
+
+    int attempts = 0;
+    QList<int> dropped;
+    for (auto &entry : m_entries) {
+        if (!ids.contains(entry["id"].toInt())) continue;
+        entry["attempts"] = entry["attempts"].toInt() + 1;
+        entry["lastError"] = message;
+        if (isHeld(entry) && entry["action"].toString() == "upload_image") dropped.append(entry["id"].toInt());
+        else attempts = qMax(attempts, entry["attempts"].toInt());
+    }
+    persist();
+    for (int id : std::as_const(dropped)) discard(id);
+
+    if (attempts >= kMaxAttempts) {
+        emit replayError(message + QString("（已重试 %1 次，暂停自动同步）").arg(kMaxAttempts));
+        emit heldChanged(heldCount());
+        // 其余的项不受影响，继续同步
+        if (heldCount() < m_entries.size()) probe();
+        return;
+    }
+    if (attempts == 0) {
+        // 失败的只有被放弃的图片
+        probe();
+        return;
+    }
+    const int delayMs = kRetryBaseMs << (attempts - 1);
+    emit replayError(message + QString("（%1 秒后重试）").arg(delayMs / 1000));
+    m_retryTimer->start(delayMs);
+}
+
+void MutationQueue::removeEntry(int id)
+{
+    for (int i = 0; i < m_entries.size(); ++i) {
+        if (m_entries[i]["id"].toInt() == id) {
+            m_entries.removeAt(i);
+            persist();
+            emit pendingCountChanged(m_entries.size());
+            return;
+        }
+    }
+}
+
+// 把待保存数据中的占位地址换成真实地址；地址为空时直接删除这个占位地址。
+// 一批地址只遍历一次数据，调用方随后会移除队列项并触发写盘
+void MutationQueue::replacePlaceholders(const QHash<QString, QString> &urls)
+{
+    if (urls.isEmpty()) return;
+
+    for (auto &entry : m_entries) {
+        const QString field = entry.contains("records") ? "records" : "payload";
+        if (!entry.contains(field)) continue;
+        QJsonArray records = entry[field].toArray();
+        bool changed = false;
+        for (int i = 0; i < records.size(); ++i) {
+            QJsonObject record = records[i].toObject();
+            const QJsonArray oldUrls = record["imageUrls"].toArray();
+            bool hasPlaceholder = false;
+            for (const QJsonValue &v : oldUrls) {
+                if (urls.contains(v.toString())) { hasPlaceholder = true; break; }
+            }
+            if (!hasPlaceholder) continue;
+
+            QJsonArray newUrls;
+            for (const QJsonValue &v : oldUrls) {
+                const auto it = urls.constFind(v.toString());
+                if (it == urls.constEnd()) newUrls.append(v);
+                else if (!it.value().isEmpty()) newUrls.append(it.value());
+            }
+            record["imageUrls"] = newUrls;
+            records[i] = record;
+            changed = true;
+        }
+        if (changed) entry[field] = records;
+    }
+}
+
+QString MutationQueue::queueFilePath()
+{
+    return SiteRegistry::instance()->localDataPath("mutation_queue.json");
+}
+
+void MutationQueue::load()
+{
+    // 队列属于载入时的站点，之后一直写回同一个文件，不会把这个站点的修改发到别的站点
+    m_filePath = queueFilePath();
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+
+    const QJsonObject root = QJsonDocument::fromJson(file.readAll()).object();
+    m_nextId = qMax(1, root["nextId"].toInt());
+    for (const QJsonValue &v : root["entries"].toArray()) {
+        if (v.isObject()) m_entries.append(v.toObject());
+    }
+    qDebug() << "Loaded" << m_entries.size() << "queued mutation(s) from last session";
+}
+
+// 变动后在事件循环空闲时合并写盘：批量导入一次排入上万项时只写一次文件
+void MutationQueue::persist()
+{
+    m_persistTimer->start();
+}
+
+void MutationQueue::writeToDisk()
+{
+    m_persistTimer->stop();
+
+    const QString &path = m_filePath;
+    if (m_entries.isEmpty()) {
+        QFile::remove(path);
+        return;
+    }
+
+    QJsonArray entries;
+    for (const auto &entry : std::as_const(m_entries)) entries.append(entry);
+    QJsonObject root;
+    root["nextId"] = m_nextId;
+    root["entries"] = entries;
+
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (file.open(QIODevice::WriteOnly | QIODevice::Truncate))
+        file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+    else
+        qDebug() << "Cannot write mutation queue to" << path;
+}
@@ -0,0 +1,117 @@
+// mutationqueue.h
+#ifndef MUTATIONQUEUE_H
+#define MUTATIONQUEUE_H
+
+#include <QObject>
+#include <QList>
+#include <QJsonObject>
+#include <QJsonArray>
+#include <QHash>
+#include "datastructures.h"
+
+class QTimer;
+class BatchRequest;
+struct NetworkResult;
+
+// --- 离线修改队列 ---
+// 断网时，各模块的保存和图片上传不再直接报错，而是进入这个队列并立即写入当前站点的本地文件（见 SiteRegistry::localDataPath）。
+// 队列会定时探测服务器是否可达，恢复连接后按顺序重放；排队的图片先按内容去重（见 ImageDedupe），
+// 本地缓存或服务器已有的不再上传：
+//   - 服务器支持 batch 时，整个队列打包成一个批量请求，在服务器端一个事务内完成
+//   - 否则先逐个上传图片，把得到的真实地址替换进待保存数据里的占位地址，再发送保存请求
+//     （老版本服务器没有批量上传的接口，每张图片只能单独一个请求）
+// save_jobs / save_products 都是整表覆盖，同一种保存在队列里只保留最新的一份，
+// 所以离线期间无论改了多少次，恢复后每种数据都只需要一次请求。
+// 整表保存排队时一并记下当时的基准版本（DataStore::syncBase）；重放前先取回服务器的最新数据，
+// 与管理模块的在线保存一样做三方合并（见 RecordMerge），离线期间其他管理员保存的修改不会被覆盖。
+// 服务器拒绝或出错（不是断网）时按递增的间隔重试；同一项多次失败后暂停，不再拖住其余的项，
+// 状态栏给出入口，由用户查看原因后重试或放弃。
+class MutationQueue : public QObject
+{
+    Q_OBJECT
+
+public:
+    static MutationQueue *instance();
+
+    // 重放时使用的会话密钥（队列本身不持久化密钥）
+    void setSessionKey(const QString &sessionKey);
+
+    bool isOffline() const { return m_offline; }
+    bool isReplaying() const { return m_replaying; }
+    int pendingCount() const { return m_entries.size(); }
+
+    // 排队一张待上传的图片，返回可以先写进 imageUrls 的占位地址
+    QString enqueueUpload(const QString &type, const QString &filePath);
+
+    // 排队一次整表保存（save_jobs / save_products），会替换队列中同类的旧保存
+    void enqueueSave(const QList<Job> &jobs);
+    void enqueueSave(const QList<Product> &products);
+
+    // 某个模块的请求因为连不上服务器而失败时调用，进入离线模式并开始探测
+    void reportOffline();
+
+    // 多次重试仍然失败、已暂停自动同步的项
+    struct HeldEntry {
+        int id = 0;
+        QString action;
+        int attempts = 0;
+        QString lastError;
+    };
+    int heldCount() const;
+    QList<HeldEntry> heldEntries() const;
+    // 重新开始同步暂停的项（重试次数清零）
+    void retryHeld();
+    // 放弃一项修改；放弃的图片会从待保存数据中去掉
+    void discard(int id);
+
+    static bool isPlaceholder(const QString &url);
+    // 队列项的中文名称，用于界面提示
+    static QString describe(const QString &action);
+
+signals:
+    void pendingCountChanged(int count);
+    void offlineChanged(bool offline);
+    void replayFinished();
+    void replayError(const QString &message);
+    void heldChanged(int count);
+
+private slots:
+    void probe();
+
+private:
+    explicit MutationQueue(QObject *parent = nullptr);
+
+    // 每项：id, action, 以及 records/base（整表保存，本地格式）或 type/path/placeholder/hash（图片）。
+    // 旧版本写下的整表保存只有 payload（服务器格式），重放时不合并
+    QList<QJsonObject> m_entries;
+    int m_nextId = 1;
+    bool m_offline = false;
+    bool m_replaying = false;
+    QString m_sessionKey;
+    QString m_filePath; // 当前站点的队列文件
+    QTimer *m_probeTimer;
+    QTimer *m_persistTimer;
+    QTimer *m_retryTimer;
+
+    void load();
+    void persist();
+    void writeToDisk();
+    void setOffline(bool offline);
+    void startReplay();
+    void dedupeUploads();
+    void mergeIfNeeded();
+    void enqueueSave(const QString &action, const QJsonArray &records, const QJsonArray &base);
+    void mergeWithServer();
+    void continueReplay();
+    static QJsonArray wirePayload(const QJsonObject &entry);
+    void replayNext();
+    void replayBatch();
+    void handleBatchResult(const NetworkResult &result, const BatchRequest &batch, const QList<int> &ids);
+    void onReplayResult(const NetworkResult &result, int id);
+    void replayFailed(const QList<int> &ids, const QString &message);
+    void removeEntry(int id);
+    void replacePlaceholders(const QHash<QString, QString> &urls);
+    static QString queueFilePath();
+};
+
+#endif // MUTATIONQUEUE_H
@@ -0,0 +1,264 @@
+// networksession.cpp
+#include "networksession.h"
+#include "formbodywriter.h"
+#include "siteregistry.h"
+#include "tracelog.h"
+
+#include <QNetworkAccessManager>
+#include <QHttpMultiPart>
+#include <QHttpPart>
+#include <QFile>
+#include <QFileInfo>
+#include <QUrlQuery>
+#include <QSettings>
+#include <QDateTime>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QDebug>
+
+#if QT_CONFIG(ssl)
+#include <QSslConfiguration>
+#endif
+
+namespace {
+
+// 服务器没有给出票据有效期时使用的保守默认值（秒）
+const int kDefaultTicketLifetime = 2 * 60 * 60;
+
+// 请求创建的时刻（TraceLog 微秒），完成时据此记录网络传输阶段；User + 1 已被离线队列使用，User + 3 见 NetworkThread
+const QNetworkRequest::Attribute kTraceStartAttribute = QNetworkRequest::Attribute(QNetworkRequest::User + 2);
+
+// 时间线上网络请求的名称：优先用 User 属性，其次是地址里的 action 参数
+QByteArray traceName(const QNetworkRequest &request)
+{
+    QString name = request.attribute(QNetworkRequest::User).toString();
+    if (name.isEmpty()) name = QUrlQuery(request.url()).queryItemValue("action");
+    return "request " + (name.isEmpty() ? QByteArray("(api)") : name.toUtf8());
+}
+
+#if QT_CONFIG(ssl)
+// 界面线程和网络线程都会读写共享的 TLS 配置
+QMutex sslMutex;
+
+// 票据在本地配置中的分组；默认站点沿用升级前的 tls/*，其余站点按主机名分开保存
+QString ticketGroup(const QString &host)
+{
+    static const QString defaultHost = QUrl(SiteRegistry::defaultApiUrl()).host();
+    return host == defaultHost ? QString("tls") : QString("tls/hosts/%1").arg(host);
+}
+
+// 每个主机一份进程内共享的 TLS 配置，第一次用到时从本地配置恢复尚未过期的会话票据；调用方需持有 sslMutex
+QSslConfiguration &sharedSslConfiguration(const QString &host)
+{
+    static QHash<QString, QSslConfiguration> configs;
+    auto it = configs.find(host);
+    if (it != configs.end()) return it.value();
+
+    QSslConfiguration c = QSslConfiguration::defaultConfiguration();
+    // 必须关闭“禁用会话持久化”选项，Qt 才会把票据交给我们保存
+    c.setSslOption(QSsl::SslOptionDisableSessionPersistence, false);
+
+    QSettings settings;
+    const QString group = ticketGroup(host);
+    const QDateTime expiry = settings.value(group + "/ticketExpiry").toDateTime();
+    if (expiry.isValid() && expiry > QDateTime::currentDateTimeUtc()) {
+        c.setSessionTicket(settings.value(group + "/sessionTicket").toByteArray());
+        qDebug() << "Restored TLS session ticket for" << host << "valid until" << expiry;
+    }
+    return configs.insert(host, c).value();
+}
+
+void storeSessionTicket(const QString &host, const QSslConfiguration &used)
+{
+    const QByteArray ticket = used.sessionTicket();
+    QMutexLocker locker(&sslMutex);
+    QSslConfiguration &shared = sharedSslConfiguration(host);
+    if (ticket.isEmpty() || ticket == shared.sessionTicket()) return;
+
+    shared.setSessionTicket(ticket);
+
+    int lifetime = used.sessionTicketLifeTimeHint();
+    if (lifetime <= 0) lifetime = kDefaultTicketLifetime;
+
+    QSettings settings;
+    const QString group = ticketGroup(host);
+    settings.setValue(group + "/sessionTicket", ticket);
+    settings.setValue(group + "/ticketExpiry", QDateTime::currentDateTimeUtc().addSecs(lifetime));
+}
+#endif
+
+} // namespace
+
+namespace NetworkSession {
+
+QUrl apiUrl()
+{
+    return SiteRegistry::instance()->currentSite().apiUrl;
+}
+
+QNetworkRequest apiRequest(const QString &action)
+{
+    return apiRequest(apiUrl(), action);
+}
+
+QNetworkRequest apiRequest(const QUrl &api, const QString &action)
+{
+    QUrl url = api;
+    if (!action.isEmpty()) {
+        QUrlQuery query;
+        query.addQueryItem("action", action);
+        url.setQuery(query);
+    }
+
+    QNetworkRequest request(url);
+    request.setAttribute(kTraceStartAttribute, TraceLog::now());
+#if QT_CONFIG(ssl)
+    QMutexLocker locker(&sslMutex);
+    request.setSslConfiguration(sharedSslConfiguration(url.host()));
+#endif
+    return request;
+}
+
+void attach(QNetworkAccessManager *manager)
+{
+    QObject::connect(manager, &QNetworkAccessManager::finished, manager, [](QNetworkReply *reply) {
+#if QT_CONFIG(ssl)
+        if (reply->error() == QNetworkReply::NoError)
+            storeSessionTicket(reply->url().host(), reply->sslConfiguration());
+#endif
+        // 从创建请求到收到完整响应（含排队、连接、上传和下载），并发请求互相重叠，记为异步时间段
+        const QVariant start = reply->request().attribute(kTraceStartAttribute);
+        if (!start.isValid() || isPrewarmReply(reply)) return;
+        const int status = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+        const QString detail = reply->error() == QNetworkReply::NoError
+                                   ? QString("HTTP %1").arg(status)
+                                   : QString("HTTP %1, %2").arg(status).arg(reply->errorString());
+        TraceLog::async("network", traceName(reply->request()), quintptr(reply), start.toLongLong(),
+                        TraceLog::now(), detail);
+    });
+}
+
+void prewarm(QNetworkAccessManager *manager)
+{
+    prewarm(manager, apiUrl());
+}
+
+void prewarm(QNetworkAccessManager *manager, const QUrl &url)
+{
+#if QT_CONFIG(ssl)
+    if (url.scheme() != "https") return;
+    QSslConfiguration config;
+    {
+        QMutexLocker locker(&sslMutex);
+        config = sharedSslConfiguration(url.host());
+    }
+    manager->connectToHostEncrypted(url.host(), url.port(443), config);
+#else
+    Q_UNUSED(manager);
+    Q_UNUSED(url);
+#endif
+}
+
+bool isPrewarmReply(const QNetworkReply *reply)
+{
+    // Qt 内部用 "preconnect-https" 协议名来标记 connectToHostEncrypted() 的请求
+    return reply->url().scheme().startsWith("preconnect");
+}
+
+bool isConnectivityError(QNetworkReply::NetworkError error)
+{
+    switch (error) {
+    case QNetworkReply::ConnectionRefusedError:
+    case QNetworkReply::RemoteHostClosedError:
+    case QNetworkReply::HostNotFoundError:
+    case QNetworkReply::TimeoutError:
+    case QNetworkReply::TemporaryNetworkFailureError:
+    case QNetworkReply::NetworkSessionFailedError:
+    case QNetworkReply::UnknownNetworkError:
+    case QNetworkReply::ProxyConnectionRefusedError:
+    case QNetworkReply::ProxyNotFoundError:
+    case QNetworkReply::ProxyTimeoutError:
+        return true;
+    default:
+        return false;
+    }
+}
+
+bool isUnknownAction(int httpStatus, const QJsonObject &reply)
+{
+    if (httpStatus == 404 || httpStatus == 501) return true;
+    if (reply["status"].toString() != "error") return false;
+    if (reply["code"].toString() == "unknown_action") return true;
+    const QString message = reply["message"].toString().toLower();
+    return message.contains("unknown action") || message.contains("invalid action")
+           || message.contains("未知操作") || message.contains("未知的操作");
+}
+
+QHttpMultiPart *createImageUpload(const QString &sessionKey, const QString &type, const QString &filePath,
+                                  const QString &contentHash)
+{
+    QFile *file = new QFile(filePath);
+    if (!file->open(QIODevice::ReadOnly)) {
+        delete file;
+        return nullptr;
+    }
+
+    QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+
+    QHttpPart actionPart;
+    actionPart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"action\""));
+    actionPart.setBody("upload_image");
+
+    QHttpPart keyPart;
+    keyPart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"key\""));
+    keyPart.setBody(sessionKey.toUtf8());
+
+    QHttpPart typePart;
+    typePart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"type\""));
+    typePart.setBody(type.toUtf8());
+
+    multiPart->append(actionPart);
+    multiPart->append(keyPart);
+    multiPart->append(typePart);
+
+    if (!contentHash.isEmpty()) {
+        QHttpPart hashPart;
+        hashPart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"hash\""));
+        hashPart.setBody(contentHash.toLatin1());
+        multiPart->append(hashPart);
+    }
+
+    QHttpPart imagePart;
+    imagePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("image/jpeg"));
+    imagePart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"image_file\"; filename=\""+ QFileInfo(filePath).fileName() +"\""));
+    imagePart.setBodyDevice(file);
+    file->setParent(multiPart);
+    multiPart->append(imagePart);
+
+    return multiPart;
+}
+
+QNetworkReply *postSave(QNetworkAccessManager *manager, const QString &sessionKey,
+                        const QString &action, const QJsonArray &payload,
+                        QNetworkRequest request)
+{
+    FormBodyWriter writer;
+    writer.addField("action", action);
+    writer.addField("key", sessionKey);
+    writer.beginJsonField("data");
+    writer.value(QJsonValue(payload));
+    return postForm(manager, action, writer.take(), request);
+}
+
+QNetworkReply *postForm(QNetworkAccessManager *manager, const QString &action, const QByteArray &body,
+                        QNetworkRequest request)
+{
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+    request.setAttribute(QNetworkRequest::User, action);
+    return manager->post(request, body);
+}
+
+} // namespace NetworkSession
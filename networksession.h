@@ -0,0 +1,64 @@
+// networksession.h
+#ifndef NETWORKSESSION_H
+#define NETWORKSESSION_H
+
+#include <QUrl>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+class QNetworkAccessManager;
+class QHttpMultiPart;
+class QJsonArray;
+class QJsonObject;
+
+// --- 所有模块共用的 API 连接设置 ---
+// 1. 统一提供 API 地址（SiteRegistry 中的当前站点），避免在各处硬编码
+// 2. 为每个请求附加同一份 TLS 配置（每个主机一份），使握手可以复用上一次的会话票据
+// 3. 会话票据保存在本地配置中，下次启动时直接恢复会话，省去完整握手
+namespace NetworkSession {
+
+QUrl apiUrl();
+
+// 生成指向当前站点 API 的请求；action 非空时作为 GET 参数附加在地址上
+QNetworkRequest apiRequest(const QString &action = QString());
+// 同上，但指向指定站点的 API（多站点同步使用）
+QNetworkRequest apiRequest(const QUrl &api, const QString &action = QString());
+
+// 让管理器在每次请求完成后记录最新的会话票据
+void attach(QNetworkAccessManager *manager);
+
+// 提前与 API 服务器建立加密连接（TCP + TLS 握手），
+// 后续同一管理器发出的请求可以直接复用这条连接
+void prewarm(QNetworkAccessManager *manager);
+void prewarm(QNetworkAccessManager *manager, const QUrl &api);
+
+// prewarm() 产生的预连接也会触发 finished 信号，响应处理函数需要先过滤掉它
+bool isPrewarmReply(const QNetworkReply *reply);
+
+// 判断一个错误是否意味着“连不上服务器”（断网、DNS失败、超时等），
+// 这类错误适合转入离线队列，而不是直接报错
+bool isConnectivityError(QNetworkReply::NetworkError error);
+
+// 服务器明确表示不认识这个 action（老版本服务器）：HTTP 404/501，或者响应为
+// {"status":"error","code":"unknown_action"}（也兼容只在 message 中说明的写法）。
+// 会话过期、参数错误等普通错误不算，调用方应当照常报告，不能据此停用新功能
+bool isUnknownAction(int httpStatus, const QJsonObject &reply);
+
+// 构造 upload_image 的表单数据；本地文件无法打开时返回 nullptr。
+// contentHash 非空时一并提交，服务器据此建立索引，之后 check_images 才能查到
+QHttpMultiPart *createImageUpload(const QString &sessionKey, const QString &type, const QString &filePath,
+                                  const QString &contentHash = QString());
+
+// 以表单方式发送 save_jobs / save_products 之类的整表保存；
+// 请求的 User 属性设为 action，调用方可以传入已经带有其它属性的 request
+QNetworkReply *postSave(QNetworkAccessManager *manager, const QString &sessionKey,
+                        const QString &action, const QJsonArray &payload,
+                        QNetworkRequest request = apiRequest());
+
+// 发送已经编码好的表单请求体（例如 DataSerializer::saveBody() 的结果），请求体不再复制
+QNetworkReply *postForm(QNetworkAccessManager *manager, const QString &action, const QByteArray &body,
+                        QNetworkRequest request = apiRequest());
+
+} // namespace NetworkSession
+
+#endif // NETWORKSESSION_H
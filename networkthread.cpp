@@ -0,0 +1,190 @@
+// networkthread.cpp
+#include "networkthread.h"
+#include "networksession.h"
+#include "tracelog.h"
+
+#include <QCoreApplication>
+#include <QNetworkAccessManager>
+#include <QThread>
+#include <QTimer>
+#include <QJsonDocument>
+#include <QDebug>
+#include <atomic>
+
+namespace {
+// 取结果的节奏与屏幕刷新一致
+const int kFrameIntervalMs = 16;
+// 退出时等待网络线程结束的上限
+const int kStopTimeoutMs = 1000;
+} // namespace
+
+// 每个请求最新的上传进度，网络线程写、界面线程读
+struct NetworkThread::Progress {
+    std::atomic<qint64> sent{0};
+    std::atomic<qint64> total{0};
+    std::atomic<bool> changed{false};
+};
+
+// 运行在网络线程中的对象：持有管理器以及在途的请求
+class NetworkWorker : public QObject
+{
+public:
+    QNetworkAccessManager *manager = nullptr;
+    QHash<quint64, QPointer<QNetworkReply>> replies;
+};
+
+NetworkThread *NetworkThread::instance()
+{
+    static NetworkThread *thread = new NetworkThread(qApp);
+    return thread;
+}
+
+NetworkThread::NetworkThread(QObject *parent)
+    : QObject(parent)
+    , m_thread(new QThread(this))
+    , m_worker(new NetworkWorker)
+    , m_frameTimer(new QTimer(this))
+{
+    m_thread->setObjectName("NetworkThread");
+    m_worker->moveToThread(m_thread);
+    connect(m_thread, &QThread::finished, m_worker, &QObject::deleteLater);
+
+    m_frameTimer->setInterval(kFrameIntervalMs);
+    m_frameTimer->setTimerType(Qt::PreciseTimer);
+    connect(m_frameTimer, &QTimer::timeout, this, &NetworkThread::drain);
+
+    m_thread->start();
+    // 管理器必须在它所属的线程里创建
+    NetworkWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker]() {
+        worker->manager = new QNetworkAccessManager(worker);
+        NetworkSession::attach(worker->manager);
+        NetworkSession::prewarm(worker->manager);
+    }, Qt::QueuedConnection);
+
+    connect(qApp, &QCoreApplication::aboutToQuit, this, &NetworkThread::stopThread);
+}
+
+NetworkThread::~NetworkThread()
+{
+    stopThread();
+}
+
+void NetworkThread::stopThread()
+{
+    if (!m_thread->isRunning()) return;
+    m_thread->quit();
+    if (!m_thread->wait(kStopTimeoutMs))
+        qDebug() << "Network thread did not stop within" << kStopTimeoutMs << "ms";
+}
+
+quint64 NetworkThread::submit(const QString &tag, RequestFactory factory, QObject *context,
+                              ResultCallback onFinished, ProgressCallback onProgress)
+{
+    const quint64 id = m_nextId++;
+
+    Pending pending;
+    pending.context = context;
+    pending.hasContext = (context != nullptr);
+    pending.onFinished = std::move(onFinished);
+    pending.onProgress = std::move(onProgress);
+    QSharedPointer<Progress> progress;
+    if (pending.onProgress) {
+        progress = QSharedPointer<Progress>::create();
+        pending.progress = progress;
+    }
+    m_pending.insert(id, pending);
+    if (!m_frameTimer->isActive()) m_frameTimer->start();
+
+    // 时间线：排队等待网络线程 -> 构造请求 -> 传输（由 NetworkSession::attach 记录）-> 解码 -> 界面线程回调
+    NetworkWorker *worker = m_worker;
+    LockFreeQueue<NetworkResult> *results = &m_results;
+    const qint64 submittedAt = TraceLog::now();
+    QMetaObject::invokeMethod(worker, [worker, results, id, tag, factory, progress, submittedAt]() {
+        TraceLog::async("network", "queued " + tag.toUtf8(), id, submittedAt, TraceLog::now());
+        QNetworkReply *reply = nullptr;
+        {
+            TraceLog::Span span("network", "build " + tag.toUtf8());
+            reply = factory(worker->manager);
+        }
+        if (!reply) {
+            NetworkResult result;
+            result.id = id;
+            result.tag = tag;
+            result.error = QNetworkReply::ContentNotFoundError;
+            result.errorString = "无法发出请求（本地文件不可读？）";
+            results->push(result);
+            return;
+        }
+        worker->replies.insert(id, reply);
+        if (progress) {
+            QObject::connect(reply, &QNetworkReply::uploadProgress, reply, [progress](qint64 sent, qint64 total) {
+                progress->sent.store(sent, std::memory_order_relaxed);
+                progress->total.store(total, std::memory_order_relaxed);
+                progress->changed.store(true, std::memory_order_release);
+            });
+        }
+        QObject::connect(reply, &QNetworkReply::finished, reply, [worker, results, reply, id, tag]() {
+            worker->replies.remove(id);
+            TraceLog::Span span("network", "decode " + tag.toUtf8());
+            NetworkResult result = decode(reply);
+            result.id = id;
+            result.tag = tag;
+            results->push(std::move(result));
+            reply->deleteLater();
+        });
+    }, Qt::QueuedConnection);
+
+    return id;
+}
+
+void NetworkThread::abort(quint64 id)
+{
+    NetworkWorker *worker = m_worker;
+    QMetaObject::invokeMethod(worker, [worker, id]() {
+        QPointer<QNetworkReply> reply = worker->replies.value(id);
+        if (reply) reply->abort();
+    }, Qt::QueuedConnection);
+}
+
+NetworkResult NetworkThread::decode(QNetworkReply *reply)
+{
+    NetworkResult result;
+    result.tag = reply->request().attribute(QNetworkRequest::User).toString();
+    result.error = reply->error();
+    result.errorString = reply->errorString();
+    result.httpStatus = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    result.etag = reply->rawHeader("ETag");
+    result.lastModified = reply->rawHeader("Last-Modified");
+    result.body = reply->readAll();
+    if (reply->request().attribute(RawBodyAttribute).toBool()) return result;
+    const QJsonDocument doc = QJsonDocument::fromJson(result.body);
+    if (doc.isObject()) result.json = doc.object();
+    return result;
+}
+
+void NetworkThread::drain()
+{
+    // 先报进度，再交付结果，保证进度条不会在完成之后又跳回去。
+    // 回调里可能提交新请求，所以遍历的是一份（隐式共享的）副本
+    const QHash<quint64, Pending> snapshot = m_pending;
+    for (auto it = snapshot.cbegin(); it != snapshot.cend(); ++it) {
+        const Pending &pending = it.value();
+        if (pending.progress && pending.progress->changed.exchange(false, std::memory_order_acquire)) {
+            if (!pending.hasContext || pending.context)
+                pending.onProgress(pending.progress->sent.load(std::memory_order_relaxed),
+                                   pending.progress->total.load(std::memory_order_relaxed));
+        }
+    }
+
+    NetworkResult result;
+    while (m_results.tryPop(result)) {
+        const Pending pending = m_pending.take(result.id);
+        if (pending.onFinished && (!pending.hasContext || pending.context)) {
+            TraceLog::Span span("ui", "callback " + result.tag.toUtf8());
+            pending.onFinished(result);
+        }
+    }
+
+    if (m_pending.isEmpty()) m_frameTimer->stop();
+}
@@ -0,0 +1,90 @@
+// networkthread.h
+#ifndef NETWORKTHREAD_H
+#define NETWORKTHREAD_H
+
+#include <QObject>
+#include <QHash>
+#include <QPointer>
+#include <QSharedPointer>
+#include <QJsonObject>
+#include <QNetworkReply>
+#include <functional>
+#include "lockfreequeue.h"
+
+class QNetworkAccessManager;
+class QThread;
+class QTimer;
+class NetworkWorker;
+
+// 网络线程上已经读取并解析好的响应
+struct NetworkResult {
+    quint64 id = 0;
+    QString tag; // 提交时给的标记，通常就是 action
+    QNetworkReply::NetworkError error = QNetworkReply::NoError;
+    QString errorString;
+    int httpStatus = 0;
+    QByteArray body;
+    QJsonObject json; // body 是 JSON 对象时已解析好（请求带 RawBodyAttribute 时不解析）
+    // 缓存校验用的响应头，条件请求（If-None-Match / If-Modified-Since）时带回
+    QByteArray etag;
+    QByteArray lastModified;
+
+    bool ok() const { return error == QNetworkReply::NoError; }
+};
+
+// --- 独立的网络 I/O 线程 ---
+// 请求在专用线程自己的事件循环里发出和接收，界面线程被模态对话框或大量重绘占住时，
+// 上传下载照常进行。响应在网络线程上读完并解析成 NetworkResult，
+// 通过无锁队列交回界面线程；界面线程每一帧（约 16ms）统一取出并调用回调，
+// 上传进度也以原子变量的形式每帧取一次最新值。
+class NetworkThread : public QObject
+{
+    Q_OBJECT
+
+public:
+    // 在网络线程中调用，用给定的管理器发出请求；返回 nullptr 表示无法发出（例如本地文件读不了）
+    using RequestFactory = std::function<QNetworkReply *(QNetworkAccessManager *manager)>;
+    using ResultCallback = std::function<void(const NetworkResult &result)>;
+    using ProgressCallback = std::function<void(qint64 sent, qint64 total)>;
+
+    static NetworkThread *instance();
+
+    // 请求带有这个属性（值为 true）时，响应体原样交回，不解析成 json；
+    // 用于 get_all_data 这类由调用方选择解析方式（JsonBackend）的大响应
+    static constexpr QNetworkRequest::Attribute RawBodyAttribute = QNetworkRequest::Attribute(QNetworkRequest::User + 3);
+
+    // 提交一个请求，返回请求编号。回调在界面线程调用；context 被销毁后不再回调
+    quint64 submit(const QString &tag, RequestFactory factory, QObject *context,
+                   ResultCallback onFinished, ProgressCallback onProgress = ProgressCallback());
+    void abort(quint64 id);
+
+    // 读取并解析一个已完成的响应（任何线程都可以用）
+    static NetworkResult decode(QNetworkReply *reply);
+
+private slots:
+    void drain();
+
+private:
+    explicit NetworkThread(QObject *parent = nullptr);
+    ~NetworkThread();
+
+    struct Progress;
+    struct Pending {
+        QPointer<QObject> context;
+        bool hasContext = false;
+        ResultCallback onFinished;
+        ProgressCallback onProgress;
+        QSharedPointer<Progress> progress;
+    };
+
+    QThread *m_thread;
+    NetworkWorker *m_worker; // 属于网络线程，持有 QNetworkAccessManager
+    LockFreeQueue<NetworkResult> m_results;
+    QHash<quint64, Pending> m_pending; // 只在界面线程访问
+    QTimer *m_frameTimer;
+    quint64 m_nextId = 1;
+
+    void stopThread();
+};
+
+#endif // NETWORKTHREAD_H
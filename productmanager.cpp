@@ -1,12 +1,27 @@
 // productmanager.cpp (生产级最终版)
 #include "productmanager.h"
 #include "ui_productmanager.h"
+#include "networksession.h"
+#include "networkthread.h"
+#include "shutdowncoordinator.h"
+#include "dataserializer.h"
+#include "mutationqueue.h"
+#include "batchclient.h"
+#include "bulkimporter.h"
+#include "imagededupe.h"
+#include "imagegallery.h"
+#include "stallwatchdog.h"
+#include "bulkeditpanel.h"
+#include "recordlocks.h"
+#include "linkchecker.h"
+#include "recordmerge.h"
+#include "jsonbackend.h"
 
 #include <QMessageBox>
 #include <QFileDialog>
 #include <QHttpMultiPart>
-#include <QHttpPart>
 #include <QFileInfo>
+#include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QUrl>
@@ -15,25 +30,92 @@
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QListWidgetItem>
+#include <QTimer>
+#include <QFutureWatcher>
+#include <QtConcurrent/QtConcurrentRun>
+#include <algorithm>
 #include <QDebug> // 用于调试
 
 ProductManager::ProductManager(const QString &sessionKey, QWidget *parent) :
     QWidget(parent),
     ui(new Ui::ProductManager),
-    m_networkManager(new QNetworkAccessManager(this)),
     m_sessionKey(sessionKey),
-    m_currentUploadingSlot(0)
+    m_gallery(new GalleryModel(this))
 {
     ui->setupUi(this);
 
-    // --- [核心修正] 移除所有重复的手动connect，只保留一个统一的网络处理器 ---
-    connect(m_networkManager, &QNetworkAccessManager::finished,
-            this,             &ProductManager::onNetworkReply);
-
     // 初始状态
     ui->uploadProgressBar->hide();
     ui->productBox->setEnabled(false);
     ui->saveProductButton->setEnabled(false);
+    ui->productPathButton->setToolTip("从 CSV 或 JSON Lines 文件批量导入产品");
+
+    m_gallery->setThumbnailSize(ui->imageGalleryView->iconSize() * ui->imageGalleryView->devicePixelRatioF());
+    ui->imageGalleryView->setModel(m_gallery);
+
+    // 文本字段直接绑定到当前产品，编辑时立即写回；图片由图库管理，保存或切换产品时再同步
+    m_form.setForm(this);
+    m_form.bind(ui->productNameEdit,         &Product::name);
+    m_form.bind(ui->productCategoryComboBox, &Product::category);
+    m_form.bind(ui->productDescriptionEdit,  &Product::description);
+    m_form.onEdited([this](QString Product::*field, const QString &text) {
+        const int idx = currentProductIndex();
+        if (idx < 0 || idx >= products().size()) return;
+        Product p = *products()[idx];
+        p.*field = text;
+        DataStore::instance()->setProduct(idx, p);
+        if (field == &Product::name) {
+            updateItemMark(ui->productListWidget->currentRow());
+            m_relockTimer->start();
+        }
+    });
+
+    // 编辑锁按产品名称标识：改名后等输入停下来再换锁，不必每次按键都释放、申请一次
+    m_relockTimer = new QTimer(this);
+    m_relockTimer->setSingleShot(true);
+    m_relockTimer->setInterval(800);
+    connect(m_relockTimer, &QTimer::timeout, this, &ProductManager::relockRenamed);
+    connect(m_gallery, &GalleryModel::itemsChanged, this, &ProductManager::updateImageCount);
+
+    // 列表可以多选，选中多个产品时显示批量修改面板
+    ui->productListWidget->setSelectionMode(QAbstractItemView::ExtendedSelection);
+    m_bulkPanel = new BulkEditPanel(this);
+    m_bulkPanel->setFields(BulkEdit::fields(DataStore::Products));
+    QStringList categories;
+    for (int i = 0; i < ui->productCategoryComboBox->count(); ++i) categories.append(ui->productCategoryComboBox->itemText(i));
+    m_bulkPanel->setSuggestions("category", categories);
+    ui->productListBox->addWidget(m_bulkPanel);
+    connect(ui->productListWidget, &QListWidget::itemSelectionChanged, this, [this]() {
+        m_bulkPanel->setSelectionCount(int(ui->productListWidget->selectedItems().size()));
+    });
+    connect(m_bulkPanel, &BulkEditPanel::applyRequested, this, &ProductManager::onBulkApply);
+    connect(m_bulkPanel, &BulkEditPanel::undoRequested, this, &ProductManager::onBulkUndo);
+    connect(m_bulkPanel, &BulkEditPanel::redoRequested, this, &ProductManager::onBulkRedo);
+
+    // 数据来自全局快照；标签页懒加载时，创建前已经同步到的数据直接拿来显示
+    auto *store = DataStore::instance();
+    m_snapshot = store->current();
+    connect(store, &DataStore::dataReset, this, &ProductManager::onDataReset);
+    connect(store, &DataStore::dataEdited, this, &ProductManager::onDataEdited);
+
+    // 其他管理员正在编辑的产品在列表中标出，选中时只读
+    auto *locks = RecordLocks::instance();
+    connect(locks, &RecordLocks::acquireFinished, this, &ProductManager::onLockAcquired);
+    connect(locks, &RecordLocks::lockLost, this, &ProductManager::onLockLost);
+    connect(locks, &RecordLocks::locksChanged, this, [this](const QString &type) {
+        if (type == "products") updateItemMarks();
+    });
+
+    // 后台链接检查发现失效图片时在列表中标出
+    auto *links = LinkChecker::instance();
+    connect(links, &LinkChecker::resultsChanged, this, &ProductManager::updateItemMarks);
+    connect(links, &LinkChecker::scanFinished, this, [this](int, int broken) {
+        if (broken > 0 && m_saveWorkId == 0)
+            ui->statusbarLabel->setText(QString("图片链接检查完成：%1 张图片已失效，已在列表中标出").arg(broken));
+    });
+
+    updateFacetComboBox();
+    if (!products().isEmpty()) updateProductListWidget();
 }
 
 ProductManager::~ProductManager()
@@ -41,13 +123,95 @@ ProductManager::~ProductManager()
     delete ui;
 }
 
-// 由主窗口调用，更新产品列表
-void ProductManager::updateData(const QList<Product> &products)
+void ProductManager::onDataReset(SnapshotPtr snapshot, DataStore::Sections sections)
+{
+    m_snapshot = snapshot;
+    if (sections & DataStore::Products) {
+        // 整体替换后记录都换了新的，之前的批量修改已经无从撤销
+        m_bulkHistory.clear();
+        updateBulkPanel();
+        updateFacetComboBox();
+        updateProductListWidget();
+    }
+}
+
+void ProductManager::onDataEdited(SnapshotPtr snapshot, DataStore::Sections sections)
 {
-    m_products = products;
+    const SnapshotPtr previous = m_snapshot;
+    m_snapshot = snapshot;
+    if (!(sections & DataStore::Products)) return;
+    // 分类数量随编辑实时更新；列表本身保持不动，直到切换筛选或增删产品。
+    // 输入名称、描述等每次按键都会发出修改，分类没有增减时只改变化了的数量，不重建下拉框
+    if (previous->productCategories.categories() == snapshot->productCategories.categories())
+        updateFacetCounts();
+    else
+        updateFacetComboBox();
+}
+
+int ProductManager::currentProductIndex() const
+{
+    return m_visibleRows.value(ui->productListWidget->currentRow(), -1);
+}
+
+int ProductManager::productIndexOf(QListWidgetItem *item) const
+{
+    return m_visibleRows.value(ui->productListWidget->row(item), -1);
+}
+
+void ProductManager::selectProduct(int index)
+{
+    auto it = std::lower_bound(m_visibleRows.cbegin(), m_visibleRows.cend(), index);
+    if (it == m_visibleRows.cend() || *it != index) {
+        m_filterByCategory = false;
+        updateFacetComboBox();
+        updateProductListWidget();
+        it = std::lower_bound(m_visibleRows.cbegin(), m_visibleRows.cend(), index);
+    }
+    ui->productListWidget->setCurrentRow(int(it - m_visibleRows.cbegin()));
+}
+
+void ProductManager::on_categoryFacetComboBox_currentIndexChanged(int index)
+{
+    // 先记下新的筛选条件：写回表单时会重建下拉框，index 之后就不可靠了
+    const QVariant category = ui->categoryFacetComboBox->itemData(index);
+    const int current = currentProductIndex();
+    m_filterByCategory = category.isValid();
+    m_categoryFilter = category.toString();
+
+    if (current >= 0) syncGalleryToData(current);
     updateProductListWidget();
 }
 
+void ProductManager::restoreUnfinishedWork(const QJsonObject &state)
+{
+    DataStore::instance()->resetProducts(DataSerializer::productsFromJson(state["products"].toArray()));
+
+    const int index = state["currentIndex"].toInt(-1);
+    if (index < 0 || index >= products().count()) return;
+    selectProduct(index);
+
+    // populateForm 会清空待上传图片，所以要在选中之后再恢复
+    QStringList paths;
+    for (const QJsonValue &v : state["imagePaths"].toArray()) paths.append(v.toString());
+    // 旧版本只有两个图片槽位
+    for (const char *key : {"imagePath1", "imagePath2"}) {
+        if (!state[key].toString().isEmpty()) paths.append(state[key].toString());
+    }
+    m_gallery->addLocalFiles(paths);
+    ui->statusbarLabel->setText("已恢复上次退出时未保存完成的修改，请确认后重新保存");
+}
+
+QJsonObject ProductManager::resumeState() const
+{
+    QJsonObject state;
+    state["products"] = DataSerializer::toJsonArray(m_snapshot->productValues());
+    state["currentIndex"] = currentProductIndex();
+    QJsonArray paths;
+    for (const GalleryItem &item : m_gallery->pendingItems()) paths.append(item.localPath);
+    state["imagePaths"] = paths;
+    return state;
+}
+
 
 // --- UI 交互 (由Qt自动连接触发) ---
 void ProductManager::on_addProduct_clicked()
@@ -55,21 +219,21 @@ void ProductManager::on_addProduct_clicked()
     Product p;
     p.name = "新产品 - 请修改";
     p.category = ui->productCategoryComboBox->currentText();
-    m_products.append(p);
+    DataStore::instance()->insertProduct(products().count(), p);
     updateProductListWidget();
-    ui->productListWidget->setCurrentRow(m_products.count()-1);
+    selectProduct(products().count()-1);
 }
 
 void ProductManager::on_deleteProduct_clicked()
 {
-    int row = ui->productListWidget->currentRow();
+    int row = currentProductIndex();
     if (row < 0) return;
 
     auto reply = QMessageBox::question(this, "确认删除",
-                                       QString("确定删除产品 '%1' ?").arg(m_products[row].name),
+                                       QString("确定删除产品 '%1' ?").arg(products()[row]->name),
                                        QMessageBox::Yes | QMessageBox::No);
     if (reply == QMessageBox::Yes) {
-        m_products.removeAt(row);
+        DataStore::instance()->removeProduct(row);
         updateProductListWidget();
     }
 }
@@ -77,37 +241,313 @@ void ProductManager::on_deleteProduct_clicked()
 void ProductManager::on_productListWidget_currentItemChanged(QListWidgetItem *current, QListWidgetItem *previous)
 {
     if (previous) {
-        int prevIdx = ui->productListWidget->row(previous);
-        if (prevIdx >= 0) syncFormToData(prevIdx);
+        int prevIdx = productIndexOf(previous);
+        if (prevIdx >= 0) syncGalleryToData(prevIdx);
     }
 
-    int idx = ui->productListWidget->row(current);
+    int idx = productIndexOf(current);
     bool isValidIndex = (idx >= 0);
     ui->productBox->setEnabled(isValidIndex);
     ui->saveProductButton->setEnabled(isValidIndex);
 
     if (isValidIndex) populateForm(idx);
     else clearForm();
+    requestEditLock(idx);
 }
 
-void ProductManager::on_selectImageButton1_clicked()
+void ProductManager::requestEditLock(int index)
 {
-    QString file = QFileDialog::getOpenFileName(this, "选择图片1", "", "Images (*.png *.jpg *.bmp)");
-    if (file.isEmpty()) return;
-    m_localImagePath1 = file;
-    ui->productImgPath_1->setText(QFileInfo(file).fileName());
-    ui->imagePreviewLabel1->setPixmap(QPixmap(file).scaled(ui->imagePreviewLabel1->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    const QString record = (index >= 0 && index < products().size()) ? products()[index]->name : QString();
+    if (!record.isEmpty() && record == m_lockRecord) return;
+    if (!m_lockRecord.isEmpty()) RecordLocks::instance()->release("products", m_lockRecord);
+    m_lockRecord.clear();
+    m_pendingLock = record;
+    if (record.isEmpty()) return;
+
+    // 申请到锁之前表单只读；服务器不支持记录锁时会立即得到结果
+    ui->productBox->setEnabled(false);
+    RecordLocks::instance()->acquire("products", record);
+}
+
+// 改名并不真正受记录锁保护（见 RecordLocks）：这里只是让锁跟上新名称
+void ProductManager::relockRenamed()
+{
+    const int index = currentProductIndex();
+    if (index < 0 || index >= products().size() || m_lockRecord.isEmpty()) return;
+    const QString record = products()[index]->name;
+    if (record.isEmpty() || record == m_lockRecord || record == m_pendingLock) return;
+
+    RecordLocks::instance()->release("products", m_lockRecord);
+    m_lockRecord.clear();
+    m_pendingLock = record;
+    // 表单保持可编辑，不打断正在输入的名称；新名称已被别人锁住时再转为只读
+    RecordLocks::instance()->acquire("products", record);
+}
+
+void ProductManager::onLockAcquired(const QString &type, const QString &record, bool granted, const QString &holder)
+{
+    if (type != "products") return;
+    if (record != m_pendingLock) {
+        // 申请期间切换了选中或改了名称，已经用不上的锁立即放回
+        if (granted && record != m_lockRecord) RecordLocks::instance()->release("products", record);
+        return;
+    }
+    m_pendingLock.clear();
+    if (granted) {
+        m_lockRecord = record;
+        ui->productBox->setEnabled(true);
+    } else {
+        ui->productBox->setEnabled(false);
+        ui->statusbarLabel->setText(QString("“%1”正在由 %2 编辑，暂时只读").arg(record, holder));
+    }
+}
+
+void ProductManager::onLockLost(const QString &type, const QString &record)
+{
+    if (type != "products" || record != m_lockRecord) return;
+    // 租约过期（例如网络中断过一段时间）：重新申请，拿不到时转为只读
+    m_lockRecord.clear();
+    m_pendingLock = record;
+    ui->productBox->setEnabled(false);
+    RecordLocks::instance()->acquire("products", record);
+}
+
+void ProductManager::updateItemMarks()
+{
+    const int count = qMin(ui->productListWidget->count(), int(m_visibleRows.size()));
+    for (int row = 0; row < count; ++row) updateItemMark(row);
+}
+
+// 列表中一行的文字、颜色和提示：产品名称加上编辑锁和失效图片的标记
+void ProductManager::updateItemMark(int row)
+{
+    QListWidgetItem *item = ui->productListWidget->item(row);
+    if (!item || row >= m_visibleRows.size()) return;
+    const Product &p = *products()[m_visibleRows[row]];
+    const QString holder = RecordLocks::instance()->otherHolder("products", p.name);
+    const int broken = LinkChecker::instance()->brokenUrls(p.imageUrls).size();
+
+    QString text = p.name;
+    QStringList tips;
+    if (!holder.isEmpty()) {
+        text += QString("（%1 正在编辑）").arg(holder);
+        tips.append(QString("%1 正在编辑这个产品").arg(holder));
+    }
+    if (broken > 0) {
+        text += QString("（%1 张图片失效）").arg(broken);
+        tips.append(QString("%1 张图片的地址已无法访问，请重新上传或移除").arg(broken));
+    }
+    item->setText(text);
+    item->setForeground(!holder.isEmpty() ? QBrush(Qt::gray) : broken > 0 ? QBrush(Qt::red) : QBrush());
+    item->setToolTip(tips.join("\n"));
 }
 
-void ProductManager::on_selectImageButton2_clicked()
+void ProductManager::on_addImagesButton_clicked()
 {
-    QString file = QFileDialog::getOpenFileName(this, "选择图片2", "", "Images (*.png *.jpg *.bmp)");
+    const QStringList files = QFileDialog::getOpenFileNames(this, "添加图片", "", "Images (*.png *.jpg *.bmp)");
+    m_gallery->addLocalFiles(files);
+    if (!files.isEmpty()) ui->imageGalleryView->scrollToBottom();
+}
+
+void ProductManager::on_removeImagesButton_clicked()
+{
+    QList<int> rows;
+    for (const QModelIndex &index : ui->imageGalleryView->selectionModel()->selectedIndexes())
+        rows.append(index.row());
+    m_gallery->removeItems(rows);
+}
+
+void ProductManager::updateImageCount()
+{
+    const int pending = m_gallery->pendingItems().size();
+    QString text = QString("共 %1 张").arg(m_gallery->rowCount());
+    if (pending > 0) text += QString("，%1 张待上传").arg(pending);
+    ui->imageCountLabel->setText(text);
+}
+
+QList<int> ProductManager::selectedProductIndexes() const
+{
+    QList<int> indexes;
+    for (QListWidgetItem *item : ui->productListWidget->selectedItems()) {
+        const int index = productIndexOf(item);
+        if (index >= 0) indexes.append(index);
+    }
+    std::sort(indexes.begin(), indexes.end());
+    return indexes;
+}
+
+void ProductManager::updateBulkPanel()
+{
+    m_bulkPanel->setHistory(m_bulkHistory.canUndo() ? m_bulkHistory.nextUndo().description() : QString(),
+                            m_bulkHistory.canRedo() ? m_bulkHistory.nextRedo().description() : QString());
+}
+
+// 批量修改不涉及图片，只需刷新表单中的文本字段；图库里尚未上传的图片保持不动
+void ProductManager::refreshAfterBulkEdit()
+{
+    updateBulkPanel();
+    const int index = currentProductIndex();
+    if (index >= 0) m_form.setRecord(products()[index]);
+    updateItemMarks();
+}
+
+void ProductManager::onBulkApply(const QString &field, const QString &value)
+{
+    if (m_saveWorkId != 0) {
+        ui->statusbarLabel->setText("正在保存，请稍后再批量修改");
+        return;
+    }
+
+    // 其他管理员正在编辑的产品跳过
+    QList<int> indexes;
+    QStringList locked;
+    for (int index : selectedProductIndexes()) {
+        const QString &name = products()[index]->name;
+        if (RecordLocks::instance()->otherHolder("products", name).isEmpty()) indexes.append(index);
+        else locked.append(name);
+    }
+
+    const BulkEdit::Edit edit = BulkEdit::apply(DataStore::Products, indexes, field, value);
+    if (!locked.isEmpty())
+        QMessageBox::information(this, "部分产品未修改", "以下产品正在由其他管理员编辑，已跳过：\n" + locked.join("\n"));
+    if (edit.isEmpty()) {
+        ui->statusbarLabel->setText("选中的产品不需要修改");
+        return;
+    }
+    m_bulkHistory.push(edit);
+    refreshAfterBulkEdit();
+    submitBulkPatch(edit.result(), edit.description());
+}
+
+void ProductManager::onBulkUndo()
+{
+    if (!m_bulkHistory.canUndo() || m_saveWorkId != 0) return;
+    const QString what = "撤销" + m_bulkHistory.nextUndo().description();
+    const BulkEdit::Patch patch = m_bulkHistory.undo();
+    refreshAfterBulkEdit();
+    if (patch.isEmpty()) {
+        ui->statusbarLabel->setText("这些产品之后都已被修改或删除，没有需要恢复的内容");
+        return;
+    }
+    submitBulkPatch(patch, what);
+}
+
+void ProductManager::onBulkRedo()
+{
+    if (!m_bulkHistory.canRedo() || m_saveWorkId != 0) return;
+    const QString what = "重做" + m_bulkHistory.nextRedo().description();
+    const BulkEdit::Patch patch = m_bulkHistory.redo();
+    refreshAfterBulkEdit();
+    if (patch.isEmpty()) {
+        ui->statusbarLabel->setText("这些产品之后都已被修改或删除，没有需要重做的内容");
+        return;
+    }
+    submitBulkPatch(patch, what);
+}
+
+void ProductManager::submitBulkPatch(const BulkEdit::Patch &patch, const QString &what)
+{
+    auto *queue = MutationQueue::instance();
+    if (queue->isOffline() || queue->pendingCount() > 0) {
+        queueSaveOffline();
+        return;
+    }
+    if (!BulkEdit::isSupported()) {
+        startSavingProcess();
+        return;
+    }
+
+    m_saveWorkId = ShutdownCoordinator::instance()->beginWork("products", resumeState());
+    setSelectionLocked(true);
+    ui->saveProductButton->setEnabled(false);
+    m_bulkPanel->setBusy(true);
+    ui->statusbarLabel->setText(QString("正在保存：%1...").arg(what));
+    const quint64 requestId = BulkEdit::submit(m_sessionKey, patch, this, [this, patch, what](const NetworkResult &result) {
+        onBulkPatchReply(result, patch, what);
+    });
+    ShutdownCoordinator::instance()->attachRequest(m_saveWorkId, requestId);
+}
+
+void ProductManager::onBulkPatchReply(const NetworkResult &result, const BulkEdit::Patch &patch, const QString &what)
+{
+    endSavingProcess();
+    if (ShutdownCoordinator::instance()->isShuttingDown()) return;
+
+    m_bulkPanel->setBusy(false);
+    ui->saveProductButton->setEnabled(true);
+    ui->statusbarLabel->clear();
+
+    if (NetworkSession::isConnectivityError(result.error)) {
+        MutationQueue::instance()->reportOffline();
+        queueSaveOffline();
+    } else if (!BulkEdit::checkSupported(result)) {
+        startSavingProcess(); // 老版本服务器：整表保存一次
+    } else if (!result.ok()) {
+        QMessageBox::critical(this, "网络错误", "保存请求失败: " + result.errorString);
+    } else if (result.json["status"].toString() == "success") {
+        BulkEdit::markSaved(patch);
+        ui->statusbarLabel->setText(QString("已保存：%1").arg(what));
+    } else {
+        QMessageBox::critical(this, "保存失败", "服务器返回错误: " + result.json["message"].toString());
+    }
+}
+
+void ProductManager::on_productPathButton_clicked()
+{
+    const QString file = QFileDialog::getOpenFileName(this, "批量导入产品", "", "数据文件 (*.csv *.jsonl *.ndjson)");
     if (file.isEmpty()) return;
-    m_localImagePath2 = file;
-    ui->productImgPath_2->setText(QFileInfo(file).fileName());
-    ui->imagePreviewLabel2->setPixmap(QPixmap(file).scaled(ui->imagePreviewLabel2->size(), Qt::KeepAspectRatio, Qt::SmoothTransformation));
+    // 图片目录可以不选，此时 images 列只能填写网络地址
+    const QString folder = QFileDialog::getExistingDirectory(this, "选择产品图片所在目录（可取消）");
+
+    BulkImporter::Options options;
+    options.kind = BulkImporter::Kind::Products;
+    options.filePath = file;
+    options.imageFolder = folder;
+
+    ui->productPathButton->setEnabled(false);
+    ui->statusbarLabel->setText("正在读取导入文件...");
+    BulkImporter::runAsync(options, this,
+        [this](qint64 rows) { ui->statusbarLabel->setText(QString("正在校验... 已读取 %1 行").arg(rows)); },
+        [this](const BulkImporter::Result &result) { onImportFinished(result); });
 }
 
+void ProductManager::onImportFinished(const BulkImporter::Result &result)
+{
+    ui->productPathButton->setEnabled(true);
+    ui->statusbarLabel->clear();
+
+    if (!result.fatalError.isEmpty()) {
+        QMessageBox::critical(this, "导入失败", result.fatalError);
+        return;
+    }
+    if (result.validCount() == 0) {
+        QMessageBox::warning(this, "没有可导入的产品", result.summary());
+        return;
+    }
+    if (QMessageBox::question(this, "确认导入", result.summary() + "\n\n是否把有效的产品追加到列表并提交到服务器？",
+                              QMessageBox::Yes | QMessageBox::No) != QMessageBox::Yes)
+        return;
+
+    int currentIndex = currentProductIndex();
+    if (currentIndex >= 0) syncGalleryToData(currentIndex);
+
+    // 图片先用离线队列的占位地址，队列会按批上传后替换成真实地址，最后整表保存一次
+    auto *queue = MutationQueue::instance();
+    QList<Product> all = m_snapshot->productValues();
+    const int firstNew = all.count();
+    for (int i = 0; i < result.products.size(); ++i) {
+        Product p = result.products[i];
+        p.imageUrls = BulkImporter::resolveImages(p.imageUrls, [queue](const QString &path) {
+            return queue->enqueueUpload("product", path);
+        });
+        all.append(p);
+    }
+    queue->enqueueSave(all);
+
+    DataStore::instance()->resetProducts(all);
+    selectProduct(firstNew);
+    ui->statusbarLabel->setText(QString("已导入 %1 个产品，正在提交...").arg(result.products.size()));
+}
 
 // --- 保存流程 (核心逻辑) ---
 void ProductManager::on_saveProductButton_clicked()
@@ -117,107 +557,432 @@ void ProductManager::on_saveProductButton_clicked()
 
 void ProductManager::startSavingProcess()
 {
-    int currentIndex = ui->productListWidget->currentRow();
+    int currentIndex = currentProductIndex();
     if (currentIndex < 0) return;
 
-    syncFormToData(currentIndex);
-    m_currentUploadingSlot = 0;
+    syncGalleryToData(currentIndex);
+
+    // 离线中，或队列里还有没同步的修改时，整个保存流程都排进队列
+    auto *queue = MutationQueue::instance();
+    if (queue->isOffline() || queue->pendingCount() > 0) {
+        queueSaveOffline();
+        return;
+    }
+
+    m_saveWorkId = ShutdownCoordinator::instance()->beginWork("products", resumeState());
+    setSelectionLocked(true);
+    m_saveProductIndex = currentIndex;
 
     ui->saveProductButton->setEnabled(false);
     ui->statusbarLabel->setText("正在处理...");
 
-    uploadNextImage();
+    m_haveServerProducts = false;
+    m_serverProducts.clear();
+    if (!RecordLocks::instance()->isSupported()) {
+        beginSaving();
+        return;
+    }
+
+    // 多人同时编辑：先取回服务器上的最新数据，保存时与本地数据三方合并，
+    // 其他管理员刚保存的修改不会被覆盖
+    ui->statusbarLabel->setText("正在获取服务器上的最新数据...");
+    RecordMerge::fetchServer(this, [this](const NetworkResult &result, const SyncResponse &response) {
+        if (!result.ok()) {
+            onNetworkResult(result); // 断网转入离线队列，其它网络错误直接报告
+            return;
+        }
+        if (!response.isSuccess() || !response.data.hasProducts) {
+            // 拿不到服务器的最新数据时不冒险整表覆盖
+            endSavingProcess();
+            if (ShutdownCoordinator::instance()->isShuttingDown()) return;
+            const QString reason = !response.isValid() ? response.parseError
+                                   : response.message.isEmpty() ? QString("响应中没有产品列表") : response.message;
+            QMessageBox::critical(this, "保存失败", "无法获取服务器上的最新数据: " + reason);
+            ui->saveProductButton->setEnabled(true);
+            ui->statusbarLabel->setText("保存失败！");
+            return;
+        }
+        m_haveServerProducts = true;
+        m_serverProducts = response.data.products;
+        beginSaving();
+    });
 }
 
-void ProductManager::uploadNextImage()
+void ProductManager::beginSaving()
 {
-    m_currentUploadingSlot++;
+    // 服务器支持批量请求时，图片和产品列表一次提交；否则沿用逐个上传再保存的流程
+    if (BatchClient::isSupported()) saveWithBatch();
+    else uploadNextImage();
+}
 
-    QString imagePath;
-    if (m_currentUploadingSlot == 1) imagePath = m_localImagePath1;
-    else if (m_currentUploadingSlot == 2) imagePath = m_localImagePath2;
-    else {
-        saveProductData();
+void ProductManager::saveWithBatch()
+{
+    m_batchProductIndex = currentProductIndex();
+    const QList<GalleryItem> items = m_gallery->items();
+    QStringList paths;
+    for (const GalleryItem &item : items) {
+        if (item.isPending()) paths.append(item.localPath);
+    }
+
+    // 与逐个上传一样先按内容查找：本地缓存或服务器已有的图片直接用地址，不放进批量请求
+    if (!paths.isEmpty()) ui->statusbarLabel->setText(QString("正在检查图片（%1 张）...").arg(paths.size()));
+    ImageDedupe::lookup(paths, m_sessionKey, this, [this, items](const ImageDedupe::Lookup &lookup) {
+        if (ShutdownCoordinator::instance()->isShuttingDown()) {
+            endSavingProcess();
+            return;
+        }
+        if (NetworkSession::isConnectivityError(lookup.checkError)) {
+            MutationQueue::instance()->reportOffline();
+            queueSaveOffline();
+            return;
+        }
+        sendBatch(items, lookup);
+    });
+}
+
+void ProductManager::sendBatch(const QList<GalleryItem> &items, const ImageDedupe::Lookup &lookup)
+{
+    // 占位地址只写进发送的数据副本，事务提交成功后再把真实地址写回数据快照
+    // 新图片按它在图库中的位置插入，所有图片和产品列表在同一个请求里提交
+    const bool showing = m_batchProductIndex == currentProductIndex();
+    BatchRequest batch;
+    m_batchRefs.clear();
+    m_batchHashes.clear();
+    m_batchImageUrls.clear();
+    for (const GalleryItem &item : items) {
+        if (!item.isPending()) {
+            m_batchImageUrls.append(item.url);
+            continue;
+        }
+        const QString known = lookup.urls.value(item.localPath);
+        if (!known.isEmpty()) {
+            if (showing) m_gallery->setUploaded(item.id, known);
+            m_batchImageUrls.append(known);
+            continue;
+        }
+        const QString hash = lookup.hashes.value(item.localPath);
+        const QString ref = batch.addImage("product", item.localPath, QString(), hash);
+        m_batchRefs.insert(ref, item.id);
+        m_batchHashes.insert(ref, hash);
+        m_batchImageUrls.append(ref);
+    }
+    QList<Product> mine = m_snapshot->productValues();
+    mine[m_batchProductIndex].imageUrls = m_batchImageUrls;
+    batch.addSave("save_products", DataSerializer::toWireArray(mergedPayload(mine)));
+
+    const QString failedFile = batch.unreadableFile();
+    if (!failedFile.isEmpty()) {
+        QMessageBox::critical(this, "文件错误", "无法读取本地图片: " + failedFile);
+        endSavingProcess();
+        ui->saveProductButton->setEnabled(true);
+        ui->statusbarLabel->setText("图片读取失败！");
+        return;
+    }
+
+    ui->statusbarLabel->setText("正在保存产品信息...");
+    NetworkThread::ProgressCallback onProgress;
+    if (!m_batchRefs.isEmpty()) {
+        ui->uploadProgressBar->setValue(0);
+        ui->uploadProgressBar->show();
+        onProgress = [this](qint64 sent, qint64 total) { onUploadProgress(sent, total); };
+    }
+
+    // 与逐个上传一样在网络线程中发送，界面线程被对话框占住时上传照常进行
+    const QString sessionKey = m_sessionKey;
+    const quint64 requestId = NetworkThread::instance()->submit("batch",
+        [sessionKey, batch](QNetworkAccessManager *manager) {
+            return BatchClient::post(manager, sessionKey, batch);
+        },
+        this, [this, batch](const NetworkResult &result) { handleBatchResult(result, batch); },
+        onProgress);
+    ShutdownCoordinator::instance()->attachRequest(m_saveWorkId, requestId);
+}
+
+void ProductManager::handleBatchResult(const NetworkResult &result, const BatchRequest &batch)
+{
+    // 批量请求自己处理包括 HTTP 错误在内的所有结果（断网仍走离线队列）
+    if (NetworkSession::isConnectivityError(result.error)) {
+        onNetworkResult(result);
         return;
     }
+    ui->uploadProgressBar->hide();
+
+    const BatchResponse response = BatchClient::parseResult(result, batch);
 
-    if (imagePath.isEmpty()) {
+    if (!response.supported) {
+        // 老版本服务器：退回逐个上传再保存
+        BatchClient::markUnsupported();
         uploadNextImage();
         return;
     }
 
-    ui->statusbarLabel->setText(QString("正在上传图片 %1...").arg(m_currentUploadingSlot));
-    ui->uploadProgressBar->setValue(0);
-    ui->uploadProgressBar->show();
+    endSavingProcess();
 
-    QHttpMultiPart *multiPart = new QHttpMultiPart(QHttpMultiPart::FormDataType);
+    if (response.committed) {
+        // 真实地址按发送时的顺序写回数据；图库仍显示这个产品时，对应的格子一并换成地址
+        const int idx = m_batchProductIndex;
+        const bool showing = idx >= 0 && idx == currentProductIndex();
+        QStringList urls;
+        for (const QString &url : std::as_const(m_batchImageUrls)) {
+            const auto ref = m_batchRefs.constFind(url);
+            if (ref == m_batchRefs.constEnd()) {
+                urls.append(url);
+                continue;
+            }
+            const QString uploaded = response.imageUrls.value(url);
+            if (!uploaded.isEmpty()) urls.append(uploaded);
+            ImageDedupe::remember(m_batchHashes.value(url), uploaded);
+            if (showing && !uploaded.isEmpty()) m_gallery->setUploaded(ref.value(), uploaded);
+        }
+        if (idx >= 0 && idx < products().size()) {
+            Product p = *products()[idx];
+            p.imageUrls = urls;
+            DataStore::instance()->setProduct(idx, p);
+        }
+        m_batchRefs.clear();
+        applySavedMerge(response.imageUrls);
+        if (ShutdownCoordinator::instance()->isShuttingDown()) return;
 
-    QHttpPart actionPart;
-    actionPart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"action\""));
-    actionPart.setBody("upload_image");
+        showSaveSucceeded(response.message.isEmpty() ? "产品信息已保存。" : response.message);
+    } else {
+        if (ShutdownCoordinator::instance()->isShuttingDown()) return;
 
-    QHttpPart keyPart;
-    keyPart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"key\""));
-    keyPart.setBody(m_sessionKey.toUtf8());
+        // 事务已整体回滚，列出具体失败的操作
+        QStringList errors;
+        for (const auto &result : response.results) {
+            if (!result.success && !result.message.isEmpty())
+                errors.append((result.action == "upload_image" ? "图片上传: " : "保存: ") + result.message);
+        }
+        if (errors.isEmpty()) errors.append(response.message);
+        QMessageBox::critical(this, "保存失败", "服务器未保存任何修改:\n" + errors.join("\n"));
+        ui->statusbarLabel->setText("保存失败！");
+    }
+    ui->saveProductButton->setEnabled(true);
+}
 
-    QHttpPart typePart;
-    typePart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"type\""));
-    typePart.setBody("product");
+void ProductManager::uploadNextImage()
+{
+    // 图库应当仍然显示发起保存的产品（期间列表已锁定）；同步刷新了列表时不能把图片写到别的产品上
+    if (currentProductIndex() != m_saveProductIndex) {
+        endSavingProcess();
+        if (ShutdownCoordinator::instance()->isShuttingDown()) return;
+        QMessageBox::warning(this, "保存中断", "保存期间产品列表已刷新，请确认后重新保存。");
+        ui->uploadProgressBar->hide();
+        ui->saveProductButton->setEnabled(true);
+        ui->statusbarLabel->setText("保存中断！");
+        return;
+    }
 
-    multiPart->append(actionPart);
-    multiPart->append(keyPart);
-    multiPart->append(typePart);
+    // 每次取图库中第一张还没上传的图片，全部上传完后保存产品列表
+    const QList<GalleryItem> pending = m_gallery->pendingItems();
+    if (pending.isEmpty()) {
+        syncGalleryToData(m_saveProductIndex);
+        saveProductData();
+        return;
+    }
+    m_uploadingItemId = pending.first().id;
+    const QString imagePath = pending.first().localPath;
 
-    QHttpPart imagePart;
-    imagePart.setHeader(QNetworkRequest::ContentTypeHeader, QVariant("image/jpeg"));
-    imagePart.setHeader(QNetworkRequest::ContentDispositionHeader, QVariant("form-data; name=\"image_file\"; filename=\""+ QFileInfo(imagePath).fileName() +"\""));
-    QFile *file = new QFile(imagePath);
-    if (!file->open(QIODevice::ReadOnly)) {
+    if (!QFileInfo(imagePath).isReadable()) {
         QMessageBox::critical(this, "文件错误", "无法读取本地图片: " + imagePath);
-        delete multiPart;
+        endSavingProcess();
+        ui->saveProductButton->setEnabled(true);
+        ui->statusbarLabel->setText("图片读取失败！");
         return;
     }
-    imagePart.setBodyDevice(file);
-    file->setParent(multiPart);
-    multiPart->append(imagePart);
 
-    QUrl url("https://tianyuhuanbao.com/api.php");
-    QNetworkRequest request(url);
-    request.setAttribute(QNetworkRequest::User, "upload_image");
+    // 先在工作线程中计算内容哈希，同一张图片以前传过的话就不必再传
+    ui->statusbarLabel->setText(QString("正在检查图片（剩余 %1 张）...").arg(pending.size()));
+    m_currentImageHash.clear();
+    auto *watcher = new QFutureWatcher<QString>(this);
+    connect(watcher, &QFutureWatcher<QString>::finished, this, [this, watcher, imagePath]() {
+        watcher->deleteLater();
+        if (ShutdownCoordinator::instance()->isShuttingDown()) {
+            endSavingProcess();
+            return;
+        }
+        resolveImage(imagePath, watcher->result());
+    });
+    watcher->setFuture(QtConcurrent::run(&ImageDedupe::hashFile, imagePath));
+}
 
-    QNetworkReply *reply = m_networkManager->post(request, multiPart);
-    multiPart->setParent(reply);
+void ProductManager::resolveImage(const QString &imagePath, const QString &hash)
+{
+    m_currentImageHash = hash;
 
-    connect(reply, &QNetworkReply::uploadProgress, this, &ProductManager::onUploadProgress);
+    const QString cached = ImageDedupe::cachedUrl(hash);
+    if (!cached.isEmpty()) {
+        applyUploadedImage(cached);
+        return;
+    }
+    if (hash.isEmpty() || !ImageDedupe::isServerCheckSupported()) {
+        startImageUpload(imagePath);
+        return;
+    }
+
+    const QString sessionKey = m_sessionKey;
+    const quint64 requestId = NetworkThread::instance()->submit("check_images",
+        [sessionKey, hash](QNetworkAccessManager *manager) {
+            return ImageDedupe::postCheck(manager, sessionKey, {hash});
+        },
+        this, [this, imagePath, hash](const NetworkResult &result) {
+            // 断网或退出时按普通的失败处理（转入离线队列 / 结束流程）
+            if (NetworkSession::isConnectivityError(result.error) || ShutdownCoordinator::instance()->isShuttingDown()) {
+                onNetworkResult(result);
+                return;
+            }
+            const QString url = ImageDedupe::knownUrls(result.httpStatus, result.json).value(hash);
+            if (url.isEmpty()) {
+                startImageUpload(imagePath);
+                return;
+            }
+            ImageDedupe::remember(hash, url);
+            applyUploadedImage(url);
+        });
+    ShutdownCoordinator::instance()->attachRequest(m_saveWorkId, requestId);
+}
+
+void ProductManager::startImageUpload(const QString &imagePath)
+{
+    ui->statusbarLabel->setText(QString("正在上传图片（剩余 %1 张）...").arg(m_gallery->pendingItems().size()));
+    ui->uploadProgressBar->setValue(0);
+    ui->uploadProgressBar->show();
+
+    // 上传在网络线程中进行，界面线程忙时也不会停顿
+    const QString sessionKey = m_sessionKey;
+    const QString hash = m_currentImageHash;
+    const quint64 requestId = NetworkThread::instance()->submit("upload_image",
+        [sessionKey, imagePath, hash](QNetworkAccessManager *manager) -> QNetworkReply * {
+            QHttpMultiPart *multiPart = NetworkSession::createImageUpload(sessionKey, "product", imagePath, hash);
+            if (!multiPart) return nullptr;
+            QNetworkReply *reply = manager->post(NetworkSession::apiRequest(), multiPart);
+            multiPart->setParent(reply);
+            return reply;
+        },
+        this, [this](const NetworkResult &result) { onNetworkResult(result); },
+        [this](qint64 sent, qint64 total) { onUploadProgress(sent, total); });
+    ShutdownCoordinator::instance()->attachRequest(m_saveWorkId, requestId);
+}
+
+void ProductManager::applyUploadedImage(const QString &url)
+{
+    // 用户在上传期间移除了这张图片时 setUploaded 找不到条目，直接继续下一张
+    if (currentProductIndex() == m_saveProductIndex) {
+        m_gallery->setUploaded(m_uploadingItemId, url);
+        syncGalleryToData(m_saveProductIndex);
+    }
+    m_uploadingItemId = 0;
+    // 已上传的图片地址写回恢复状态，中途退出时下次无需重复上传
+    ShutdownCoordinator::instance()->updateWork(m_saveWorkId, resumeState());
+    uploadNextImage();
 }
 
 void ProductManager::saveProductData()
 {
     ui->statusbarLabel->setText("正在保存产品信息...");
 
-    QJsonArray productsArray;
-    for (const auto &p : m_products) {
-        QJsonObject o;
-        o["name"] = p.name;
-        o["category"] = p.category;
-        o["description"] = p.description;
-        o["imageUrls"] = QJsonArray::fromStringList(p.imageUrls);
-        productsArray.append(o);
+    const QString sessionKey = m_sessionKey;
+    const QList<Product> products = mergedPayload(m_snapshot->productValues());
+    const quint64 requestId = NetworkThread::instance()->submit("save_products",
+        [sessionKey, products](QNetworkAccessManager *manager) {
+            return NetworkSession::postForm(manager, "save_products", DataSerializer::saveBody(sessionKey, products));
+        },
+        this, [this](const NetworkResult &result) { onNetworkResult(result); });
+    ShutdownCoordinator::instance()->attachRequest(m_saveWorkId, requestId);
+}
+
+QList<Product> ProductManager::mergedPayload(const QList<Product> &mine)
+{
+    m_sentMine = mine;
+    if (!m_haveServerProducts) {
+        m_mergeConflicts.clear();
+        m_sentPayload = mine;
+        return m_sentPayload;
     }
-    QJsonDocument doc(productsArray);
-    QString jsonDataString = QString::fromUtf8(doc.toJson(QJsonDocument::Compact));
+    const auto merged = RecordMerge::threeWay(DataStore::instance()->syncBase().productValues(), mine,
+                                              m_serverProducts, RecordMerge::productKey);
+    m_mergeConflicts = merged.conflicts;
+    m_sentPayload = merged.records;
+    return m_sentPayload;
+}
 
-    QUrl url("https://tianyuhuanbao.com/api.php");
-    QNetworkRequest request(url);
-    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
-    request.setAttribute(QNetworkRequest::User, "save_products");
+void ProductManager::applySavedMerge(const QHash<QString, QString> &uploaded)
+{
+    if (!uploaded.isEmpty()) {
+        for (QList<Product> *list : {&m_sentMine, &m_sentPayload}) {
+            for (Product &p : *list) {
+                for (QString &url : p.imageUrls) url = uploaded.value(url, url);
+            }
+        }
+    }
+    // 服务器上现在是发送的列表：记为新的基准，并把合并进来的其他管理员的修改应用到本地
+    // （保存期间本地又做的修改仍然保留）
+    DataStore::instance()->markSaved(m_sentPayload);
+    m_haveServerProducts = false;
+    m_serverProducts.clear();
+    if (m_sentPayload == m_sentMine) return;
 
-    QUrlQuery postData;
-    postData.addQueryItem("action", "save_products");
-    postData.addQueryItem("key", m_sessionKey);
-    postData.addQueryItem("data", jsonDataString);
+    const int index = currentProductIndex();
+    const QString name = (index >= 0 && index < products().size()) ? products()[index]->name : QString();
+    if (index >= 0) syncGalleryToData(index);
+    const auto local = RecordMerge::threeWay(m_sentMine, m_snapshot->productValues(), m_sentPayload,
+                                             RecordMerge::productKey);
+    DataStore::instance()->resetProducts(local.records);
+    for (int i = 0; i < products().size(); ++i) {
+        if (products()[i]->name == name) {
+            selectProduct(i);
+            break;
+        }
+    }
+}
 
-    m_networkManager->post(request, postData.query(QUrl::FullyEncoded).toUtf8());
+void ProductManager::showSaveSucceeded(const QString &message)
+{
+    if (!m_mergeConflicts.isEmpty()) {
+        QMessageBox::warning(this, "保存成功（有冲突）",
+                             "以下产品同时被其他管理员修改过，已保存为您的版本：\n" + m_mergeConflicts.join("\n"));
+    } else if (m_sentPayload != m_sentMine) {
+        QMessageBox::information(this, "保存成功", message + "\n已合并其他管理员的修改。");
+    } else {
+        QMessageBox::information(this, "保存成功", message);
+    }
+    ui->statusbarLabel->setText("保存成功！");
+}
+
+void ProductManager::queueSaveOffline()
+{
+    auto *queue = MutationQueue::instance();
+
+    // 还没上传的图片先占位，重放时由队列替换成真实地址
+    int idx = currentProductIndex();
+    if (idx >= 0) {
+        for (const GalleryItem &item : m_gallery->pendingItems())
+            m_gallery->setUploaded(item.id, queue->enqueueUpload("product", item.localPath));
+        syncGalleryToData(idx);
+    }
+    queue->enqueueSave(m_snapshot->productValues());
+
+    endSavingProcess();
+    ui->uploadProgressBar->hide();
+    ui->saveProductButton->setEnabled(true);
+    ui->statusbarLabel->setText(QString("网络不可用，修改已加入离线队列（%1 项待同步）").arg(queue->pendingCount()));
+}
+
+void ProductManager::endSavingProcess()
+{
+    ShutdownCoordinator::instance()->endWork(m_saveWorkId);
+    m_saveWorkId = 0;
+    setSelectionLocked(false);
+}
+
+// 上传和保存都针对发起时选中的产品和图库；期间不能换选中的产品，
+// 否则上传得到的地址会写进新选中产品的图库
+void ProductManager::setSelectionLocked(bool locked)
+{
+    ui->productListWidget->setEnabled(!locked);
+    ui->categoryFacetComboBox->setEnabled(!locked);
+    ui->addProduct->setEnabled(!locked);
+    ui->deleteProduct->setEnabled(!locked && !m_visibleRows.isEmpty());
 }
 
 void ProductManager::onUploadProgress(qint64 bytesSent, qint64 bytesTotal)
@@ -228,66 +993,70 @@ void ProductManager::onUploadProgress(qint64 bytesSent, qint64 bytesTotal)
     }
 }
 
-void ProductManager::onNetworkReply(QNetworkReply *reply)
+void ProductManager::onNetworkResult(const NetworkResult &result)
 {
-    disconnect(reply, &QNetworkReply::uploadProgress, this, &ProductManager::onUploadProgress);
     ui->uploadProgressBar->hide();
 
-    QString requestType = reply->request().attribute(QNetworkRequest::User).toString();
+    // 退出过程中出错（包括被 ShutdownCoordinator 中止）时不再弹框，直接结束流程
+    if (ShutdownCoordinator::instance()->isShuttingDown() && !result.ok()) {
+        endSavingProcess();
+        return;
+    }
 
-    if (reply->error() != QNetworkReply::NoError) {
-        QMessageBox::critical(this, "网络错误", "操作失败: " + reply->errorString());
+    if (NetworkSession::isConnectivityError(result.error)) {
+        // 断网：已经上传成功的图片保留真实地址，其余部分转入离线队列
+        MutationQueue::instance()->reportOffline();
+        queueSaveOffline();
+    } else if (!result.ok()) {
+        endSavingProcess();
+        QMessageBox::critical(this, "网络错误", "操作失败: " + result.errorString);
         ui->saveProductButton->setEnabled(true);
         ui->statusbarLabel->setText("操作失败！");
-    } else {
-        QJsonDocument doc = QJsonDocument::fromJson(reply->readAll());
-        QJsonObject obj = doc.object();
-
-        if (requestType == "upload_image") {
-            if (obj["status"].toString() == "success") {
-                int idx = ui->productListWidget->currentRow();
-                if (idx >= 0) {
-                    QString newUrl = obj["url"].toString();
-                    if (m_currentUploadingSlot == 1) {
-                        if (m_products[idx].imageUrls.size() < 1) m_products[idx].imageUrls.append(newUrl);
-                        else m_products[idx].imageUrls[0] = newUrl;
-                        m_localImagePath1.clear();
-                    } else if (m_currentUploadingSlot == 2) {
-                        if (m_products[idx].imageUrls.size() < 2) m_products[idx].imageUrls.append(newUrl);
-                        else m_products[idx].imageUrls[1] = newUrl;
-                        m_localImagePath2.clear();
-                    }
-                }
-                uploadNextImage();
-            } else {
-                QMessageBox::critical(this, "图片上传失败", obj["message"].toString());
-                ui->saveProductButton->setEnabled(true);
-                ui->statusbarLabel->setText("图片上传失败！");
-            }
-        }
-        else if (requestType == "save_products") {
-            if (obj["status"].toString() == "success") {
-                QMessageBox::information(this, "保存成功", obj["message"].toString());
-                ui->statusbarLabel->setText("保存成功！");
-            } else {
-                QMessageBox::critical(this, "保存失败", "服务器返回错误: " + obj["message"].toString());
-            }
+    } else if (result.tag == "upload_image") {
+        const QJsonObject &obj = result.json;
+        if (obj["status"].toString() == "success") {
+            const QString newUrl = obj["url"].toString();
+            ImageDedupe::remember(m_currentImageHash, newUrl);
+            applyUploadedImage(newUrl);
+        } else {
+            endSavingProcess();
+            QMessageBox::critical(this, "图片上传失败", obj["message"].toString());
             ui->saveProductButton->setEnabled(true);
+            ui->statusbarLabel->setText("图片上传失败！");
+        }
+    } else if (result.tag == "save_products") {
+        endSavingProcess();
+        if (ShutdownCoordinator::instance()->isShuttingDown()) return;
+        if (result.json["status"].toString() == "success") {
+            applySavedMerge();
+            showSaveSucceeded(result.json["message"].toString());
+        } else {
+            QMessageBox::critical(this, "保存失败", "服务器返回错误: " + result.json["message"].toString());
         }
+        ui->saveProductButton->setEnabled(true);
     }
-
-    reply->deleteLater();
 }
 
 void ProductManager::updateProductListWidget()
 {
+    StallWatchdog::Scope stallScope("ProductManager::updateProductListWidget");
+    // 筛选结果直接取自分类索引，不扫描整个产品列表
+    if (m_filterByCategory) {
+        m_visibleRows = m_snapshot->productCategories.rows(m_categoryFilter);
+    } else {
+        m_visibleRows.clear();
+        m_visibleRows.reserve(products().size());
+        for (int i = 0; i < products().size(); ++i) m_visibleRows.append(i);
+    }
+
     ui->productListWidget->blockSignals(true);
     ui->productListWidget->clear();
-    for (const auto &p : m_products)
-        ui->productListWidget->addItem(p.name);
+    for (int row : std::as_const(m_visibleRows))
+        ui->productListWidget->addItem(products()[row]->name);
     ui->productListWidget->blockSignals(false);
+    updateItemMarks();
 
-    bool hasProducts = !m_products.isEmpty();
+    bool hasProducts = !m_visibleRows.isEmpty();
     ui->deleteProduct->setEnabled(hasProducts);
     ui->productBox->setEnabled(hasProducts);
     ui->saveProductButton->setEnabled(hasProducts);
@@ -296,49 +1065,68 @@ void ProductManager::updateProductListWidget()
     else clearForm();
 }
 
-void ProductManager::populateForm(int index)
+void ProductManager::updateFacetComboBox()
 {
-    if (index < 0 || index >= m_products.count()) return;
+    const CategoryIndex &index = m_snapshot->productCategories;
+    QComboBox *combo = ui->categoryFacetComboBox;
 
-    const Product &p = m_products[index];
-    ui->productNameEdit->setText(p.name);
-    ui->productCategoryComboBox->setCurrentText(p.category);
-    ui->productDescriptionEdit->setPlainText(p.description);
+    combo->blockSignals(true);
+    combo->clear();
+    combo->addItem(QString("全部 (%1)").arg(index.total()));
+    QStringList categories = index.categories();
+    // 正在筛选的分类即使已经没有产品也保留，避免列表和下拉框对不上
+    if (m_filterByCategory && !index.contains(m_categoryFilter)) categories.append(m_categoryFilter);
+    for (const QString &category : std::as_const(categories)) {
+        const QString label = category.isEmpty() ? QString("未分类") : category;
+        combo->addItem(QString("%1 (%2)").arg(label).arg(index.count(category)), category);
+        if (m_filterByCategory && category == m_categoryFilter) combo->setCurrentIndex(combo->count() - 1);
+    }
+    combo->blockSignals(false);
+}
 
-    ui->imagePreviewLabel1->clear();
-    ui->productImgPath_1->setText("尚未选择新图片");
-    m_localImagePath1.clear();
-    ui->imagePreviewLabel2->clear();
-    ui->productImgPath_2->setText("尚未选择新图片");
-    m_localImagePath2.clear();
+void ProductManager::updateFacetCounts()
+{
+    const CategoryIndex &index = m_snapshot->productCategories;
+    QComboBox *combo = ui->categoryFacetComboBox;
 
-    // [新功能] 从网络加载并显示已有的图片
-    if (!p.imageUrls.isEmpty()) {
-        ui->productImgPath_1->setText(p.imageUrls.value(0));
-        // (加载网络图片的具体实现，需要额外发送GET请求，我们可以在下一步细化)
-    }
-    if (p.imageUrls.size() > 1) {
-        ui->productImgPath_2->setText(p.imageUrls.value(1));
+    for (int i = 0; i < combo->count(); ++i) {
+        const QVariant category = combo->itemData(i);
+        QString text;
+        if (!category.isValid()) {
+            text = QString("全部 (%1)").arg(index.total());
+        } else {
+            const QString name = category.toString();
+            const QString label = name.isEmpty() ? QString("未分类") : name;
+            text = QString("%1 (%2)").arg(label).arg(index.count(name));
+        }
+        if (combo->itemText(i) != text) combo->setItemText(i, text);
     }
 }
 
+void ProductManager::populateForm(int index)
+{
+    StallWatchdog::Scope stallScope("ProductManager::populateForm");
+    if (index < 0 || index >= products().count()) return;
+
+    const RecordPtr<Product> &record = products()[index];
+    m_form.setRecord(record);
+    // 已有图片的缩略图由图库在格子可见时才下载和解码；离线队列中的占位地址显示为等待上传
+    m_gallery->setUrls(record->imageUrls);
+}
+
 void ProductManager::clearForm()
 {
-    ui->productNameEdit->clear();
-    ui->productCategoryComboBox->setCurrentIndex(0);
-    ui->productDescriptionEdit->clear();
-    ui->imagePreviewLabel1->clear();
-    ui->productImgPath_1->setText("尚未选择");
-    m_localImagePath1.clear();
-    ui->imagePreviewLabel2->clear();
-    ui->productImgPath_2->setText("尚未选择");
-    m_localImagePath2.clear();
+    m_form.clear();
+    m_gallery->setUrls(QStringList());
 }
 
-void ProductManager::syncFormToData(int index)
+void ProductManager::syncGalleryToData(int index)
 {
-    if (index < 0 || index >= m_products.size()) return;
-    m_products[index].name        = ui->productNameEdit->text();
-    m_products[index].category    = ui->productCategoryComboBox->currentText();
-    m_products[index].description = ui->productDescriptionEdit->toPlainText();
+    if (index < 0 || index >= products().size()) return;
+    const QStringList images = m_gallery->urls();
+    // 没有改动时不产生新版本
+    if (products()[index]->imageUrls == images) return;
+    Product p = *products()[index];
+    p.imageUrls = images;
+    DataStore::instance()->setProduct(index, p);
 }
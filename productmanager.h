@@ -4,16 +4,34 @@
 
 #include <QWidget>
 #include "datastructures.h"
+#include "datastore.h"
+#include "formbinding.h"
+#include "bulkedit.h"
 #include <QList>
+#include <QHash>
 
-class QNetworkAccessManager;
-class QNetworkReply;
 class QListWidgetItem;
+class QJsonObject;
+class QTimer;
+class GalleryModel;
+struct GalleryItem;
+class BulkEditPanel;
 
 namespace Ui {
 class ProductManager;
 }
 
+namespace BulkImporter {
+struct Result;
+}
+
+namespace ImageDedupe {
+struct Lookup;
+}
+
+struct NetworkResult;
+class BatchRequest;
+
 class ProductManager : public QWidget
 {
     Q_OBJECT
@@ -23,7 +41,8 @@ public:
     ~ProductManager();
 
 public slots:
-    void updateData(const QList<Product> &products);
+    // 恢复上次退出时没能保存完成的产品列表和待上传图片
+    void restoreUnfinishedWork(const QJsonObject &state);
 
 private slots:
     // --- 所有槽函数都将由Qt根据objectName自动连接 ---
@@ -32,39 +51,125 @@ private slots:
     void on_productListWidget_currentItemChanged(QListWidgetItem *current, QListWidgetItem *previous);
     void on_saveProductButton_clicked();
 
-    // 图片选择按钮
-    void on_selectImageButton1_clicked();
-    void on_selectImageButton2_clicked();
-
-    // 唯一的网络响应处理器
-    void onNetworkReply(QNetworkReply *reply);
+    // 图库：添加（可多选）和移除图片
+    void on_addImagesButton_clicked();
+    void on_removeImagesButton_clicked();
 
     // 上传进度
     void onUploadProgress(qint64 bytesSent, qint64 bytesTotal);
 
+    // 批量导入（“浏览”按钮）
+    void on_productPathButton_clicked();
+
+    // 分类筛选
+    void on_categoryFacetComboBox_currentIndexChanged(int index);
+
+    // DataStore 发布了新快照
+    void onDataReset(SnapshotPtr snapshot, DataStore::Sections sections);
+    void onDataEdited(SnapshotPtr snapshot, DataStore::Sections sections);
+
+    // 记录级编辑锁
+    void onLockAcquired(const QString &type, const QString &record, bool granted, const QString &holder);
+    void onLockLost(const QString &type, const QString &record);
+    // 在列表中标出其他管理员正在编辑的产品和有失效图片的产品
+    void updateItemMarks();
+
+    // 多选后的批量修改
+    void onBulkApply(const QString &field, const QString &value);
+    void onBulkUndo();
+    void onBulkRedo();
+
 private:
     Ui::ProductManager *ui;
-    QList<Product>     m_products;
-    QNetworkAccessManager *m_networkManager;
+    // 当前持有的数据快照；产品列表就是 m_snapshot->products
+    SnapshotPtr        m_snapshot;
     const QString      m_sessionKey;
 
-    // 存储待上传的本地图片路径
-    QString m_localImagePath1;
-    QString m_localImagePath2;
+    // 编辑表单与当前产品的绑定
+    RecordBinding<Product> m_form;
+    // 当前产品的图片，包括尚未上传的本地文件
+    GalleryModel *m_gallery;
 
     // 管理保存流程的状态变量
-    int m_currentUploadingSlot;
+    int m_uploadingItemId = 0; // 正在上传的图库条目
+    int m_saveWorkId = 0; // 本次保存流程在 ShutdownCoordinator 中的编号
+    int m_saveProductIndex = -1; // 发起保存时选中的产品，逐个上传的图片只写回这个产品
+    QString m_currentImageHash; // 当前图片的内容哈希，上传成功后写入去重缓存
+
+    // 批量保存时，每张新图片的占位地址对应的图库条目、按顺序发送的图片列表，以及发起保存时选中的产品
+    QHash<QString, int> m_batchRefs;
+    QHash<QString, QString> m_batchHashes; // 占位地址 -> 图片内容哈希，提交后写入去重缓存
+    QStringList m_batchImageUrls;
+    int m_batchProductIndex = -1;
+
+    // 当前选中产品的编辑锁（按产品名称），以及正在申请中的锁；
+    // 改名停下来一会儿后由 m_relockTimer 把锁换到新名称上
+    QString m_lockRecord;
+    QString m_pendingLock;
+    QTimer *m_relockTimer;
+    // 合并保存：保存前取回的服务器数据、发送时本地的列表、实际发送的（合并后的）列表
+    bool m_haveServerProducts = false;
+    QList<Product> m_serverProducts;
+    QList<Product> m_sentMine;
+    QList<Product> m_sentPayload;
+    QStringList m_mergeConflicts;
+    // 批量修改面板和它的撤销记录
+    BulkEditPanel *m_bulkPanel;
+    BulkEdit::History m_bulkHistory;
+
+    // 分类筛选状态；m_visibleRows 是列表控件每一行对应的产品行号（升序）
+    bool m_filterByCategory = false;
+    QString m_categoryFilter;
+    QList<int> m_visibleRows;
+
+    const RecordList<Product> &products() const { return m_snapshot->products; }
+    // 列表控件中的行与产品行号之间的换算
+    int currentProductIndex() const;
+    int productIndexOf(QListWidgetItem *item) const;
+    void selectProduct(int index); // 产品不在当前筛选结果中时会切回“全部”
 
     // 私有函数
     void updateProductListWidget();
+    void updateItemMark(int row); // 只刷新列表中的一行（编辑名称时）
+    void updateFacetComboBox(); // 刷新分类列表及各分类的产品数量
+    void updateFacetCounts();   // 分类没有增减时只更新各项的数量
     void populateForm(int index);
     void clearForm();
-    void syncFormToData(int index); // 将表单的文本内容同步到数据结构
+    void syncGalleryToData(int index); // 将图库中的图片及其顺序同步到数据结构（文本字段由 m_form 即时写回）
+    void updateImageCount();
+
+    void requestEditLock(int index);
+    void relockRenamed(); // 放掉旧名称的锁，改用当前名称申请
 
     // 图片上传流程
     void startSavingProcess();
+    void beginSaving(); // 取回服务器最新数据之后（或服务器不支持记录锁时）开始上传和保存
     void uploadNextImage();
+    void resolveImage(const QString &imagePath, const QString &hash); // 本地缓存 -> 服务器查询 -> 上传
+    void startImageUpload(const QString &imagePath);
+    void applyUploadedImage(const QString &url);
     void saveProductData();
+    void saveWithBatch(); // 先查找已有的图片，再 sendBatch
+    void sendBatch(const QList<GalleryItem> &items, const ImageDedupe::Lookup &lookup);
+    void handleBatchResult(const NetworkResult &result, const BatchRequest &batch);
+    void onNetworkResult(const NetworkResult &result); // 上传和保存的响应（来自网络线程）
+    void endSavingProcess();
+    void setSelectionLocked(bool locked); // 保存期间锁定产品列表，不能换选中的产品
+    // 与保存前取回的服务器数据合并，得到实际发送的列表
+    QList<Product> mergedPayload(const QList<Product> &mine);
+    // 保存成功：uploaded 把批量请求中的占位地址换成真实地址；之后更新同步基准并应用合并进来的修改
+    void applySavedMerge(const QHash<QString, QString> &uploaded = QHash<QString, QString>());
+    void showSaveSucceeded(const QString &message);
+    void queueSaveOffline(); // 把保存流程中尚未完成的部分转入离线队列
+    void onImportFinished(const BulkImporter::Result &result);
+    QJsonObject resumeState() const; // 下次启动恢复保存流程所需的本地状态
+
+    QList<int> selectedProductIndexes() const;
+    void updateBulkPanel();
+    void refreshAfterBulkEdit();
+    // 把批量修改（或它的撤销、重做）作为一个补丁保存；服务器不支持补丁时整表保存
+    void submitBulkPatch(const BulkEdit::Patch &patch, const QString &what);
+    void onBulkPatchReply(const NetworkResult &result, const BulkEdit::Patch &patch, const QString &what);
 };
 
 #endif // PRODUCTMANAGER_H
@@ -0,0 +1,205 @@
+// recordlocks.cpp
+#include "recordlocks.h"
+#include "formbodywriter.h"
+#include "networksession.h"
+#include "networkthread.h"
+
+#include <QCoreApplication>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QNetworkAccessManager>
+#include <QTimer>
+#include <QDebug>
+
+namespace {
+
+// 租约时长和心跳间隔：心跳连续丢两次锁仍然有效
+const int kLeaseSeconds = 60;
+const int kHeartbeatMs = 20 * 1000;
+
+} // namespace
+
+RecordLocks *RecordLocks::instance()
+{
+    static RecordLocks *locks = new RecordLocks(qApp);
+    return locks;
+}
+
+RecordLocks::RecordLocks(QObject *parent)
+    : QObject(parent)
+    , m_heartbeat(new QTimer(this))
+{
+    m_heartbeat->setInterval(kHeartbeatMs);
+    connect(m_heartbeat, &QTimer::timeout, this, &RecordLocks::heartbeat);
+}
+
+QString RecordLocks::lockId(const QString &type, const QString &record)
+{
+    return type + '/' + record;
+}
+
+void RecordLocks::setSessionKey(const QString &sessionKey)
+{
+    m_sessionKey = sessionKey;
+    m_held.clear();
+    m_table.clear();
+    if (sessionKey.isEmpty()) {
+        m_heartbeat->stop();
+        return;
+    }
+    m_heartbeat->start();
+    heartbeat(); // 立即取一次锁表
+}
+
+bool RecordLocks::holds(const QString &type, const QString &record) const
+{
+    return !m_supported || m_held.contains(lockId(type, record));
+}
+
+QString RecordLocks::otherHolder(const QString &type, const QString &record) const
+{
+    if (!m_supported) return QString();
+    const auto it = m_table.constFind(lockId(type, record));
+    if (it == m_table.constEnd() || it->mine || it->expires < QDateTime::currentDateTimeUtc()) return QString();
+    return it->holder;
+}
+
+// 只有服务器明确不认识锁相关的 action（老版本服务器）时才退回全局锁模式；
+// 会话过期之类的普通错误不算，否则之后所有记录都会被当作可以随意编辑
+bool RecordLocks::checkSupported(const NetworkResult &result)
+{
+    const bool unsupported = NetworkSession::isUnknownAction(result.httpStatus, result.json);
+    if (unsupported && m_supported) {
+        qDebug() << "Server does not support record locks, falling back to the session lock";
+        m_supported = false;
+        m_heartbeat->stop();
+        m_table.clear();
+        emit locksChanged("jobs");
+        emit locksChanged("products");
+    }
+    return m_supported;
+}
+
+void RecordLocks::post(const QString &action, const QString &type, const QString &record)
+{
+    const QString sessionKey = m_sessionKey;
+    NetworkThread::instance()->submit(action,
+        [action, sessionKey, type, record](QNetworkAccessManager *manager) {
+            FormBodyWriter writer;
+            writer.addField("action", action);
+            writer.addField("key", sessionKey);
+            writer.addField("type", type);
+            writer.addField("record", record);
+            writer.addField("lease", QString::number(kLeaseSeconds));
+            return NetworkSession::postForm(manager, action, writer.take());
+        },
+        this, [this, action, type, record](const NetworkResult &result) {
+            if (action != "acquire_lock") return; // 释放失败无需处理，租约到期后自然失效
+            const QString id = lockId(type, record);
+            if (!checkSupported(result)) {
+                emit acquireFinished(type, record, true, QString());
+                return;
+            }
+            // 网络错误时不阻止编辑：保存前的三方合并仍然可以发现冲突
+            if (!result.ok()) {
+                emit acquireFinished(type, record, true, QString());
+                return;
+            }
+            if (result.json["status"].toString() == "success") {
+                m_held.insert(id);
+                RecordLock &lock = m_table[id];
+                lock.mine = true;
+                lock.expires = QDateTime::currentDateTimeUtc().addSecs(kLeaseSeconds);
+                emit acquireFinished(type, record, true, QString());
+            } else if (!result.json.contains("holder")) {
+                // 普通错误（例如会话过期）：同断网一样不阻止编辑
+                qDebug() << "acquire_lock failed:" << result.json["message"].toString();
+                emit acquireFinished(type, record, true, QString());
+                return;
+            } else {
+                const QString holder = result.json["holder"].toString();
+                RecordLock &lock = m_table[id];
+                lock.holder = holder;
+                lock.mine = false;
+                lock.expires = QDateTime::fromString(result.json["expires"].toString(), Qt::ISODate);
+                emit acquireFinished(type, record, false, holder);
+            }
+            emit locksChanged(type);
+        });
+}
+
+void RecordLocks::acquire(const QString &type, const QString &record)
+{
+    if (!m_supported || m_sessionKey.isEmpty() || m_held.contains(lockId(type, record))) {
+        emit acquireFinished(type, record, true, QString());
+        return;
+    }
+    post("acquire_lock", type, record);
+}
+
+void RecordLocks::release(const QString &type, const QString &record)
+{
+    if (!m_held.remove(lockId(type, record)) || !m_supported) return;
+    m_table.remove(lockId(type, record));
+    post("release_lock", type, record);
+    emit locksChanged(type);
+}
+
+// 续约自己持有的锁，并取回完整的锁表
+void RecordLocks::heartbeat()
+{
+    if (!m_supported || m_sessionKey.isEmpty()) return;
+    QJsonArray held;
+    for (const QString &id : std::as_const(m_held)) {
+        const int slash = id.indexOf('/');
+        held.append(QJsonObject{{"record", id.mid(slash + 1)}, {"type", id.left(slash)}});
+    }
+    const QString sessionKey = m_sessionKey;
+    NetworkThread::instance()->submit("renew_locks",
+        [sessionKey, held](QNetworkAccessManager *manager) {
+            FormBodyWriter writer;
+            writer.addField("action", "renew_locks");
+            writer.addField("key", sessionKey);
+            writer.addField("lease", QString::number(kLeaseSeconds));
+            writer.beginJsonField("locks");
+            writer.value(QJsonValue(held));
+            return NetworkSession::postForm(manager, "renew_locks", writer.take());
+        },
+        this, [this, renewed = m_held](const NetworkResult &result) {
+            if (!checkSupported(result) || !result.ok() || result.json["status"].toString() != "success") return;
+            applyTable(result.json["locks"].toArray(), renewed);
+        });
+}
+
+// 服务器返回的锁表：[{type, record, holder, expires, mine}]
+void RecordLocks::applyTable(const QJsonArray &locks, const QSet<QString> &renewed)
+{
+    QHash<QString, RecordLock> table;
+    QSet<QString> changedTypes;
+    for (const QJsonValue &v : locks) {
+        const QJsonObject obj = v.toObject();
+        const QString type = obj["type"].toString();
+        const QString id = lockId(type, obj["record"].toString());
+        RecordLock lock;
+        lock.holder = obj["holder"].toString();
+        lock.expires = QDateTime::fromString(obj["expires"].toString(), Qt::ISODate);
+        lock.mine = obj["mine"].toBool();
+        table.insert(id, lock);
+        const RecordLock old = m_table.value(id);
+        if (old.holder != lock.holder || old.mine != lock.mine) changedTypes.insert(type);
+    }
+    for (auto it = m_table.cbegin(); it != m_table.cend(); ++it) {
+        if (!table.contains(it.key())) changedTypes.insert(it.key().section('/', 0, 0));
+    }
+
+    // 这次心跳续约过、服务器却不再登记为自己的锁：已经丢失（心跳发出之后才申请到的锁不在此列）
+    for (const QString &id : renewed) {
+        if (!m_held.contains(id) || table.value(id).mine) continue;
+        m_held.remove(id);
+        const int slash = id.indexOf('/');
+        emit lockLost(id.left(slash), id.mid(slash + 1));
+    }
+
+    m_table = table;
+    for (const QString &type : std::as_const(changedTypes)) emit locksChanged(type);
+}
@@ -0,0 +1,74 @@
+// recordlocks.h
+#ifndef RECORDLOCKS_H
+#define RECORDLOCKS_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+
+class QTimer;
+class QJsonArray;
+struct NetworkResult;
+
+// 一条记录上的编辑锁
+struct RecordLock {
+    QString holder;   // 持有者的用户名
+    QDateTime expires;
+    bool mine = false;
+};
+
+// --- 按记录加锁，多个管理员同时编辑 ---
+// 原来服务器只允许一个管理员登录（全局锁，登录窗口的“无法登录？”就是强制清除它）。
+// 现在登录时请求记录级锁模式（lock_mode=record），编辑某条记录前申请这条记录的锁：
+//   - 锁是短租约（60 秒），持有期间每 20 秒心跳续约一次，程序崩溃或断网后锁会自动过期
+//   - 心跳的响应同时带回所有人持有的锁，列表据此显示“某某正在编辑”
+//   - 其他人持有锁的记录只读；保存时再与服务器的最新数据做三方合并（见 RecordMerge），
+//     只有同一条记录被双方改动才算冲突，不再需要把别人踢下线
+// 记录用“类型 + 业务键”标识，例如 ("jobs", 职位名称)、("products", 产品名称)。
+// 因此在记录锁下改名并不受支持：锁只能跟着名称走——管理页面在改名停下来后放掉旧名称的锁、
+// 改用新名称申请；保存前服务器上的记录仍是旧名称，旧名称的锁放掉后别人可以拿到并修改它，
+// 合并时改名表现为删除旧记录、新增一条，别人对旧记录的修改会与之冲突。
+// 老版本服务器不认识这些请求时退回原来的全局锁模式：isSupported() 为 false，申请总是立即成功。
+class RecordLocks : public QObject
+{
+    Q_OBJECT
+
+public:
+    static RecordLocks *instance();
+
+    // 登录后开始心跳；sessionKey 为空时停止并放弃所有锁
+    void setSessionKey(const QString &sessionKey);
+    bool isSupported() const { return m_supported; }
+
+    // 申请编辑锁，结果通过 acquireFinished 报告
+    void acquire(const QString &type, const QString &record);
+    void release(const QString &type, const QString &record);
+    bool holds(const QString &type, const QString &record) const;
+    // 持有这条记录的其他管理员；没人持有或是自己持有时为空
+    QString otherHolder(const QString &type, const QString &record) const;
+
+signals:
+    void acquireFinished(const QString &type, const QString &record, bool granted, const QString &holder);
+    // 锁表有变化（心跳带回了新的状态），列表需要刷新标记
+    void locksChanged(const QString &type);
+    // 续约失败，锁已经被别人拿走或过期
+    void lockLost(const QString &type, const QString &record);
+
+private:
+    explicit RecordLocks(QObject *parent = nullptr);
+
+    static QString lockId(const QString &type, const QString &record);
+    void heartbeat();
+    void post(const QString &action, const QString &type, const QString &record);
+    bool checkSupported(const NetworkResult &result);
+    void applyTable(const QJsonArray &locks, const QSet<QString> &renewed);
+
+    QString m_sessionKey;
+    bool m_supported = true;
+    QTimer *m_heartbeat;
+    QSet<QString> m_held;                 // lockId
+    QHash<QString, RecordLock> m_table;   // lockId -> 锁
+};
+
+#endif // RECORDLOCKS_H
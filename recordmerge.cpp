@@ -0,0 +1,48 @@
+// recordmerge.cpp
+#include "recordmerge.h"
+#include "jsonbackend.h"
+#include "networksession.h"
+#include "networkthread.h"
+
+#include <QNetworkAccessManager>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QFutureWatcher>
+
+namespace RecordMerge {
+
+QString jobKey(const Job &job)
+{
+    return job.title;
+}
+
+QString productKey(const Product &product)
+{
+    return product.name;
+}
+
+void fetchServer(QObject *context, std::function<void(const NetworkResult &result, const SyncResponse &response)> done)
+{
+    NetworkThread::instance()->submit("get_all_data",
+        [](QNetworkAccessManager *manager) {
+            QNetworkRequest request = NetworkSession::apiRequest("get_all_data");
+            request.setAttribute(QNetworkRequest::User, "get_all_data");
+            request.setAttribute(NetworkThread::RawBodyAttribute, true);
+            return manager->get(request);
+        },
+        context, [context, done](const NetworkResult &result) {
+            if (!result.ok()) {
+                done(result, SyncResponse());
+                return;
+            }
+            // 解析放到工作线程，整表数据较大时不占用界面线程
+            auto *watcher = new QFutureWatcher<SyncResponse>(context);
+            QObject::connect(watcher, &QFutureWatcher<SyncResponse>::finished, context, [watcher, result, done]() {
+                watcher->deleteLater();
+                done(result, watcher->result());
+            });
+            const QByteArray body = result.body;
+            watcher->setFuture(QtConcurrent::run([body]() { return JsonBackend::active().parse(body); }));
+        });
+}
+
+} // namespace RecordMerge
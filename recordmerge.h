@@ -0,0 +1,107 @@
+// recordmerge.h
+#ifndef RECORDMERGE_H
+#define RECORDMERGE_H
+
+#include <QHash>
+#include <QList>
+#include <QStringList>
+#include <functional>
+#include "datastructures.h"
+
+class QObject;
+struct NetworkResult;
+struct SyncResponse;
+
+// --- 保存前的三方合并 ---
+// 服务器的保存接口是整表覆盖的，多个管理员同时编辑时，后保存的人会冲掉别人刚保存的修改。
+// 现在保存前先取回服务器的最新数据（theirs），以上次与服务器一致的版本（base，DataStore::syncBase）
+// 为共同祖先，和本地数据（mine）逐条合并：
+//   - 只有一方改过的记录取改过的那一方（新增、删除同样算改动）
+//   - 双方改成一样的直接采用
+//   - 双方改得不一样才算冲突：保留本地版本（本地持有这条记录的编辑锁时不会发生），并报告给用户
+// 记录按业务键（职位名称、产品名称）对应；同名的多条记录按出现顺序分别对应。
+namespace RecordMerge {
+
+template <typename T>
+struct Result {
+    QList<T> records;
+    QStringList conflicts; // 冲突记录的名称
+    int fromServer = 0;    // 采用了服务器版本（包括服务器新增、删除）的记录数
+};
+
+QString jobKey(const Job &job);
+QString productKey(const Product &product);
+
+// name 给出记录的业务键，例如 jobKey / productKey
+template <typename T, typename Name>
+Result<T> threeWay(const QList<T> &base, const QList<T> &mine, const QList<T> &theirs, Name name)
+{
+    // 业务键加上同名记录的序号
+    auto keyed = [&name](const QList<T> &list) {
+        QList<QString> keys;
+        QHash<QString, int> seen;
+        keys.reserve(list.size());
+        for (const T &item : list) {
+            const QString n = name(item);
+            keys.append(n + QChar(0x1) + QString::number(seen[n]++));
+        }
+        return keys;
+    };
+    auto index = [](const QList<QString> &keys) {
+        QHash<QString, int> map;
+        for (int i = 0; i < keys.size(); ++i) map.insert(keys[i], i);
+        return map;
+    };
+    const QList<QString> mineKeys = keyed(mine), theirKeys = keyed(theirs);
+    const QHash<QString, int> baseIndex = index(keyed(base));
+    const QHash<QString, int> theirIndex = index(theirKeys);
+    const QHash<QString, int> mineIndex = index(mineKeys);
+
+    Result<T> result;
+    // 本地列表的顺序为准
+    for (int i = 0; i < mine.size(); ++i) {
+        const T &m = mine[i];
+        const int b = baseIndex.value(mineKeys[i], -1);
+        const int t = theirIndex.value(mineKeys[i], -1);
+        const bool mineChanged = b < 0 || base[b] != m;
+        if (t >= 0) {
+            const T &their = theirs[t];
+            const bool theirsChanged = b < 0 || base[b] != their;
+            if (!mineChanged && theirsChanged) {
+                result.records.append(their);
+                ++result.fromServer;
+                continue;
+            }
+            if (mineChanged && theirsChanged && their != m) result.conflicts.append(name(m));
+            result.records.append(m);
+        } else if (b >= 0) {
+            // 服务器上已被删除：本地没改过就跟着删除，改过则保留并报告冲突
+            if (!mineChanged) {
+                ++result.fromServer;
+                continue;
+            }
+            result.conflicts.append(name(m));
+            result.records.append(m);
+        } else {
+            result.records.append(m); // 本地新增
+        }
+    }
+    // 服务器上有、本地没有的记录：服务器新增的追加在末尾；本地删除的，服务器没改过就删除，改过则恢复并报告冲突
+    for (int i = 0; i < theirs.size(); ++i) {
+        if (mineIndex.contains(theirKeys[i])) continue;
+        const int b = baseIndex.value(theirKeys[i], -1);
+        if (b >= 0 && base[b] == theirs[i]) continue;
+        if (b >= 0) result.conflicts.append(name(theirs[i]));
+        result.records.append(theirs[i]);
+        ++result.fromServer;
+    }
+    return result;
+}
+
+// 在网络线程上取回服务器的最新数据（get_all_data），解析后在界面线程回调；
+// result 不成功时 response 为空
+void fetchServer(QObject *context, std::function<void(const NetworkResult &result, const SyncResponse &response)> done);
+
+} // namespace RecordMerge
+
+#endif // RECORDMERGE_H
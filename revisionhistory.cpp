@@ -0,0 +1,553 @@
+// revisionhistory.cpp
+#include "revisionhistory.h"
+#include "siteregistry.h"
+
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSet>
+#include <QtEndian>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+const char kMagic[4] = { 'H', 'R', 'R', 'V' };
+const qint32 kFormatVersion = 1;
+const int kHeaderSize = 8;
+// 条目头：4 字节长度 + 8 字节时间 + 1 字节类型 + 1 字节标志
+const int kEntryHeaderSize = 14;
+// 每条记录每隔多少个版本存一次完整内容
+const int kKeyframeInterval = 16;
+// 超过这个大小的条目尝试压缩
+const int kCompressThreshold = 128;
+
+enum Flag : quint8 {
+    Keyframe   = 0x1,
+    Deleted    = 0x2,
+    Saved      = 0x4,
+    Compressed = 0x8
+};
+
+// 变长整数，小的长度和偏移只占一个字节
+void writeVarint(QByteArray &out, quint64 value)
+{
+    while (value >= 0x80) {
+        out.append(char(value | 0x80));
+        value >>= 7;
+    }
+    out.append(char(value));
+}
+
+void writeString(QByteArray &out, const QString &text)
+{
+    const QByteArray utf8 = text.toUtf8();
+    writeVarint(out, quint64(utf8.size()));
+    out.append(utf8);
+}
+
+// 带越界检查的读取；任何一步出错后 ok 为 false，之后的读取都返回空值
+struct Reader {
+    const QByteArray &data;
+    qint64 pos = 0;
+    bool ok = true;
+
+    explicit Reader(const QByteArray &d) : data(d) {}
+
+    quint64 varint()
+    {
+        quint64 value = 0;
+        for (int shift = 0; ok && shift < 64; shift += 7) {
+            if (pos >= data.size()) break;
+            const quint8 byte = quint8(data[pos++]);
+            value |= quint64(byte & 0x7f) << shift;
+            if (!(byte & 0x80)) return value;
+        }
+        ok = false;
+        return 0;
+    }
+
+    QString string()
+    {
+        const quint64 size = varint();
+        if (!ok || size > quint64(data.size() - pos)) {
+            ok = false;
+            return QString();
+        }
+        const QString text = QString::fromUtf8(data.constData() + pos, qsizetype(size));
+        pos += qint64(size);
+        return text;
+    }
+};
+
+// a 变成 b 时两端相同的部分，不拆开代理对，保证中间部分能单独按 UTF-8 编码
+void commonEnds(const QString &a, const QString &b, int &prefix, int &suffix)
+{
+    const int limit = int(qMin(a.size(), b.size()));
+    prefix = 0;
+    while (prefix < limit && a[prefix] == b[prefix]) ++prefix;
+    if (prefix > 0 && b[prefix - 1].isHighSurrogate()) --prefix;
+    suffix = 0;
+    while (suffix < limit - prefix && a[a.size() - 1 - suffix] == b[b.size() - 1 - suffix]) ++suffix;
+    if (suffix > 0 && b[b.size() - suffix].isLowSurrogate()) --suffix;
+}
+
+QByteArray keyframeBody(const QStringList &fields)
+{
+    QByteArray body;
+    writeVarint(body, quint64(fields.size()));
+    for (const QString &field : fields) writeString(body, field);
+    return body;
+}
+
+// 差分：改动字段的位掩码，每个改动字段存相同前缀长度、相同后缀长度和中间的新内容
+QByteArray deltaBody(const QStringList &from, const QStringList &to)
+{
+    quint64 mask = 0;
+    QByteArray changes;
+    for (int i = 0; i < to.size(); ++i) {
+        if (from[i] == to[i]) continue;
+        mask |= quint64(1) << i;
+        int prefix = 0, suffix = 0;
+        commonEnds(from[i], to[i], prefix, suffix);
+        writeVarint(changes, quint64(prefix));
+        writeVarint(changes, quint64(suffix));
+        writeString(changes, to[i].mid(prefix, to[i].size() - prefix - suffix));
+    }
+    QByteArray body;
+    writeVarint(body, quint64(to.size()));
+    writeVarint(body, mask);
+    body.append(changes);
+    return body;
+}
+
+bool applyKeyframe(const QByteArray &body, QStringList &fields)
+{
+    Reader in(body);
+    const quint64 count = in.varint();
+    if (!in.ok || count > 64) return false;
+    QStringList result;
+    for (quint64 i = 0; i < count && in.ok; ++i) result.append(in.string());
+    if (!in.ok) return false;
+    fields = result;
+    return true;
+}
+
+bool applyDelta(const QByteArray &body, QStringList &fields)
+{
+    Reader in(body);
+    const quint64 count = in.varint();
+    const quint64 mask = in.varint();
+    if (!in.ok || count != quint64(fields.size())) return false;
+    QStringList result = fields;
+    for (int i = 0; i < result.size() && in.ok; ++i) {
+        if (!(mask & (quint64(1) << i))) continue;
+        const quint64 prefix = in.varint();
+        const quint64 suffix = in.varint();
+        const QString middle = in.string();
+        const QString &old = result[i];
+        if (!in.ok || prefix + suffix > quint64(old.size())) return false;
+        result[i] = old.left(qsizetype(prefix)) + middle + old.right(qsizetype(suffix));
+    }
+    if (!in.ok) return false;
+    fields = result;
+    return true;
+}
+
+QString chainId(RevisionHistory::Kind kind, const QString &key)
+{
+    return QString::number(kind) + QChar(0x1f) + key;
+}
+
+} // namespace
+
+RevisionHistory *RevisionHistory::instance()
+{
+    static RevisionHistory *history = new RevisionHistory(qApp);
+    return history;
+}
+
+RevisionHistory::RevisionHistory(QObject *parent)
+    : QObject(parent)
+{
+}
+
+QString RevisionHistory::historyFilePath()
+{
+    return SiteRegistry::instance()->localDataPath("revision_history.bin");
+}
+
+void RevisionHistory::startRecording()
+{
+    if (m_recording) return;
+    m_recording = true;
+    auto *store = DataStore::instance();
+    connect(store, &DataStore::baseChanged, this, [this, store](DataStore::Sections sections, bool saved) {
+        const RevisionInfo::Source source = saved ? RevisionInfo::Saved : RevisionInfo::Synced;
+        const Snapshot &base = store->syncBase();
+        if (sections & DataStore::Jobs) record(base.jobValues(), source);
+        if (sections & DataStore::Products) record(base.productValues(), source);
+    });
+
+    // 登录时预取的数据可能在这之前就已经发布了；空列表不记，免得把所有记录都标成删除
+    const Snapshot &base = store->syncBase();
+    if (base.version == 0) return;
+    if (!base.jobs.isEmpty()) record(base.jobValues(), RevisionInfo::Synced);
+    if (!base.products.isEmpty()) record(base.productValues(), RevisionInfo::Synced);
+}
+
+// --- 字段 ---
+
+QString RevisionHistory::kindName(Kind kind)
+{
+    switch (kind) {
+    case Jobs:     return "职位";
+    case Products: return "产品";
+    case Cases:    return "案例";
+    default:       return QString();
+    }
+}
+
+QStringList RevisionHistory::fieldNames(Kind kind)
+{
+    switch (kind) {
+    case Jobs:     return {"职位名称", "招聘人数", "起始薪资", "最高薪资", "岗位要求"};
+    case Products: return {"产品名称", "产品分类", "产品介绍", "图片"};
+    case Cases:    return {"案例标题", "案例介绍", "图片"};
+    default:       return {};
+    }
+}
+
+// 图片地址每行一个，增删一张图片时差分只涉及那一行附近
+QStringList RevisionHistory::fieldsOf(const Job &job)
+{
+    return {job.title, job.quota, job.salaryStart, job.salaryEnd, job.requirements};
+}
+
+QStringList RevisionHistory::fieldsOf(const Product &product)
+{
+    return {product.name, product.category, product.description, product.imageUrls.join('\n')};
+}
+
+QStringList RevisionHistory::fieldsOf(const CaseStudy &caseStudy)
+{
+    return {caseStudy.title, caseStudy.description, caseStudy.imageUrls.join('\n')};
+}
+
+Job RevisionHistory::jobFromFields(const QStringList &fields)
+{
+    Job job;
+    if (fields.size() < 5) return job;
+    job.title = fields[0];
+    job.quota = fields[1];
+    job.salaryStart = fields[2];
+    job.salaryEnd = fields[3];
+    job.requirements = fields[4];
+    return job;
+}
+
+Product RevisionHistory::productFromFields(const QStringList &fields)
+{
+    Product product;
+    if (fields.size() < 4) return product;
+    product.name = fields[0];
+    product.category = fields[1];
+    product.description = fields[2];
+    product.imageUrls = fields[3].split('\n', Qt::SkipEmptyParts);
+    return product;
+}
+
+// --- 记录 ---
+
+void RevisionHistory::record(const QList<Job> &jobs, RevisionInfo::Source source)
+{
+    QList<QPair<QString, QStringList>> items;
+    items.reserve(jobs.size());
+    for (const Job &job : jobs) items.append({job.title, fieldsOf(job)});
+    recordFields(Jobs, items, source);
+}
+
+void RevisionHistory::record(const QList<Product> &products, RevisionInfo::Source source)
+{
+    QList<QPair<QString, QStringList>> items;
+    items.reserve(products.size());
+    for (const Product &product : products) items.append({product.name, fieldsOf(product)});
+    recordFields(Products, items, source);
+}
+
+void RevisionHistory::record(const QList<CaseStudy> &cases, RevisionInfo::Source source)
+{
+    QList<QPair<QString, QStringList>> items;
+    items.reserve(cases.size());
+    for (const CaseStudy &caseStudy : cases) items.append({caseStudy.title, fieldsOf(caseStudy)});
+    recordFields(Cases, items, source);
+}
+
+RevisionHistory::Chain *RevisionHistory::chain(Kind kind, const QString &key)
+{
+    const QString id = chainId(kind, key);
+    auto it = m_index.constFind(id);
+    if (it != m_index.constEnd()) return &m_chains[*it];
+    Chain c;
+    c.kind = kind;
+    c.key = key;
+    m_index.insert(id, int(m_chains.size()));
+    m_chains.append(c);
+    return &m_chains.last();
+}
+
+void RevisionHistory::recordFields(Kind kind, const QList<QPair<QString, QStringList>> &items, RevisionInfo::Source source)
+{
+    load();
+
+    const QString &path = m_filePath;
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::ReadWrite)) {
+        qDebug() << "Cannot append to revision history" << path;
+        return;
+    }
+    if (m_validSize < kHeaderSize || file.size() < m_validSize) {
+        // 还没有可用的文件，或者文件被删掉、换掉了：已有的索引指向的内容不在了，从头开始
+        m_chains.clear();
+        m_index.clear();
+        file.resize(0);
+        file.write(kMagic, 4);
+        const qint32 version = qToLittleEndian(kFormatVersion);
+        file.write(reinterpret_cast<const char *>(&version), 4);
+        m_validSize = kHeaderSize;
+    } else if (file.size() > m_validSize) {
+        file.resize(m_validSize); // 上次写到一半的条目
+    }
+    file.seek(m_validSize);
+
+    const qint64 now = QDateTime::currentMSecsSinceEpoch();
+    QByteArray batch;
+    auto append = [&](Chain *c, quint8 flags, QByteArray body) {
+        if (body.size() >= kCompressThreshold) {
+            const QByteArray compressed = qCompress(body);
+            if (compressed.size() < body.size()) {
+                body = compressed;
+                flags |= Compressed;
+            }
+        }
+        if (source == RevisionInfo::Saved) flags |= Saved;
+        const QByteArray key = c->key.toUtf8();
+        QByteArray head;
+        writeVarint(head, quint64(key.size()));
+        head.append(key);
+
+        Entry entry;
+        entry.time = now;
+        entry.offset = m_validSize + batch.size();
+        entry.flags = flags;
+        c->entries.append(entry);
+
+        const quint32 size = quint32(kEntryHeaderSize - 4 + head.size() + body.size());
+        const quint32 sizeLe = qToLittleEndian(size);
+        const qint64 timeLe = qToLittleEndian(now);
+        batch.append(reinterpret_cast<const char *>(&sizeLe), 4);
+        batch.append(reinterpret_cast<const char *>(&timeLe), 8);
+        batch.append(char(kind));
+        batch.append(char(flags));
+        batch.append(head);
+        batch.append(body);
+    };
+
+    // 同名的记录（理论上不该有）加上序号区分，免得互相当成对方的新版本
+    QHash<QString, int> seen;
+    QSet<QString> present;
+    for (const auto &item : items) {
+        const int n = ++seen[item.first];
+        const QString key = n == 1 ? item.first : QString("%1 #%2").arg(item.first).arg(n);
+        present.insert(key);
+
+        Chain *c = chain(kind, key);
+        if (c->live && c->latest == item.second) continue;
+
+        const QByteArray full = keyframeBody(item.second);
+        if (!c->live || c->latest.size() != item.second.size() || c->sinceKeyframe >= kKeyframeInterval - 1) {
+            append(c, Keyframe, full);
+            c->sinceKeyframe = 0;
+        } else {
+            const QByteArray delta = deltaBody(c->latest, item.second);
+            if (delta.size() < full.size()) {
+                append(c, 0, delta);
+                ++c->sinceKeyframe;
+            } else {
+                append(c, Keyframe, full);
+                c->sinceKeyframe = 0;
+            }
+        }
+        c->latest = item.second;
+        c->live = true;
+    }
+
+    // 列表里已经没有的记录追加删除标记
+    for (Chain &c : m_chains) {
+        if (c.kind != kind || !c.live || present.contains(c.key)) continue;
+        append(&c, Deleted, QByteArray());
+        c.latest.clear();
+        c.live = false;
+        c.sinceKeyframe = 0;
+    }
+
+    if (batch.isEmpty()) return;
+    if (file.write(batch) != batch.size()) {
+        // 写入失败：丢掉内存中刚加的条目，重新从文件建立索引
+        qDebug() << "Failed to write revision history" << path << file.errorString();
+        file.close();
+        m_loaded = false;
+        m_chains.clear();
+        m_index.clear();
+        m_validSize = 0;
+        return;
+    }
+    m_validSize += batch.size();
+    emit revisionsAppended(kind);
+}
+
+// --- 读取 ---
+
+bool RevisionHistory::readEntry(const QByteArray &data, qint64 &pos, Entry &entry, Kind &kind,
+                                QString &key, QByteArray &body) const
+{
+    if (data.size() - pos < kEntryHeaderSize) return false;
+    const char *p = data.constData() + pos;
+    const quint32 size = qFromLittleEndian<quint32>(p);
+    if (size < quint32(kEntryHeaderSize - 4) || qint64(size) > data.size() - pos - 4) return false;
+
+    entry.offset = pos;
+    entry.time = qFromLittleEndian<qint64>(p + 4);
+    const quint8 k = quint8(p[12]);
+    if (k >= KindCount) return false;
+    kind = Kind(k);
+    entry.flags = quint8(p[13]);
+
+    const QByteArray rest = data.mid(pos + kEntryHeaderSize, qsizetype(size) - (kEntryHeaderSize - 4));
+    Reader in(rest);
+    key = in.string();
+    if (!in.ok) return false;
+    body = rest.mid(in.pos);
+    if (entry.flags & Compressed) {
+        body = qUncompress(body);
+        if (body.isEmpty()) return false;
+    }
+    pos += 4 + qint64(size);
+    return true;
+}
+
+void RevisionHistory::load()
+{
+    if (m_loaded) return;
+    m_loaded = true;
+
+    // 历史属于载入时的站点，之后的追加和读取都用同一个文件，不会在站点之间恢复版本
+    m_filePath = historyFilePath();
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) return;
+    const QByteArray data = file.readAll();
+    if (data.size() < kHeaderSize || !data.startsWith(QByteArray(kMagic, 4))) {
+        qDebug() << "Ignoring unrecognised revision history file" << file.fileName();
+        return;
+    }
+
+    // 顺序重放一遍，得到每条记录的最新内容；遇到不完整或损坏的条目就停在那里
+    qint64 pos = kHeaderSize;
+    Entry entry;
+    Kind kind;
+    QString key;
+    QByteArray body;
+    while (readEntry(data, pos, entry, kind, key, body)) {
+        Chain *c = chain(kind, key);
+        if (entry.flags & Deleted) {
+            c->latest.clear();
+            c->live = false;
+            c->sinceKeyframe = 0;
+        } else if (entry.flags & Keyframe) {
+            if (!applyKeyframe(body, c->latest)) break;
+            c->live = true;
+            c->sinceKeyframe = 0;
+        } else {
+            if (!c->live || !applyDelta(body, c->latest)) break;
+            ++c->sinceKeyframe;
+        }
+        c->entries.append(entry);
+        m_validSize = pos;
+    }
+    if (m_validSize == 0) m_validSize = kHeaderSize;
+    if (pos < data.size())
+        qDebug() << "Revision history truncated at" << m_validSize << "of" << data.size() << "bytes";
+}
+
+QList<RevisionRecord> RevisionHistory::records(Kind kind)
+{
+    load();
+    QList<RevisionRecord> result;
+    for (const Chain &c : m_chains) {
+        if (c.kind != kind || c.entries.isEmpty()) continue;
+        RevisionRecord r;
+        r.key = c.key;
+        r.revisionCount = int(c.entries.size());
+        r.lastTime = c.entries.last().time;
+        r.deleted = !c.live;
+        result.append(r);
+    }
+    std::sort(result.begin(), result.end(), [](const RevisionRecord &a, const RevisionRecord &b) {
+        return a.lastTime > b.lastTime;
+    });
+    return result;
+}
+
+QList<RevisionInfo> RevisionHistory::revisions(Kind kind, const QString &key)
+{
+    load();
+    QList<RevisionInfo> result;
+    const auto it = m_index.constFind(chainId(kind, key));
+    if (it == m_index.constEnd()) return result;
+    for (const Entry &entry : m_chains[*it].entries) {
+        RevisionInfo info;
+        info.time = entry.time;
+        info.source = (entry.flags & Saved) ? RevisionInfo::Saved : RevisionInfo::Synced;
+        info.deleted = entry.flags & Deleted;
+        result.append(info);
+    }
+    return result;
+}
+
+QStringList RevisionHistory::fieldsAt(Kind kind, const QString &key, int index)
+{
+    load();
+    const auto it = m_index.constFind(chainId(kind, key));
+    if (it == m_index.constEnd()) return {};
+    const QList<Entry> &entries = m_chains[*it].entries;
+    if (index < 0 || index >= entries.size() || (entries[index].flags & Deleted)) return {};
+
+    // 最新一版常驻内存，不用读文件
+    if (index == entries.size() - 1) return m_chains[*it].latest;
+
+    int first = index;
+    while (first > 0 && !(entries[first].flags & Keyframe)) --first;
+
+    QFile file(m_filePath);
+    if (!file.open(QIODevice::ReadOnly)) return {};
+    QStringList fields;
+    for (int i = first; i <= index; ++i) {
+        if (!file.seek(entries[i].offset)) return {};
+        quint32 sizeLe = 0;
+        if (file.read(reinterpret_cast<char *>(&sizeLe), 4) != 4) return {};
+        const QByteArray data = QByteArray(reinterpret_cast<const char *>(&sizeLe), 4)
+                                + file.read(qFromLittleEndian(sizeLe));
+        qint64 pos = 0;
+        Entry entry;
+        Kind entryKind;
+        QString entryKey;
+        QByteArray body;
+        if (!readEntry(data, pos, entry, entryKind, entryKey, body)) return {};
+        const bool ok = (entry.flags & Keyframe) ? applyKeyframe(body, fields) : applyDelta(body, fields);
+        if (!ok) return {};
+    }
+    return fields;
+}
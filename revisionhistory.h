@@ -0,0 +1,106 @@
+// revisionhistory.h
+#ifndef REVISIONHISTORY_H
+#define REVISIONHISTORY_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QPair>
+#include <QStringList>
+#include "datastore.h"
+
+// 一条记录的一个历史版本（不含内容，内容用 RevisionHistory::fieldsAt 读取）
+struct RevisionInfo {
+    enum Source { Synced, Saved };
+    qint64 time = 0;        // 毫秒，UTC
+    Source source = Synced; // 从服务器同步到的，还是本机保存上去的
+    bool deleted = false;   // 这一版记录从服务器数据中消失了
+};
+
+// 有历史版本的一条记录
+struct RevisionRecord {
+    QString key;            // 职位名称 / 产品名称 / 案例标题
+    int revisionCount = 0;
+    qint64 lastTime = 0;
+    bool deleted = false;   // 最新一版是删除
+};
+
+// --- 每条记录的本地历史版本 ---
+// save_jobs / save_products 整表覆盖服务器数据后，旧版本就找不回来了；这里在本地保存
+// 每条职位、产品、案例同步到的和保存上去的每一个版本，可以浏览、对比和恢复。
+//   - 只有内容变了的记录才追加新版本，没变的记录不占空间
+//   - 新版本按字段与上一版做差分：每个改动的字段只存去掉相同前缀和后缀后中间变化的部分，
+//     一次典型的修改只需几十个字节；每条记录每 16 个版本存一次完整内容（关键帧），
+//     打开任意版本最多读一个关键帧加 15 个差分
+//   - 较大的条目用 qCompress 压缩；大型目录一年的历史也只有几 MB
+// 文件是只追加的二进制记录（revision_history.bin，每个站点一个，见 SiteRegistry::localDataPath），追加时不重写整个文件；
+// 第一次使用时扫描一遍建立索引，之后读取某个版本只按偏移读取需要的几条。
+// 写到一半被中断时，末尾不完整的条目在读取时被丢弃，下次追加前截掉。
+class RevisionHistory : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum Kind { Jobs, Products, Cases, KindCount };
+
+    static RevisionHistory *instance();
+
+    // 开始记录 DataStore 的同步和保存（界面程序启动时调用一次）
+    void startRecording();
+
+    // 记录一份完整列表：内容有变化的记录追加新版本，列表中已经没有的记录追加删除标记
+    void record(const QList<Job> &jobs, RevisionInfo::Source source);
+    void record(const QList<Product> &products, RevisionInfo::Source source);
+    void record(const QList<CaseStudy> &cases, RevisionInfo::Source source);
+
+    // 有历史的记录，按最近修改时间降序
+    QList<RevisionRecord> records(Kind kind);
+    // 某条记录的全部版本，按时间升序
+    QList<RevisionInfo> revisions(Kind kind, const QString &key);
+    // 第 index 个版本的各字段内容（顺序同 fieldNames）；删除标记返回空列表
+    QStringList fieldsAt(Kind kind, const QString &key, int index);
+
+    static QString kindName(Kind kind);
+    static QStringList fieldNames(Kind kind);
+    static QStringList fieldsOf(const Job &job);
+    static QStringList fieldsOf(const Product &product);
+    static QStringList fieldsOf(const CaseStudy &caseStudy);
+    static Job jobFromFields(const QStringList &fields);
+    static Product productFromFields(const QStringList &fields);
+
+signals:
+    void revisionsAppended(RevisionHistory::Kind kind);
+
+private:
+    explicit RevisionHistory(QObject *parent = nullptr);
+
+    struct Entry {
+        qint64 time = 0;
+        qint64 offset = 0; // 条目在文件中的位置
+        quint8 flags = 0;
+    };
+
+    struct Chain {
+        Kind kind = Jobs;
+        QString key;
+        QList<Entry> entries;
+        QStringList latest;     // 最新一版的内容，用来判断有没有变化和生成差分
+        int sinceKeyframe = 0;  // 最新一版之前连续差分的个数
+        bool live = false;      // 最新一版不是删除标记
+    };
+
+    void recordFields(Kind kind, const QList<QPair<QString, QStringList>> &items, RevisionInfo::Source source);
+    Chain *chain(Kind kind, const QString &key);
+    void load();
+    bool readEntry(const QByteArray &data, qint64 &pos, Entry &entry, Kind &kind, QString &key, QByteArray &body) const;
+    static QString historyFilePath();
+
+    bool m_loaded = false;
+    QString m_filePath; // 当前站点的历史文件
+    bool m_recording = false;
+    qint64 m_validSize = 0; // 文件中完整条目的结尾
+    QList<Chain> m_chains;
+    QHash<QString, int> m_index; // kind + key -> m_chains 下标
+};
+
+#endif // REVISIONHISTORY_H
@@ -0,0 +1,299 @@
+// revisionhistorydialog.cpp
+#include "revisionhistorydialog.h"
+#include "recordlocks.h"
+
+#include <QComboBox>
+#include <QDateTime>
+#include <QDialogButtonBox>
+#include <QHBoxLayout>
+#include <QLabel>
+#include <QLineEdit>
+#include <QListWidget>
+#include <QMessageBox>
+#include <QPushButton>
+#include <QSplitter>
+#include <QTextBrowser>
+#include <QVBoxLayout>
+
+namespace {
+
+QString html(const QString &text)
+{
+    return text.toHtmlEscaped().replace('\n', "<br>");
+}
+
+// 只标出中间变化的部分，两端相同的内容照常显示
+QString diffHtml(const QString &before, const QString &after)
+{
+    const int limit = int(qMin(before.size(), after.size()));
+    int prefix = 0;
+    while (prefix < limit && before[prefix] == after[prefix]) ++prefix;
+    int suffix = 0;
+    while (suffix < limit - prefix && before[before.size() - 1 - suffix] == after[after.size() - 1 - suffix]) ++suffix;
+
+    QString result = html(before.left(prefix));
+    const QString removed = before.mid(prefix, before.size() - prefix - suffix);
+    const QString added = after.mid(prefix, after.size() - prefix - suffix);
+    if (!removed.isEmpty()) result += "<span style=\"color:#c0392b;text-decoration:line-through;\">" + html(removed) + "</span>";
+    if (!added.isEmpty()) result += "<span style=\"color:#1e8449;background:#e8f8f0;\">" + html(added) + "</span>";
+    return result + html(after.right(suffix));
+}
+
+QString sourceName(const RevisionInfo &info)
+{
+    if (info.deleted) return "删除";
+    return info.source == RevisionInfo::Saved ? "保存" : "同步";
+}
+
+} // namespace
+
+RevisionHistoryDialog::RevisionHistoryDialog(QWidget *parent)
+    : QDialog(parent)
+    , m_kindCombo(new QComboBox(this))
+    , m_filterEdit(new QLineEdit(this))
+    , m_recordList(new QListWidget(this))
+    , m_revisionList(new QListWidget(this))
+    , m_compareCombo(new QComboBox(this))
+    , m_diffView(new QTextBrowser(this))
+    , m_statusLabel(new QLabel(this))
+    , m_restoreButton(new QPushButton("恢复此版本", this))
+{
+    setWindowTitle("历史版本");
+    setAttribute(Qt::WA_DeleteOnClose);
+    resize(960, 600);
+
+    for (int k = 0; k < RevisionHistory::KindCount; ++k)
+        m_kindCombo->addItem(RevisionHistory::kindName(RevisionHistory::Kind(k)));
+    m_filterEdit->setPlaceholderText("按名称筛选");
+    m_filterEdit->setClearButtonEnabled(true);
+    m_compareCombo->addItems({"与上一版本对比", "与当前数据对比"});
+
+    auto *top = new QHBoxLayout;
+    top->addWidget(m_kindCombo);
+    top->addWidget(m_filterEdit, 1);
+    top->addWidget(m_compareCombo);
+
+    auto *splitter = new QSplitter(this);
+    splitter->addWidget(m_recordList);
+    splitter->addWidget(m_revisionList);
+    splitter->addWidget(m_diffView);
+    splitter->setStretchFactor(0, 2);
+    splitter->setStretchFactor(1, 2);
+    splitter->setStretchFactor(2, 5);
+
+    auto *buttons = new QDialogButtonBox(QDialogButtonBox::Close, this);
+    buttons->addButton(m_restoreButton, QDialogButtonBox::ActionRole);
+    connect(buttons, &QDialogButtonBox::rejected, this, &QDialog::close);
+
+    auto *bottom = new QHBoxLayout;
+    bottom->addWidget(m_statusLabel, 1);
+    bottom->addWidget(buttons);
+
+    auto *layout = new QVBoxLayout(this);
+    layout->addLayout(top);
+    layout->addWidget(splitter, 1);
+    layout->addLayout(bottom);
+
+    connect(m_kindCombo, &QComboBox::currentIndexChanged, this, &RevisionHistoryDialog::refreshRecords);
+    connect(m_filterEdit, &QLineEdit::textChanged, this, &RevisionHistoryDialog::refreshRecords);
+    connect(m_recordList, &QListWidget::currentRowChanged, this, &RevisionHistoryDialog::refreshRevisions);
+    connect(m_revisionList, &QListWidget::currentRowChanged, this, &RevisionHistoryDialog::refreshDiff);
+    connect(m_compareCombo, &QComboBox::currentIndexChanged, this, &RevisionHistoryDialog::refreshDiff);
+    connect(m_restoreButton, &QPushButton::clicked, this, &RevisionHistoryDialog::restoreSelected);
+    connect(RevisionHistory::instance(), &RevisionHistory::revisionsAppended, this,
+            [this](RevisionHistory::Kind appended) {
+        if (appended == kind()) refreshRecords();
+    });
+
+    refreshRecords();
+}
+
+RevisionHistory::Kind RevisionHistoryDialog::kind() const
+{
+    return RevisionHistory::Kind(m_kindCombo->currentIndex());
+}
+
+QString RevisionHistoryDialog::selectedKey() const
+{
+    const QListWidgetItem *item = m_recordList->currentItem();
+    return item ? item->data(Qt::UserRole).toString() : QString();
+}
+
+int RevisionHistoryDialog::selectedRevision() const
+{
+    const QListWidgetItem *item = m_revisionList->currentItem();
+    return item ? item->data(Qt::UserRole).toInt() : -1;
+}
+
+// 当前快照中同名记录的内容；已经不存在时返回空列表
+QStringList RevisionHistoryDialog::currentFields(const QString &key) const
+{
+    const SnapshotPtr snapshot = DataStore::instance()->current();
+    switch (kind()) {
+    case RevisionHistory::Jobs:
+        for (const auto &job : snapshot->jobs)
+            if (job->title == key) return RevisionHistory::fieldsOf(*job);
+        break;
+    case RevisionHistory::Products:
+        for (const auto &product : snapshot->products)
+            if (product->name == key) return RevisionHistory::fieldsOf(*product);
+        break;
+    case RevisionHistory::Cases:
+        for (const auto &caseStudy : snapshot->cases)
+            if (caseStudy->title == key) return RevisionHistory::fieldsOf(*caseStudy);
+        break;
+    default:
+        break;
+    }
+    return {};
+}
+
+void RevisionHistoryDialog::refreshRecords()
+{
+    const QString selected = selectedKey();
+    const QString filter = m_filterEdit->text().trimmed();
+    const QList<RevisionRecord> records = RevisionHistory::instance()->records(kind());
+
+    m_recordList->blockSignals(true);
+    m_recordList->clear();
+    int selectedRow = -1;
+    for (const RevisionRecord &r : records) {
+        if (!filter.isEmpty() && !r.key.contains(filter, Qt::CaseInsensitive)) continue;
+        auto *item = new QListWidgetItem(r.deleted ? r.key + "（已删除）" : r.key, m_recordList);
+        item->setData(Qt::UserRole, r.key);
+        item->setToolTip(QString("%1 个版本，最近一次 %2").arg(r.revisionCount)
+                             .arg(QDateTime::fromMSecsSinceEpoch(r.lastTime).toString("yyyy-MM-dd HH:mm")));
+        if (r.deleted) item->setForeground(Qt::gray);
+        if (r.key == selected) selectedRow = m_recordList->count() - 1;
+    }
+    m_recordList->blockSignals(false);
+
+    m_statusLabel->setText(QString("共 %1 条%2有历史版本").arg(records.size()).arg(RevisionHistory::kindName(kind())));
+    m_recordList->setCurrentRow(selectedRow >= 0 ? selectedRow : (m_recordList->count() > 0 ? 0 : -1));
+    if (m_recordList->currentRow() < 0) refreshRevisions();
+}
+
+void RevisionHistoryDialog::refreshRevisions()
+{
+    const QString key = selectedKey();
+    const QList<RevisionInfo> revisions = key.isEmpty() ? QList<RevisionInfo>()
+                                                        : RevisionHistory::instance()->revisions(kind(), key);
+    m_revisionList->blockSignals(true);
+    m_revisionList->clear();
+    for (int i = int(revisions.size()) - 1; i >= 0; --i) {
+        const RevisionInfo &info = revisions[i];
+        auto *item = new QListWidgetItem(QString("%1  %2")
+                                             .arg(QDateTime::fromMSecsSinceEpoch(info.time).toString("yyyy-MM-dd HH:mm:ss"),
+                                                  sourceName(info)),
+                                         m_revisionList);
+        item->setData(Qt::UserRole, i);
+        if (info.deleted) item->setForeground(Qt::gray);
+    }
+    m_revisionList->blockSignals(false);
+    m_revisionList->setCurrentRow(m_revisionList->count() > 0 ? 0 : -1);
+    if (m_revisionList->currentRow() < 0) refreshDiff();
+}
+
+void RevisionHistoryDialog::refreshDiff()
+{
+    const QString key = selectedKey();
+    const int index = selectedRevision();
+    m_restoreButton->setEnabled(false);
+    if (key.isEmpty() || index < 0) {
+        m_diffView->clear();
+        return;
+    }
+
+    auto *history = RevisionHistory::instance();
+    const QStringList fields = history->fieldsAt(kind(), key, index);
+    const bool againstCurrent = m_compareCombo->currentIndex() == 1;
+    const QStringList base = againstCurrent ? currentFields(key)
+                             : index > 0 ? history->fieldsAt(kind(), key, index - 1) : QStringList();
+
+    if (fields.isEmpty()) {
+        m_diffView->setHtml("<p>这一版中记录已被删除。选择更早的版本可以查看和恢复删除前的内容。</p>");
+        return;
+    }
+
+    // 新的一侧始终是所选版本；与当前数据对比时，标出的就是恢复这一版会带来的变化
+    const QStringList names = RevisionHistory::fieldNames(kind());
+    QString text;
+    int changed = 0;
+    for (int i = 0; i < fields.size() && i < names.size(); ++i) {
+        const QString before = i < base.size() ? base[i] : QString();
+        const bool differs = base.isEmpty() || before != fields[i];
+        if (differs) ++changed;
+        text += QString("<p><b>%1</b>%2<br>%3</p>")
+                    .arg(names[i].toHtmlEscaped(),
+                         differs && !base.isEmpty() ? QString("<span style=\"color:#b9770e;\">（有改动）</span>") : QString(),
+                         base.isEmpty() ? html(fields[i]) : diffHtml(before, fields[i]));
+    }
+    QString summary;
+    if (base.isEmpty()) summary = againstCurrent ? "当前数据中已没有这条记录" : "这是这条记录的第一个版本";
+    else if (changed == 0) summary = againstCurrent ? "与当前数据相同" : "与上一版本相同";
+    else summary = QString("%1 个字段不同").arg(changed);
+    m_diffView->setHtml(QString("<p style=\"color:gray;\">%1</p>").arg(summary) + text);
+
+    // 只有职位和产品可以在本机编辑和保存
+    m_restoreButton->setEnabled(kind() != RevisionHistory::Cases && !(againstCurrent && changed == 0));
+}
+
+void RevisionHistoryDialog::restoreSelected()
+{
+    const QString key = selectedKey();
+    const int index = selectedRevision();
+    const QStringList fields = RevisionHistory::instance()->fieldsAt(kind(), key, index);
+    if (fields.isEmpty()) return;
+
+    const QString type = kind() == RevisionHistory::Jobs ? "jobs" : "products";
+    const QString holder = RecordLocks::instance()->otherHolder(type, fields[0]);
+    if (!holder.isEmpty()) {
+        QMessageBox::warning(this, "无法恢复", QString("%1 正在编辑这条记录，请稍后再试。").arg(holder));
+        return;
+    }
+    if (QMessageBox::question(this, "恢复历史版本",
+                              QString("把“%1”恢复为 %2 的版本？\n恢复的内容是本地修改，需要在对应的管理页面保存后才会更新到服务器。")
+                                  .arg(fields[0], m_revisionList->currentItem()->text()))
+        != QMessageBox::Yes) {
+        return;
+    }
+
+    // 恢复按整体替换发布（dataReset）：单条编辑（dataEdited）只会让管理页面换快照，
+    // 它们认为界面已经是最新的，恢复出来的已删除记录不会出现在列表中，
+    // 正在显示的记录也还是旧表单和旧图库，切换选中时旧图库还会被写回去
+    auto *store = DataStore::instance();
+    const SnapshotPtr snapshot = store->current();
+    if (kind() == RevisionHistory::Jobs) {
+        const Job job = RevisionHistory::jobFromFields(fields);
+        QList<Job> jobs;
+        jobs.reserve(snapshot->jobs.size() + 1);
+        bool replaced = false;
+        for (const auto &j : snapshot->jobs) {
+            if (!replaced && j->title == job.title) {
+                jobs.append(job);
+                replaced = true;
+            } else {
+                jobs.append(*j);
+            }
+        }
+        if (!replaced) jobs.append(job);
+        store->resetJobs(jobs);
+    } else {
+        const Product product = RevisionHistory::productFromFields(fields);
+        QList<Product> products;
+        products.reserve(snapshot->products.size() + 1);
+        bool replaced = false;
+        for (const auto &p : snapshot->products) {
+            if (!replaced && p->name == product.name) {
+                products.append(product);
+                replaced = true;
+            } else {
+                products.append(*p);
+            }
+        }
+        if (!replaced) products.append(product);
+        store->resetProducts(products);
+    }
+    m_statusLabel->setText(QString("已恢复“%1”，请在%2管理页面保存").arg(fields[0], RevisionHistory::kindName(kind())));
+    refreshDiff();
+}
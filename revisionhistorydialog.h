@@ -0,0 +1,47 @@
+// revisionhistorydialog.h
+#ifndef REVISIONHISTORYDIALOG_H
+#define REVISIONHISTORYDIALOG_H
+
+#include <QDialog>
+#include "revisionhistory.h"
+
+class QComboBox;
+class QLabel;
+class QLineEdit;
+class QListWidget;
+class QPushButton;
+class QTextBrowser;
+
+// --- 历史版本窗口 ---
+// 左边是有历史的记录，中间是所选记录的各个版本（最新的在上），右边显示这一版与上一版
+// （或与当前数据）逐字段的差异。选中的版本可以恢复为本地修改，之后在对应的管理模块里照常保存。
+// 窗口不阻塞主界面，新的同步或保存产生的版本会实时出现。
+class RevisionHistoryDialog : public QDialog
+{
+    Q_OBJECT
+
+public:
+    explicit RevisionHistoryDialog(QWidget *parent = nullptr);
+
+private:
+    RevisionHistory::Kind kind() const;
+    QString selectedKey() const;
+    int selectedRevision() const;
+    QStringList currentFields(const QString &key) const;
+
+    void refreshRecords();
+    void refreshRevisions();
+    void refreshDiff();
+    void restoreSelected();
+
+    QComboBox *m_kindCombo;
+    QLineEdit *m_filterEdit;
+    QListWidget *m_recordList;
+    QListWidget *m_revisionList;
+    QComboBox *m_compareCombo;
+    QTextBrowser *m_diffView;
+    QLabel *m_statusLabel;
+    QPushButton *m_restoreButton;
+};
+
+#endif // REVISIONHISTORYDIALOG_H
@@ -0,0 +1,193 @@
+// shutdowncoordinator.cpp
+#include "shutdowncoordinator.h"
+#include "networksession.h"
+#include "networkthread.h"
+#include "siteregistry.h"
+
+#include <QCoreApplication>
+#include <QNetworkAccessManager>
+#include <QNetworkReply>
+#include <QUrlQuery>
+#include <QTimer>
+#include <QSettings>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QDebug>
+
+namespace {
+// 默认值：在途工作最多再等 3 秒，整个退出流程最多 5 秒
+const int kDefaultFlushDeadlineMs = 3000;
+const int kDefaultBudgetMs = 5000;
+}
+
+ShutdownCoordinator *ShutdownCoordinator::instance()
+{
+    static ShutdownCoordinator *coordinator = new ShutdownCoordinator(qApp);
+    return coordinator;
+}
+
+ShutdownCoordinator::ShutdownCoordinator(QObject *parent)
+    : QObject(parent)
+    , m_flushTimer(new QTimer(this))
+    , m_budgetTimer(new QTimer(this))
+    , m_networkManager(new QNetworkAccessManager(this))
+{
+    m_flushTimer->setSingleShot(true);
+    m_budgetTimer->setSingleShot(true);
+    connect(m_flushTimer, &QTimer::timeout, this, &ShutdownCoordinator::onFlushDeadline);
+    connect(m_budgetTimer, &QTimer::timeout, this, &ShutdownCoordinator::finish);
+    connect(m_networkManager, &QNetworkAccessManager::finished, this, &ShutdownCoordinator::onLogoutReply);
+}
+
+int ShutdownCoordinator::beginWork(const QString &kind, const QJsonObject &resumeState)
+{
+    const int id = m_nextId++;
+    m_work.insert(id, Work{kind, resumeState, 0});
+    return id;
+}
+
+void ShutdownCoordinator::updateWork(int id, const QJsonObject &resumeState)
+{
+    auto it = m_work.find(id);
+    if (it != m_work.end()) it->resumeState = resumeState;
+}
+
+void ShutdownCoordinator::attachRequest(int id, quint64 requestId)
+{
+    auto it = m_work.find(id);
+    if (it != m_work.end()) it->requestId = requestId;
+}
+
+void ShutdownCoordinator::endWork(int id)
+{
+    if (m_work.remove(id) == 0) return;
+
+    // 退出过程中最后一项工作完成，不必再等收尾期限
+    if (m_shuttingDown && m_work.isEmpty()) {
+        m_flushTimer->stop();
+        sendLogout();
+    }
+}
+
+void ShutdownCoordinator::shutdown(const QString &sessionKey)
+{
+    if (m_shuttingDown) return;
+    m_shuttingDown = true;
+    m_sessionKey = sessionKey;
+    m_clock.start();
+
+    QSettings settings;
+    const int budgetMs = qMax(0, settings.value("shutdown/budgetMs", kDefaultBudgetMs).toInt());
+    const int flushMs = qBound(0, settings.value("shutdown/flushDeadlineMs", kDefaultFlushDeadlineMs).toInt(), budgetMs);
+
+    qDebug() << "Shutdown started," << m_work.size() << "pending work item(s),"
+             << "flush deadline" << flushMs << "ms, budget" << budgetMs << "ms";
+
+    m_budgetTimer->start(budgetMs);
+
+    if (m_work.isEmpty()) {
+        sendLogout();
+    } else {
+        // logout 会让会话密钥失效，必须等在途的保存/上传结束（或期限到达）之后再发送，
+        // 否则服务器可能在上传途中拒绝这些请求
+        m_flushTimer->start(flushMs);
+    }
+}
+
+void ShutdownCoordinator::onFlushDeadline()
+{
+    qDebug() << "Flush deadline reached," << m_work.size() << "work item(s) still pending";
+    persistUnfinishedWork();
+
+    // 先从表中移除，再中止请求：中止会同步触发各模块的回复处理，避免重复进入 endWork
+    const QHash<int, Work> unfinished = m_work;
+    m_work.clear();
+    for (const auto &work : unfinished) {
+        if (work.requestId) NetworkThread::instance()->abort(work.requestId);
+    }
+    sendLogout();
+}
+
+void ShutdownCoordinator::sendLogout()
+{
+    if (m_logoutSent) return;
+    m_logoutSent = true;
+
+    QNetworkRequest request = NetworkSession::apiRequest();
+    request.setHeader(QNetworkRequest::ContentTypeHeader, "application/x-www-form-urlencoded");
+
+    QUrlQuery postData;
+    postData.addQueryItem("action", "logout");
+    postData.addQueryItem("key", m_sessionKey);
+
+    m_networkManager->post(request, postData.query(QUrl::FullyEncoded).toUtf8());
+}
+
+void ShutdownCoordinator::onLogoutReply(QNetworkReply *reply)
+{
+    if (reply->error() != QNetworkReply::NoError)
+        qDebug() << "Logout request failed:" << reply->errorString();
+    reply->deleteLater();
+    finish();
+}
+
+void ShutdownCoordinator::finish()
+{
+    if (m_finished) return;
+    m_finished = true;
+
+    // 预算耗尽时可能还有工作没收尾（例如 logout 之前就卡住了），同样保存下来
+    if (!m_work.isEmpty()) {
+        persistUnfinishedWork();
+        m_work.clear();
+    }
+
+    qDebug() << "Shutdown finished in" << m_clock.elapsed() << "ms";
+    QCoreApplication::quit();
+}
+
+QString ShutdownCoordinator::leftoverFilePath()
+{
+    return SiteRegistry::instance()->localDataPath("unfinished_work.json");
+}
+
+void ShutdownCoordinator::persistUnfinishedWork()
+{
+    if (m_work.isEmpty()) return;
+
+    QJsonArray items;
+    for (const auto &work : std::as_const(m_work)) {
+        QJsonObject item;
+        item["kind"] = work.kind;
+        item["state"] = work.resumeState;
+        items.append(item);
+    }
+
+    const QString path = leftoverFilePath();
+    QDir().mkpath(QFileInfo(path).absolutePath());
+    QFile file(path);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qDebug() << "Cannot save unfinished work to" << path;
+        return;
+    }
+    file.write(QJsonDocument(items).toJson(QJsonDocument::Compact));
+    qDebug() << "Saved" << items.size() << "unfinished work item(s) to" << path;
+}
+
+QList<QJsonObject> ShutdownCoordinator::takeLeftoverWork()
+{
+    QList<QJsonObject> items;
+    QFile file(leftoverFilePath());
+    if (!file.open(QIODevice::ReadOnly)) return items;
+
+    const QJsonArray array = QJsonDocument::fromJson(file.readAll()).array();
+    for (const QJsonValue &v : array) {
+        if (v.isObject()) items.append(v.toObject());
+    }
+    file.close();
+    file.remove();
+    return items;
+}
@@ -0,0 +1,74 @@
+// shutdowncoordinator.h
+#ifndef SHUTDOWNCOORDINATOR_H
+#define SHUTDOWNCOORDINATOR_H
+
+#include <QObject>
+#include <QHash>
+#include <QJsonObject>
+#include <QElapsedTimer>
+
+class QNetworkAccessManager;
+class QNetworkReply;
+class QTimer;
+
+// --- 限时退出协调器 ---
+// 各管理模块在发起保存/上传时登记一项“在途工作”，并附上恢复所需的本地状态。
+// 用户退出时：
+//   1. 先给在途工作一个可配置的收尾期限（shutdown/flushDeadlineMs）
+//   2. 工作全部完成或期限到达后立即发送 logout
+//   3. 无论 logout 是否有回应，总耗时都不会超过 shutdown/budgetMs
+// 期限内没能完成的工作会被中止，其状态写入当前站点的本地文件，下次登录同一站点时恢复到编辑界面。
+class ShutdownCoordinator : public QObject
+{
+    Q_OBJECT
+
+public:
+    static ShutdownCoordinator *instance();
+
+    // 登记/更新/结束一项在途工作。kind 用于下次启动时把状态交回给对应模块
+    int beginWork(const QString &kind, const QJsonObject &resumeState);
+    void updateWork(int id, const QJsonObject &resumeState);
+    void attachRequest(int id, quint64 requestId); // 在途工作当前的请求（经由 NetworkThread 发出）
+    void endWork(int id);
+
+    bool hasPendingWork() const { return !m_work.isEmpty(); }
+    bool isShuttingDown() const { return m_shuttingDown; }
+
+    // 开始退出流程，完成后调用 QCoreApplication::quit()
+    void shutdown(const QString &sessionKey);
+
+    // 读取并删除上次退出时遗留的工作，每项包含 "kind" 和 "state" 两个字段
+    static QList<QJsonObject> takeLeftoverWork();
+
+private slots:
+    void onFlushDeadline();
+    void onLogoutReply(QNetworkReply *reply);
+    void finish();
+
+private:
+    explicit ShutdownCoordinator(QObject *parent = nullptr);
+
+    struct Work {
+        QString kind;
+        QJsonObject resumeState;
+        quint64 requestId = 0;
+    };
+
+    QHash<int, Work> m_work;
+    int m_nextId = 1;
+
+    bool m_shuttingDown = false;
+    bool m_logoutSent = false;
+    bool m_finished = false;
+    QString m_sessionKey;
+    QElapsedTimer m_clock;
+    QTimer *m_flushTimer;
+    QTimer *m_budgetTimer;
+    QNetworkAccessManager *m_networkManager;
+
+    void sendLogout();
+    void persistUnfinishedWork();
+    static QString leftoverFilePath();
+};
+
+#endif // SHUTDOWNCOORDINATOR_H
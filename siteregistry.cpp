@@ -0,0 +1,196 @@
+// siteregistry.cpp
+#include "siteregistry.h"
+
+#include <QCoreApplication>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QSettings>
+#include <QStandardPaths>
+#include <QUuid>
+#include <algorithm>
+
+namespace {
+// 升级前唯一的站点
+const char *const kDefaultSiteId = "default";
+}
+
+SiteRegistry *SiteRegistry::instance()
+{
+    static SiteRegistry *registry = new SiteRegistry(qApp);
+    return registry;
+}
+
+const char *SiteRegistry::defaultApiUrl()
+{
+    return "https://tianyuhuanbao.com/api.php";
+}
+
+SiteRegistry::SiteRegistry(QObject *parent)
+    : QObject(parent)
+{
+    load();
+}
+
+void SiteRegistry::load()
+{
+    QSettings settings;
+    const int count = settings.beginReadArray("sites/list");
+    for (int i = 0; i < count; ++i) {
+        settings.setArrayIndex(i);
+        Site site;
+        site.id = settings.value("id").toString();
+        site.name = settings.value("name").toString();
+        site.apiUrl = settings.value("apiUrl").toUrl();
+        if (!site.id.isEmpty() && isValidApiUrl(site.apiUrl)) m_sites.append(site);
+    }
+    settings.endArray();
+
+    if (m_sites.isEmpty()) {
+        // 升级前只有一个写死的站点
+        Site site;
+        site.id = kDefaultSiteId;
+        site.name = "天宇环保";
+        site.apiUrl = QUrl(defaultApiUrl());
+        m_sites.append(site);
+    }
+
+    m_currentId = settings.value("sites/current").toString();
+    bool found = false;
+    for (const Site &site : std::as_const(m_sites)) found = found || site.id == m_currentId;
+    if (!found) m_currentId = m_sites.first().id;
+}
+
+void SiteRegistry::save() const
+{
+    QSettings settings;
+    settings.beginWriteArray("sites/list", m_sites.size());
+    for (int i = 0; i < m_sites.size(); ++i) {
+        settings.setArrayIndex(i);
+        settings.setValue("id", m_sites[i].id);
+        settings.setValue("name", m_sites[i].name);
+        settings.setValue("apiUrl", m_sites[i].apiUrl);
+    }
+    settings.endArray();
+    settings.setValue("sites/current", m_currentId);
+}
+
+bool SiteRegistry::isValidApiUrl(const QUrl &url)
+{
+    return url.isValid() && !url.host().isEmpty() && (url.scheme() == "https" || url.scheme() == "http");
+}
+
+QString SiteRegistry::localDataPath(const QString &fileName) const
+{
+    const QString siteId = currentSiteId();
+    const QString root = QStandardPaths::writableLocation(QStandardPaths::AppDataLocation);
+    const QString path = root + "/sites/" + siteId + "/" + fileName;
+    const QString legacy = root + "/" + fileName;
+    if (siteId == kDefaultSiteId && !QFileInfo::exists(path) && QFileInfo::exists(legacy)) {
+        QDir().mkpath(QFileInfo(path).absolutePath());
+        QFile::rename(legacy, path);
+    }
+    return path;
+}
+
+QList<Site> SiteRegistry::sites() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sites;
+}
+
+Site SiteRegistry::site(const QString &id) const
+{
+    QMutexLocker locker(&m_mutex);
+    for (const Site &site : m_sites) {
+        if (site.id == id) return site;
+    }
+    return Site();
+}
+
+Site SiteRegistry::currentSite() const
+{
+    return site(currentSiteId());
+}
+
+QString SiteRegistry::currentSiteId() const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_currentId;
+}
+
+void SiteRegistry::setCurrentSite(const QString &id)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (id == m_currentId) return;
+        bool found = false;
+        for (const Site &site : std::as_const(m_sites)) found = found || site.id == id;
+        if (!found) return;
+        m_currentId = id;
+        save();
+    }
+    emit sitesChanged();
+}
+
+QString SiteRegistry::addSite(const QString &name, const QUrl &apiUrl)
+{
+    if (!isValidApiUrl(apiUrl)) return QString();
+    Site site;
+    site.id = QUuid::createUuid().toString(QUuid::WithoutBraces);
+    site.name = name.trimmed().isEmpty() ? apiUrl.host() : name.trimmed();
+    site.apiUrl = apiUrl;
+    {
+        QMutexLocker locker(&m_mutex);
+        m_sites.append(site);
+        save();
+    }
+    emit sitesChanged();
+    return site.id;
+}
+
+bool SiteRegistry::updateSite(const QString &id, const QString &name, const QUrl &apiUrl)
+{
+    if (!isValidApiUrl(apiUrl)) return false;
+    {
+        QMutexLocker locker(&m_mutex);
+        auto it = std::find_if(m_sites.begin(), m_sites.end(), [&id](const Site &s) { return s.id == id; });
+        if (it == m_sites.end()) return false;
+        // 地址变了，原来的会话不再有效
+        if (it->apiUrl != apiUrl) m_sessionKeys.remove(id);
+        it->name = name.trimmed().isEmpty() ? apiUrl.host() : name.trimmed();
+        it->apiUrl = apiUrl;
+        save();
+    }
+    emit sitesChanged();
+    return true;
+}
+
+void SiteRegistry::removeSite(const QString &id)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (id == m_currentId) return;
+        const auto removed = m_sites.removeIf([&id](const Site &s) { return s.id == id; });
+        if (removed == 0) return;
+        m_sessionKeys.remove(id);
+        save();
+    }
+    emit sitesChanged();
+}
+
+QString SiteRegistry::sessionKey(const QString &id) const
+{
+    QMutexLocker locker(&m_mutex);
+    return m_sessionKeys.value(id);
+}
+
+void SiteRegistry::setSessionKey(const QString &id, const QString &sessionKey)
+{
+    {
+        QMutexLocker locker(&m_mutex);
+        if (sessionKey.isEmpty()) m_sessionKeys.remove(id);
+        else m_sessionKeys.insert(id, sessionKey);
+    }
+    emit sessionChanged(id);
+}
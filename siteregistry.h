@@ -0,0 +1,71 @@
+// siteregistry.h
+#ifndef SITEREGISTRY_H
+#define SITEREGISTRY_H
+
+#include <QObject>
+#include <QHash>
+#include <QList>
+#include <QMutex>
+#include <QUrl>
+
+// 一个受管理的网站
+struct Site {
+    QString id;   // 本地生成，不随名称或地址改变
+    QString name;
+    QUrl apiUrl;  // 例如 https://tianyuhuanbao.com/api.php
+};
+
+// --- 站点登记表 ---
+// 保存所有受管理网站的名称和 API 地址（本地配置 sites/*），以及每个站点本次运行中的会话密钥。
+// “当前站点”是登录窗口登录、各管理面板编辑的那一个，NetworkSession::apiUrl() 返回它的地址；
+// 其余站点只参与数据中心的汇总同步（见 MultiSiteSync）。
+// 会话密钥只保存在内存中，不写入本地配置。各站点的本地状态文件分开存放（见 localDataPath）。
+// 网络线程也会读取当前地址，所有访问都由内部的锁保护。
+class SiteRegistry : public QObject
+{
+    Q_OBJECT
+
+public:
+    static SiteRegistry *instance();
+
+    // 第一次运行时默认登记的站点
+    static const char *defaultApiUrl();
+
+    QList<Site> sites() const;
+    Site site(const QString &id) const;
+    Site currentSite() const;
+    QString currentSiteId() const;
+    void setCurrentSite(const QString &id);
+
+    // 地址必须是 http/https 的完整地址，否则返回空 id
+    QString addSite(const QString &name, const QUrl &apiUrl);
+    bool updateSite(const QString &id, const QString &name, const QUrl &apiUrl);
+    void removeSite(const QString &id); // 当前站点不能移除
+
+    QString sessionKey(const QString &id) const;
+    void setSessionKey(const QString &id, const QString &sessionKey);
+
+    static bool isValidApiUrl(const QUrl &url);
+
+    // 当前站点的本地状态文件（离线队列、未完成的工作、统计历史等），
+    // 按站点分目录保存在 AppDataLocation/sites/<站点 id>/ 下，不同站点的数据互不混用。
+    // 升级前放在 AppDataLocation 下的同名文件属于原来唯一的站点（id 为 default），第一次用到时移过去
+    QString localDataPath(const QString &fileName) const;
+
+signals:
+    void sitesChanged();
+    void sessionChanged(const QString &id);
+
+private:
+    explicit SiteRegistry(QObject *parent = nullptr);
+
+    void load();
+    void save() const; // 调用方需持有 m_mutex
+
+    mutable QMutex m_mutex;
+    QList<Site> m_sites;
+    QString m_currentId;
+    QHash<QString, QString> m_sessionKeys;
+};
+
+#endif // SITEREGISTRY_H
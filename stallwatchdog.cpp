@@ -0,0 +1,202 @@
+// stallwatchdog.cpp
+#include "stallwatchdog.h"
+
+#include <QAbstractEventDispatcher>
+#include <QAtomicPointer>
+#include <QCoreApplication>
+#include <QEvent>
+#include <QJsonArray>
+#include <QMetaEnum>
+#include <QSettings>
+#include <QThread>
+#include <QDebug>
+#include <algorithm>
+
+namespace {
+
+// 最近的卡顿明细保留条数
+const int kRecentLimit = 200;
+// 一段忙碌中最多记录的候选 Scope 数量
+const int kScopeLimit = 64;
+
+// start() 之后才指向监视器；Scope 可能出现在任意线程，先用它做一次廉价的判断
+QAtomicPointer<StallWatchdog> g_active;
+
+QString eventTypeName(int type)
+{
+    const char *key = QMetaEnum::fromType<QEvent::Type>().valueToKey(type);
+    return key ? QString::fromLatin1(key) : QString("Event(%1)").arg(type);
+}
+
+} // namespace
+
+StallWatchdog *StallWatchdog::instance()
+{
+    static StallWatchdog *watchdog = new StallWatchdog(qApp);
+    return watchdog;
+}
+
+StallWatchdog::StallWatchdog(QObject *parent)
+    : QObject(parent)
+{
+    m_thresholdMs = qMax(16, QSettings().value("diagnostics/stallThresholdMs", 100).toInt());
+    m_clock.start();
+}
+
+void StallWatchdog::start()
+{
+    if (m_running) return;
+    QAbstractEventDispatcher *dispatcher = QAbstractEventDispatcher::instance(thread());
+    if (!dispatcher) {
+        qDebug() << "StallWatchdog: no event dispatcher on the GUI thread yet";
+        return;
+    }
+    connect(dispatcher, &QAbstractEventDispatcher::awake, this, &StallWatchdog::onAwake, Qt::DirectConnection);
+    connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock, this, &StallWatchdog::onAboutToBlock, Qt::DirectConnection);
+    m_running = true;
+    g_active.storeRelease(this);
+}
+
+bool StallWatchdog::isTracking() const
+{
+    return QThread::currentThread() == thread() && m_spanStart >= 0;
+}
+
+void StallWatchdog::onAwake()
+{
+    // 嵌套事件循环醒来时外层这段忙碌早已在它休眠前结算过，这里总是开始新的一段
+    m_spanStart = now();
+    m_scopes.clear();
+    m_worstEvent = Candidate();
+}
+
+void StallWatchdog::onAboutToBlock()
+{
+    if (m_spanStart < 0) return;
+    const qint64 duration = now() - m_spanStart;
+    m_spanStart = -1;
+    if (duration < m_thresholdMs) return;
+
+    StallRecord record;
+    record.when = QDateTime::currentDateTime();
+    record.durationMs = duration;
+    record.eventLabel = m_worstEvent.label;
+    qint64 longest = m_worstEvent.ms;
+    for (const Candidate &scope : std::as_const(m_scopes)) longest = qMax(longest, scope.ms);
+    for (const Candidate &scope : std::as_const(m_scopes)) {
+        if (scope.ms * 2 >= longest) {
+            record.label = scope.label;
+            break;
+        }
+    }
+    if (record.label.isEmpty())
+        record.label = m_worstEvent.label.isEmpty() ? QString("（多个短事件）") : m_worstEvent.label;
+
+    ++m_stallCount;
+    m_totalStallMs += duration;
+    m_recent.append(record);
+    if (m_recent.size() > kRecentLimit) m_recent.removeFirst();
+
+    StallOffender &offender = m_offenders[record.label];
+    offender.label = record.label;
+    ++offender.count;
+    offender.totalMs += duration;
+    offender.worstMs = qMax(offender.worstMs, duration);
+
+    qDebug().noquote() << QString("[stall] %1 ms in %2").arg(duration).arg(record.label);
+    emit stallDetected(record);
+}
+
+void StallWatchdog::offerScope(const char *label, qint64 start)
+{
+    // 开始于本段忙碌之前的代码（例如其中弹出过模态对话框）不参与归因
+    if (!isTracking() || start < m_spanStart) return;
+    const qint64 ms = now() - start;
+    if (ms * 2 < m_thresholdMs || m_scopes.size() >= kScopeLimit) return;
+    m_scopes.append(Candidate{QString::fromUtf8(label), ms});
+}
+
+void StallWatchdog::offerEvent(const char *className, int eventType, qint64 start)
+{
+    if (!isTracking() || start < m_spanStart) return;
+    const qint64 ms = now() - start;
+    // 绝大多数事件都很短，只有可能成为归因的事件才拼接标签
+    if (ms <= m_worstEvent.ms || ms * 2 < m_thresholdMs) return;
+    m_worstEvent.ms = ms;
+    m_worstEvent.label = QString("%1 / %2").arg(QString::fromLatin1(className), eventTypeName(eventType));
+}
+
+QList<StallOffender> StallWatchdog::worstOffenders(int limit) const
+{
+    QList<StallOffender> list = m_offenders.values();
+    std::sort(list.begin(), list.end(), [](const StallOffender &a, const StallOffender &b) {
+        return a.totalMs > b.totalMs;
+    });
+    if (limit > 0 && list.size() > limit) list.resize(limit);
+    return list;
+}
+
+void StallWatchdog::reset()
+{
+    m_stallCount = 0;
+    m_totalStallMs = 0;
+    m_recent.clear();
+    m_offenders.clear();
+}
+
+QJsonObject StallWatchdog::toJson() const
+{
+    QJsonArray offenders;
+    for (const StallOffender &o : worstOffenders(0)) {
+        offenders.append(QJsonObject{
+            {"label", o.label}, {"count", o.count}, {"totalMs", o.totalMs}, {"worstMs", o.worstMs}
+        });
+    }
+    QJsonArray recent;
+    for (const StallRecord &r : m_recent) {
+        recent.append(QJsonObject{
+            {"when", r.when.toString(Qt::ISODateWithMs)}, {"durationMs", r.durationMs},
+            {"label", r.label}, {"event", r.eventLabel}
+        });
+    }
+
+    QJsonObject root;
+    root["application"] = QCoreApplication::applicationName();
+    root["exportedAt"] = QDateTime::currentDateTime().toString(Qt::ISODate);
+    root["thresholdMs"] = m_thresholdMs;
+    root["stallCount"] = m_stallCount;
+    root["totalStallMs"] = m_totalStallMs;
+    root["offenders"] = offenders;
+    root["recent"] = recent;
+    return root;
+}
+
+StallWatchdog::Scope::Scope(const char *label)
+    : m_label(label)
+    , m_span("ui", label)
+{
+    StallWatchdog *watchdog = g_active.loadAcquire();
+    if (watchdog && watchdog->isTracking()) m_start = watchdog->now();
+}
+
+StallWatchdog::Scope::~Scope()
+{
+    if (m_start < 0) return;
+    g_active.loadAcquire()->offerScope(m_label, m_start);
+}
+
+StallWatchdog::EventScope::EventScope(QObject *receiver, QEvent *event)
+{
+    StallWatchdog *watchdog = g_active.loadAcquire();
+    if (!watchdog || !watchdog->isTracking()) return;
+    // 接收者可能在处理事件时被删除（DeferredDelete），类名和事件类型要先取出来
+    m_className = receiver->metaObject()->className();
+    m_eventType = event->type();
+    m_start = watchdog->now();
+}
+
+StallWatchdog::EventScope::~EventScope()
+{
+    if (m_start < 0) return;
+    g_active.loadAcquire()->offerEvent(m_className, m_eventType, m_start);
+}
@@ -0,0 +1,122 @@
+// stallwatchdog.h
+#ifndef STALLWATCHDOG_H
+#define STALLWATCHDOG_H
+
+#include <QObject>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QJsonObject>
+#include <QList>
+#include <QString>
+#include "tracelog.h"
+
+class QEvent;
+
+// 一次界面线程卡顿
+struct StallRecord {
+    QDateTime when;        // 卡顿结束的时刻
+    qint64 durationMs = 0; // 事件循环连续忙碌的时长
+    QString label;         // 归因：最耗时的代码段（Scope）或事件
+    QString eventLabel;    // 当时正在分发的最耗时的事件，“接收者类名 / 事件类型”
+};
+
+// 按归因汇总的卡顿统计
+struct StallOffender {
+    QString label;
+    int count = 0;
+    qint64 totalMs = 0;
+    qint64 worstMs = 0;
+};
+
+// --- 界面线程卡顿监视 ---
+// 事件循环每次醒来（awake）到下一次准备休眠（aboutToBlock）之间就是一段连续忙碌，
+// 超过阈值（diagnostics/stallThresholdMs，默认 100 ms）即记为一次卡顿。
+// 模态对话框等嵌套事件循环会自己休眠，因此不会被算成卡顿。
+// 归因来自两处：
+//   - EventScope：由应用程序的 notify() 包住每一次事件分发，给出接收者类名和事件类型
+//   - Scope：在容易卡顿的处理函数开头声明，给出具体的函数名
+// Scope 可以嵌套：取最先结束（即最内层）、且时长至少占到最耗时的 Scope 或事件一半的那一个，
+// 没有这样的 Scope 时以事件为准。
+// 只统计界面线程，其它线程中的 Scope 直接忽略。
+class StallWatchdog : public QObject
+{
+    Q_OBJECT
+
+public:
+    static StallWatchdog *instance();
+
+    // 连接界面线程的事件分发器，应在 QApplication 创建之后调用一次
+    void start();
+    bool isRunning() const { return m_running; }
+    int thresholdMs() const { return m_thresholdMs; }
+
+    int stallCount() const { return m_stallCount; }
+    qint64 totalStallMs() const { return m_totalStallMs; }
+    QList<StallRecord> recentStalls() const { return m_recent; } // 最早的在前，最多保留 200 条
+    QList<StallOffender> worstOffenders(int limit = 20) const;   // 按累计时长从高到低
+    void reset();
+
+    // 导出完整的诊断数据（阈值、汇总、排行和最近的卡顿）
+    QJsonObject toJson() const;
+
+    // 标记一段可能耗时的代码，label 必须是字符串字面量等长期有效的指针。
+    // 同时在 TraceLog 时间线上记录为 "ui" 类的时间段（任意线程都会记录）
+    class Scope
+    {
+    public:
+        explicit Scope(const char *label);
+        ~Scope();
+        Q_DISABLE_COPY(Scope)
+    private:
+        const char *m_label;
+        qint64 m_start = -1;
+        TraceLog::Span m_span;
+    };
+
+    // 包住一次事件分发，只在 notify() 中使用
+    class EventScope
+    {
+    public:
+        EventScope(QObject *receiver, QEvent *event);
+        ~EventScope();
+        Q_DISABLE_COPY(EventScope)
+    private:
+        const char *m_className = nullptr;
+        int m_eventType = 0;
+        qint64 m_start = -1;
+    };
+
+signals:
+    void stallDetected(const StallRecord &record);
+
+private:
+    explicit StallWatchdog(QObject *parent = nullptr);
+
+    void onAwake();
+    void onAboutToBlock();
+    bool isTracking() const; // 已启动、位于界面线程并且处于一段忙碌之中
+    qint64 now() const { return m_clock.elapsed(); }
+
+    // 当前这段忙碌中的候选归因
+    struct Candidate {
+        QString label;
+        qint64 ms = -1;
+    };
+    void offerScope(const char *label, qint64 start);
+    void offerEvent(const char *className, int eventType, qint64 start);
+
+    bool m_running = false;
+    int m_thresholdMs = 100;
+    QElapsedTimer m_clock;
+    qint64 m_spanStart = -1; // 本段忙碌开始的时刻，-1 表示事件循环正在休眠
+    QList<Candidate> m_scopes; // 按结束顺序，只保留可能成为归因的
+    Candidate m_worstEvent;
+
+    int m_stallCount = 0;
+    qint64 m_totalStallMs = 0;
+    QList<StallRecord> m_recent;
+    QHash<QString, StallOffender> m_offenders;
+};
+
+#endif // STALLWATCHDOG_H
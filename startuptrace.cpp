@@ -0,0 +1,79 @@
+// startuptrace.cpp
+#include "startuptrace.h"
+#include "tracelog.h"
+
+#include <QElapsedTimer>
+#include <QList>
+#include <QPair>
+#include <QDebug>
+
+namespace {
+
+QElapsedTimer &startupClock()
+{
+    static QElapsedTimer timer;
+    return timer;
+}
+
+// 按记录顺序保存 (阶段名, 毫秒)，阶段数量很少，线性查找足够
+QList<QPair<QByteArray, qint64>> &marks()
+{
+    static QList<QPair<QByteArray, qint64>> list;
+    return list;
+}
+
+} // namespace
+
+namespace StartupTrace {
+
+void begin()
+{
+    if (startupClock().isValid()) return;
+    startupClock().start();
+    TraceLog::now(); // 时间线与启动计时从同一时刻开始
+    mark(ProcessStart);
+}
+
+void mark(const char *phase)
+{
+    if (!startupClock().isValid()) begin();
+    if (isMarked(phase)) return;
+
+    const qint64 ms = startupClock().elapsed();
+    marks().append(qMakePair(QByteArray(phase), ms));
+    TraceLog::instant("startup", phase);
+    qDebug() << "[startup]" << phase << "+" << ms << "ms";
+
+    // 首批数据应用到界面，视为冷启动结束，输出一次完整报告
+    if (qstrcmp(phase, FirstDataApplied) == 0)
+        qDebug().noquote() << report();
+}
+
+bool isMarked(const char *phase)
+{
+    return elapsedMs(phase) >= 0;
+}
+
+qint64 elapsedMs(const char *phase)
+{
+    for (const auto &m : marks()) {
+        if (m.first == phase) return m.second;
+    }
+    return -1;
+}
+
+QString report()
+{
+    QString text = "--- 启动耗时报告 ---\n";
+    qint64 previous = 0;
+    for (const auto &m : marks()) {
+        text += QString("%1  %2 ms  (+%3 ms)\n")
+                    .arg(QString::fromLatin1(m.first), -26)
+                    .arg(m.second, 6)
+                    .arg(m.second - previous);
+        previous = m.second;
+    }
+    return text;
+}
+
+} // namespace StartupTrace
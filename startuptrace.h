@@ -0,0 +1,32 @@
+// startuptrace.h
+#ifndef STARTUPTRACE_H
+#define STARTUPTRACE_H
+
+#include <QString>
+
+// --- 冷启动耗时追踪 ---
+// 所有时间点都相对于 begin() 被调用的时刻（即进程启动后 main() 的第一行）。
+// 每个阶段只记录第一次出现的时间，重复调用 mark() 会被忽略，
+// 这样刷新数据、重新显示窗口等后续操作不会污染启动数据。
+namespace StartupTrace {
+
+// 固定的阶段名称，避免各处手写字符串时出现拼写不一致
+inline const char *const ProcessStart     = "process_start";
+inline const char *const LoginShown       = "login_dialog_shown";
+inline const char *const LoginReply       = "login_reply";
+inline const char *const MainWindowPaint  = "main_window_first_paint";
+inline const char *const FirstDataApplied = "first_data_applied";
+
+void begin();
+void mark(const char *phase);
+bool isMarked(const char *phase);
+
+// 返回某个阶段距离进程启动的毫秒数，未记录时返回 -1
+qint64 elapsedMs(const char *phase);
+
+// 生成一份可读的报告（每个阶段一行：绝对时间 + 与上一阶段的间隔）
+QString report();
+
+} // namespace StartupTrace
+
+#endif // STARTUPTRACE_H
@@ -0,0 +1,104 @@
+// syncbootstrap.cpp
+#include "syncbootstrap.h"
+#include "networkthread.h"
+#include "networksession.h"
+#include "dataserializer.h"
+#include "datastore.h"
+#include "jsonbackend.h"
+#include "tracelog.h"
+
+#include <QCoreApplication>
+#include <QFutureWatcher>
+#include <QNetworkAccessManager>
+#include <QtConcurrent/QtConcurrentRun>
+#include <QDebug>
+
+SyncBootstrap *SyncBootstrap::instance()
+{
+    static SyncBootstrap *bootstrap = new SyncBootstrap(qApp);
+    return bootstrap;
+}
+
+SyncBootstrap::SyncBootstrap(QObject *parent)
+    : QObject(parent)
+{
+}
+
+void SyncBootstrap::start()
+{
+    if (m_state == State::Fetching) return;
+    m_state = State::Fetching;
+
+    NetworkThread::instance()->submit("get_all_data",
+        [](QNetworkAccessManager *manager) {
+            QNetworkRequest request = NetworkSession::apiRequest("get_all_data");
+            request.setAttribute(QNetworkRequest::User, "get_all_data");
+            request.setAttribute(NetworkThread::RawBodyAttribute, true);
+            return manager->get(request);
+        },
+        this, [this](const NetworkResult &result) {
+            if (!result.ok()) {
+                fail(result.errorString, NetworkSession::isConnectivityError(result.error));
+                return;
+            }
+            applyBody(result.body);
+        });
+}
+
+void SyncBootstrap::adopt(const QJsonObject &data)
+{
+    m_state = State::Fetching;
+    apply(data);
+}
+
+void SyncBootstrap::apply(const QJsonObject &data)
+{
+    // 转换成数据结构在工作线程中进行，界面线程此时可能正在构造主窗口
+    const qint64 started = TraceLog::now();
+    auto *watcher = new QFutureWatcher<SyncData>(this);
+    connect(watcher, &QFutureWatcher<SyncData>::finished, this, [this, watcher, started]() {
+        watcher->deleteLater();
+        publish(watcher->result(), started);
+    });
+    watcher->setFuture(QtConcurrent::run(&DataSerializer::syncDataFromJson, data));
+}
+
+void SyncBootstrap::applyBody(const QByteArray &body)
+{
+    const qint64 started = TraceLog::now();
+    auto *watcher = new QFutureWatcher<SyncResponse>(this);
+    connect(watcher, &QFutureWatcher<SyncResponse>::finished, this, [this, watcher, started]() {
+        watcher->deleteLater();
+        const SyncResponse response = watcher->result();
+        if (!response.isValid()) {
+            fail("服务器返回了无效的数据格式：" + response.parseError, false);
+            return;
+        }
+        if (response.status != "success") {
+            fail(response.message.isEmpty() ? QString("未知错误") : response.message, false);
+            return;
+        }
+        if (!response.hasData) {
+            fail("数据结构错误：缺少 'data' 对象", false);
+            return;
+        }
+        publish(response.data, started);
+    });
+    watcher->setFuture(QtConcurrent::run([body]() { return JsonBackend::active().parse(body); }));
+}
+
+void SyncBootstrap::publish(const SyncData &sync, qint64 startedUs)
+{
+    if (!sync.hasJobs) qDebug() << "ERROR: 'jobs' field is missing or is NOT an array!";
+    DataStore::instance()->resetFromSync(sync);
+    TraceLog::async("ui", "bootstrap parse", 2, startedUs, TraceLog::now());
+    m_state = State::Ready;
+    emit ready();
+}
+
+void SyncBootstrap::fail(const QString &message, bool connectivity)
+{
+    qDebug() << "Bootstrap fetch failed:" << message;
+    m_state = State::Failed;
+    emit failed(message, connectivity);
+}
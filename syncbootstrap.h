@@ -0,0 +1,50 @@
+// syncbootstrap.h
+#ifndef SYNCBOOTSTRAP_H
+#define SYNCBOOTSTRAP_H
+
+#include <QObject>
+#include <QJsonObject>
+#include "datastructures.h"
+
+// --- 登录后的首次数据拉取 ---
+// 原来的顺序是：登录响应 -> 关闭登录框 -> 构造主窗口 -> 主窗口发出 get_all_data，
+// 三步首尾相接。现在登录响应一到（带有 session_key）就立即在网络线程上拉取全部数据，
+// 与“登录成功”提示框、主窗口和各标签页的构造同时进行；
+// 服务器支持 include_data 时数据直接随登录响应返回，连这一次往返也省掉。
+// 数据到达后在工作线程中解析，随即发布到 DataStore——与主窗口是否已经建好无关，
+// 已创建的面板通过 dataReset 刷新，之后创建的面板直接读取当前快照。
+class SyncBootstrap : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum class State { Idle, Fetching, Ready, Failed };
+
+    static SyncBootstrap *instance();
+
+    // 登录成功后立即拉取全部数据
+    void start();
+    // 登录响应里已经带了数据（data 对象）
+    void adopt(const QJsonObject &data);
+
+    State state() const { return m_state; }
+
+signals:
+    // 数据已经发布到 DataStore
+    void ready();
+    // 拉取失败；调用方通常改走常规的同步流程，由它负责报告错误
+    void failed(const QString &message, bool connectivity);
+
+private:
+    explicit SyncBootstrap(QObject *parent = nullptr);
+
+    void apply(const QJsonObject &data);
+    // 响应体直接交给 JsonBackend 在工作线程中解析，网络线程不再预先解析一遍
+    void applyBody(const QByteArray &body);
+    void publish(const SyncData &sync, qint64 startedUs);
+    void fail(const QString &message, bool connectivity);
+
+    State m_state = State::Idle;
+};
+
+#endif // SYNCBOOTSTRAP_H
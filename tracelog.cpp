@@ -0,0 +1,218 @@
+// tracelog.cpp
+#include "tracelog.h"
+
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QMutex>
+#include <QThread>
+
+namespace {
+
+// 环形缓冲区容量（事件数）；一次完整同步加几十张图片的上传大约产生几百个事件
+const int kCapacity = 50000;
+
+struct Event {
+    char phase = 'X';              // X 同步时间段，b/e 异步开始/结束，i 瞬时
+    const char *category = "";
+    QByteArray name;
+    QString detail;
+    qint64 ts = 0;
+    qint64 dur = 0;
+    quint64 id = 0;
+    int tid = 0;
+};
+
+struct Buffer {
+    QMutex mutex;
+    QList<Event> events;           // 写满后从 next 处开始覆盖
+    int next = 0;
+    QHash<int, QString> threadNames;
+    int nextTid = 1;
+};
+
+Buffer &buffer()
+{
+    static Buffer b;
+    return b;
+}
+
+QElapsedTimer &traceClock()
+{
+    static QElapsedTimer timer = []() {
+        QElapsedTimer t;
+        t.start();
+        return t;
+    }();
+    return timer;
+}
+
+// 每个线程第一次记录事件时分配一个小编号，并记下线程名，导出时写成元数据事件
+int currentTid()
+{
+    thread_local int tid = 0;
+    if (tid) return tid;
+
+    QThread *thread = QThread::currentThread();
+    QString name = thread->objectName();
+    if (QCoreApplication::instance() && thread == QCoreApplication::instance()->thread())
+        name = "界面线程";
+
+    Buffer &b = buffer();
+    QMutexLocker locker(&b.mutex);
+    tid = b.nextTid++;
+    b.threadNames.insert(tid, name.isEmpty() ? QString("线程 %1").arg(tid) : name);
+    return tid;
+}
+
+void record(Event event)
+{
+    event.tid = currentTid();
+    Buffer &b = buffer();
+    QMutexLocker locker(&b.mutex);
+    if (b.events.size() < kCapacity) {
+        b.events.append(std::move(event));
+    } else {
+        b.events[b.next] = std::move(event);
+        b.next = (b.next + 1) % kCapacity;
+    }
+}
+
+QJsonObject toJson(const Event &event)
+{
+    QJsonObject obj;
+    obj["name"] = QString::fromUtf8(event.name);
+    obj["cat"] = QString::fromLatin1(event.category);
+    obj["ph"] = QString(QChar(event.phase));
+    obj["ts"] = event.ts;
+    obj["pid"] = 1;
+    obj["tid"] = event.tid;
+    if (event.phase == 'X') obj["dur"] = event.dur;
+    if (event.phase == 'b' || event.phase == 'e') obj["id"] = QString("0x%1").arg(event.id, 0, 16);
+    if (event.phase == 'i') obj["s"] = "g";
+    if (!event.detail.isEmpty()) obj["args"] = QJsonObject{{"detail", event.detail}};
+    return obj;
+}
+
+} // namespace
+
+namespace TraceLog {
+
+qint64 now()
+{
+    return traceClock().nsecsElapsed() / 1000;
+}
+
+void complete(const char *category, const QByteArray &name, qint64 startUs, const QString &detail)
+{
+    Event event;
+    event.phase = 'X';
+    event.category = category;
+    event.name = name;
+    event.detail = detail;
+    event.ts = startUs;
+    event.dur = now() - startUs;
+    record(std::move(event));
+}
+
+void async(const char *category, const QByteArray &name, quint64 id, qint64 startUs, qint64 endUs,
+           const QString &detail)
+{
+    Event begin;
+    begin.phase = 'b';
+    begin.category = category;
+    begin.name = name;
+    begin.detail = detail;
+    begin.ts = startUs;
+    begin.id = id;
+    Event end = begin;
+    end.phase = 'e';
+    end.ts = endUs;
+    end.detail.clear();
+    record(std::move(begin));
+    record(std::move(end));
+}
+
+void instant(const char *category, const QByteArray &name)
+{
+    Event event;
+    event.phase = 'i';
+    event.category = category;
+    event.name = name;
+    event.ts = now();
+    record(std::move(event));
+}
+
+QByteArray toChromeJson()
+{
+    // 锁内只复制（隐式共享，几乎不花时间），生成 JSON 时不阻塞正在记录事件的线程
+    QList<Event> recorded;
+    QHash<int, QString> threadNames;
+    int start = 0;
+    {
+        Buffer &b = buffer();
+        QMutexLocker locker(&b.mutex);
+        recorded = b.events;
+        threadNames = b.threadNames;
+        start = (b.events.size() < kCapacity) ? 0 : b.next; // 写满后最早的事件位于 next 处
+    }
+
+    QJsonArray events;
+    for (auto it = threadNames.cbegin(); it != threadNames.cend(); ++it) {
+        events.append(QJsonObject{
+            {"name", "thread_name"}, {"ph", "M"}, {"pid", 1}, {"tid", it.key()},
+            {"args", QJsonObject{{"name", it.value()}}}
+        });
+    }
+    events.append(QJsonObject{
+        {"name", "process_name"}, {"ph", "M"}, {"pid", 1}, {"tid", 0},
+        {"args", QJsonObject{{"name", QCoreApplication::applicationName()}}}
+    });
+    const int count = recorded.size();
+    for (int i = 0; i < count; ++i)
+        events.append(toJson(recorded[(start + i) % count]));
+
+    QJsonObject root;
+    root["traceEvents"] = events;
+    root["displayTimeUnit"] = "ms";
+    return QJsonDocument(root).toJson(QJsonDocument::Compact);
+}
+
+bool dump(const QString &filePath, QString *errorString)
+{
+    QFile file(filePath);
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        if (errorString) *errorString = file.errorString();
+        return false;
+    }
+    file.write(toChromeJson());
+    return true;
+}
+
+void clear()
+{
+    Buffer &b = buffer();
+    QMutexLocker locker(&b.mutex);
+    b.events.clear();
+    b.next = 0;
+}
+
+Span::Span(const char *category, const QByteArray &name, const QString &detail)
+    : m_category(category)
+    , m_name(name)
+    , m_detail(detail)
+    , m_start(now())
+{
+}
+
+Span::~Span()
+{
+    complete(m_category, m_name, m_start, m_detail);
+}
+
+} // namespace TraceLog
@@ -0,0 +1,50 @@
+// tracelog.h
+#ifndef TRACELOG_H
+#define TRACELOG_H
+
+#include <QByteArray>
+#include <QString>
+
+// --- 客户端活动时间线 ---
+// 各模块在关键路径上记录时间段（登录、网络请求的各个阶段、按部分解析 JSON、
+// 列表和表单填充、图片解码、上传……），事件保存在固定容量的环形缓冲区里，
+// 超出容量时覆盖最早的事件，内存占用有上限，平时一直开着也没有负担。
+// 需要分析时导出为 Chrome trace-event JSON，用 Perfetto（ui.perfetto.dev）或 chrome://tracing 打开。
+// 所有函数都可以在任意线程调用；时间以微秒计，相对于第一次调用 now() 的时刻。
+namespace TraceLog {
+
+qint64 now();
+
+// 同步时间段：开始和结束都在当前线程，且与同线程的其它时间段严格嵌套
+void complete(const char *category, const QByteArray &name, qint64 startUs, const QString &detail = QString());
+// 异步时间段：可以跨线程、跨事件循环，也可以互相重叠（例如并发的网络请求），id 用于配对
+void async(const char *category, const QByteArray &name, quint64 id, qint64 startUs, qint64 endUs,
+           const QString &detail = QString());
+// 瞬时事件，例如启动阶段的里程碑
+void instant(const char *category, const QByteArray &name);
+
+// 导出当前缓冲区中的全部事件（Chrome trace-event JSON）
+QByteArray toChromeJson();
+bool dump(const QString &filePath, QString *errorString = nullptr);
+void clear();
+
+// 作用域内的同步时间段；category 必须是长期有效的指针（字符串字面量）
+class Span
+{
+public:
+    Span(const char *category, const QByteArray &name, const QString &detail = QString());
+    ~Span();
+    Q_DISABLE_COPY(Span)
+
+    void setDetail(const QString &detail) { m_detail = detail; }
+
+private:
+    const char *m_category;
+    QByteArray m_name;
+    QString m_detail;
+    qint64 m_start;
+};
+
+} // namespace TraceLog
+
+#endif // TRACELOG_H
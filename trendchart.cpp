@@ -0,0 +1,115 @@
+// trendchart.cpp
+#include "trendchart.h"
+#include "lttb.h"
+
+#include <QDateTime>
+#include <QPainter>
+#include <QPainterPath>
+#include <cmath>
+
+namespace {
+const int kMarginLeft = 56;
+const int kMarginRight = 16;
+const int kMarginTop = 28;
+const int kMarginBottom = 28;
+} // namespace
+
+TrendChart::TrendChart(QWidget *parent)
+    : QWidget(parent)
+{
+    setMinimumHeight(180);
+    setSizePolicy(QSizePolicy::Expanding, QSizePolicy::Expanding);
+}
+
+void TrendChart::setSeries(const QList<QPointF> &points, const QString &title, const QString &unit)
+{
+    m_points = points;
+    m_title = title;
+    m_unit = unit;
+    m_sampledWidth = -1;
+    update();
+}
+
+void TrendChart::paintEvent(QPaintEvent *)
+{
+    QPainter painter(this);
+    painter.setRenderHint(QPainter::Antialiasing);
+    painter.fillRect(rect(), palette().base());
+
+    const QRect plot = rect().adjusted(kMarginLeft, kMarginTop, -kMarginRight, -kMarginBottom);
+    painter.setPen(palette().text().color());
+    painter.drawText(QRect(kMarginLeft, 4, width() - kMarginLeft, kMarginTop - 4),
+                     Qt::AlignLeft | Qt::AlignVCenter, m_title);
+
+    if (m_points.isEmpty() || plot.width() < 10 || plot.height() < 10) {
+        painter.drawText(plot, Qt::AlignCenter, "暂无历史数据，每次同步后会自动记录");
+        return;
+    }
+
+    // 每个像素列最多一个点就足够了
+    if (m_sampledWidth != plot.width()) {
+        m_sampled = Lttb::downsample(m_points, plot.width());
+        m_sampledWidth = plot.width();
+    }
+
+    double minX = m_sampled.first().x();
+    double maxX = m_sampled.last().x();
+    double minY = m_sampled.first().y();
+    double maxY = minY;
+    for (const QPointF &p : std::as_const(m_sampled)) {
+        minY = qMin(minY, p.y());
+        maxY = qMax(maxY, p.y());
+    }
+    // 降采样保留了极值，所以用采样后的点求范围即可；留出一点上下空白
+    if (maxY - minY < 1) { minY -= 1; maxY += 1; }
+    const double padY = (maxY - minY) * 0.08;
+    minY = qMax(0.0, minY - padY);
+    maxY += padY;
+    if (maxX <= minX) { minX -= 1; maxX += 1; }
+
+    auto mapPoint = [&](const QPointF &p) {
+        const double x = plot.left() + (p.x() - minX) / (maxX - minX) * plot.width();
+        const double y = plot.bottom() - (p.y() - minY) / (maxY - minY) * plot.height();
+        return QPointF(x, y);
+    };
+
+    // 坐标轴与刻度
+    QColor gridColor = palette().mid().color();
+    painter.setPen(QPen(gridColor, 1, Qt::DotLine));
+    const int ticks = 4;
+    for (int i = 0; i <= ticks; ++i) {
+        const double value = minY + (maxY - minY) * i / ticks;
+        const int y = plot.bottom() - plot.height() * i / ticks;
+        painter.drawLine(plot.left(), y, plot.right(), y);
+        painter.save();
+        painter.setPen(palette().text().color());
+        painter.drawText(QRect(0, y - 10, kMarginLeft - 6, 20), Qt::AlignRight | Qt::AlignVCenter,
+                         QString::number(std::round(value)));
+        painter.restore();
+    }
+    painter.setPen(palette().text().color());
+    const QString startText = QDateTime::fromMSecsSinceEpoch(qint64(minX)).toString("yyyy-MM-dd");
+    const QString endText = QDateTime::fromMSecsSinceEpoch(qint64(maxX)).toString("yyyy-MM-dd HH:mm");
+    painter.drawText(QRect(plot.left(), plot.bottom() + 4, plot.width() / 2, kMarginBottom - 4),
+                     Qt::AlignLeft | Qt::AlignTop, startText);
+    painter.drawText(QRect(plot.center().x(), plot.bottom() + 4, plot.width() / 2, kMarginBottom - 4),
+                     Qt::AlignRight | Qt::AlignTop, endText);
+
+    // 折线；只有一个样本时画一个点
+    painter.setPen(QPen(palette().highlight().color(), 2));
+    if (m_sampled.size() == 1) {
+        painter.setBrush(palette().highlight());
+        painter.drawEllipse(mapPoint(m_sampled.first()), 3, 3);
+    } else {
+        QPainterPath path(mapPoint(m_sampled.first()));
+        for (int i = 1; i < m_sampled.size(); ++i) path.lineTo(mapPoint(m_sampled[i]));
+        painter.drawPath(path);
+    }
+
+    // 最新值
+    const QPointF last = m_sampled.last();
+    painter.setPen(palette().text().color());
+    painter.drawText(QRect(kMarginLeft, 4, width() - kMarginLeft - kMarginRight, kMarginTop - 4),
+                     Qt::AlignRight | Qt::AlignVCenter,
+                     QString("最新 %1 %2 · %3 个样本").arg(last.y()).arg(m_unit).arg(m_points.size()));
+}
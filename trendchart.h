@@ -0,0 +1,37 @@
+// trendchart.h
+#ifndef TRENDCHART_H
+#define TRENDCHART_H
+
+#include <QWidget>
+#include <QList>
+#include <QPointF>
+
+// --- 简单的时间趋势折线图 ---
+// 数据可以很长（例如一年的逐次同步样本），绘制前用 LTTB 降采样到绘图区的像素宽度，
+// 所以绘制耗时与数据长度无关；降采样结果按宽度缓存，只有数据或尺寸变化时才重新计算。
+// x 为毫秒时间戳，y 为数值。
+class TrendChart : public QWidget
+{
+    Q_OBJECT
+
+public:
+    explicit TrendChart(QWidget *parent = nullptr);
+
+    void setSeries(const QList<QPointF> &points, const QString &title, const QString &unit);
+
+    QSize sizeHint() const override { return QSize(600, 240); }
+
+protected:
+    void paintEvent(QPaintEvent *event) override;
+
+private:
+    QList<QPointF> m_points;
+    QString m_title;
+    QString m_unit;
+
+    // 降采样缓存
+    QList<QPointF> m_sampled;
+    int m_sampledWidth = -1;
+};
+
+#endif // TRENDCHART_H